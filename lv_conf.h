@@ -25,8 +25,11 @@
    COLOR SETTINGS
  *====================*/
 
-/** Color depth: 1 (I1), 8 (L8), 16 (RGB565), 24 (RGB888), 32 (XRGB8888) */
-#define LV_COLOR_DEPTH 32
+/** Color depth: 1 (I1), 8 (L8), 16 (RGB565), 24 (RGB888), 32 (XRGB8888)
+ *  Can be overridden by the build, see CAMPER_COLOR_DEPTH in CMakeLists.txt */
+#ifndef LV_COLOR_DEPTH
+    #define LV_COLOR_DEPTH 32
+#endif
 
 /*=========================
    STDLIB WRAPPER SETTINGS
@@ -96,7 +99,8 @@
 /*=================
  * OPERATING SYSTEM
  *=================*/
-/** Select operating system to use. Possible options:
+/** Select operating system to use. Can be overridden by the build, see
+ * CAMPER_DRAW_UNITS in CMakeLists.txt. Possible options:
  * - LV_OS_NONE
  * - LV_OS_PTHREAD
  * - LV_OS_FREERTOS
@@ -106,7 +110,9 @@
  * - LV_OS_MQX
  * - LV_OS_SDL2
  * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_NONE
+#ifndef LV_USE_OS
+    #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -180,7 +186,9 @@
     /** Set number of draw units.
      *  - > 1 requires operating system to be enabled in `LV_USE_OS`.
      *  - > 1 means multiple threads will render the screen in parallel. */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #ifndef LV_DRAW_SW_DRAW_UNIT_CNT
+        #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #endif
 
     /** Use Arm-2D to accelerate software (sw) rendering. */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -206,10 +214,14 @@
         #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
     #endif
 
-    #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
+    /** Assembly or intrinsics blend kernels. Can be overridden by the build, see
+     *  CAMPER_NEON in CMakeLists.txt which selects the kernels in src/lib/blend_neon.h */
+    #ifndef LV_USE_DRAW_SW_ASM
+        #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
+    #endif
 
     #if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
-        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE ""
+        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE "blend_neon.h"
     #endif
 
     /** Enable drawing complex gradients in software: linear at an angle, radial or conical */
@@ -983,7 +995,7 @@
 /* Documentation for several of the below items can be found here: https://docs.lvgl.io/master/details/auxiliary-modules/index.html . */
 
 /** 1: Enable API to take snapshot for object */
-#define LV_USE_SNAPSHOT 0
+#define LV_USE_SNAPSHOT 1
 
 /** 1: Enable system monitor component */
 #define LV_USE_SYSMON   0
@@ -0,0 +1,137 @@
+/*******************************************************************
+ *
+ * bench.c - Offline benchmarks
+ *
+ * Benchmarks run instead of the application and print their results
+ * as key=value lines, so runs can be compared with a simple diff or
+ * collected by a script in CI.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl/lvgl.h"
+#include "bench.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    const char* name;
+    const char* description;
+    int (*run)(const bench_options_t* options);
+} bench_entry_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const bench_entry_t benches[] = {
+    {"ui", "Render each tab on the headless backend from data snapshots", bench_ui},
+    {"redraw", "Full-screen redraw time of each tab, compare CAMPER_DRAW_UNITS builds",
+     bench_redraw},
+    {"blend", "Scalar and NEON fill and blend kernels, no display needed", bench_blend},
+    {"downsample", "Reduce 10k to 1M sample histories to the display width", bench_downsample},
+};
+
+static uint32_t synthetic_ms = 0;
+
+/**
+ * Synthetic LVGL tick source
+ */
+static uint32_t bench_tick_cb(void)
+{
+    return synthetic_ms;
+}
+
+/**
+ * Initialize LVGL with a synthetic clock that only advances with bench_clock_advance()
+ */
+void bench_lvgl_init(void)
+{
+    lv_init();
+    lv_tick_set_cb(bench_tick_cb);
+}
+
+/**
+ * Advance the synthetic clock
+ */
+void bench_clock_advance(uint32_t ms)
+{
+    synthetic_ms += ms;
+}
+
+/**
+ * Get the current CLOCK_MONOTONIC time in nanoseconds, for measurements
+ */
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Update a CRC-32 (IEEE 802.3) with a block of data
+ */
+uint32_t bench_crc32(uint32_t crc, const uint8_t* data, uint32_t size)
+{
+    static uint32_t table[256];
+
+    if(table[1] == 0)
+    {
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for(int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+
+    crc = ~crc;
+    for(uint32_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * Get the label of a tab button
+ */
+const char* bench_tab_name(lv_obj_t* tabview, uint32_t index)
+{
+    lv_obj_t* button = lv_obj_get_child(lv_tabview_get_tab_bar(tabview), index);
+    lv_obj_t* label  = button ? lv_obj_get_child(button, 0) : NULL;
+    return label ? lv_label_get_text(label) : "?";
+}
+
+/**
+ * Run a benchmark by name
+ */
+int bench_run(const char* name, const bench_options_t* options)
+{
+    for(size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+    {
+        if(strcmp(name, benches[i].name) == 0)
+        {
+            return benches[i].run(options);
+        }
+    }
+
+    if(strcmp(name, "list") != 0)
+    {
+        fprintf(stderr, "Unknown benchmark '%s'\n", name);
+    }
+
+    fprintf(stdout, "Available benchmarks:\n");
+    for(size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+    {
+        fprintf(stdout, "  %-10s %s\n", benches[i].name, benches[i].description);
+    }
+    return strcmp(name, "list") == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************
+ *
+ * bench.h - Offline benchmarks
+ *
+ ******************************************************************/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+#include "../lib/display_backend.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Benchmark options, taken from the command line
+     */
+    typedef struct
+    {
+        const char*             snapshot_dir;  // Recorded API responses
+        int                     width;         // Display width in pixels
+        int                     height;        // Display height in pixels
+        display_color_profile_t color_profile; // Render color format
+        uint32_t                frames;        // Frames per scenario
+    } bench_options_t;
+
+    /**
+     * Run a benchmark by name
+     * Results are printed to stdout as one key=value line per scenario.
+     * @param name benchmark name, "list" prints the available benchmarks
+     * @param options benchmark options
+     * @return process exit code
+     */
+    int bench_run(const char* name, const bench_options_t* options);
+
+    /**
+     * Initialize LVGL with a synthetic clock that only advances with bench_clock_advance()
+     */
+    void bench_lvgl_init(void);
+
+    /**
+     * Advance the synthetic clock
+     * @param ms milliseconds to advance
+     */
+    void bench_clock_advance(uint32_t ms);
+
+    /**
+     * Get the current CLOCK_MONOTONIC time in nanoseconds, for measurements
+     */
+    uint64_t bench_now_ns(void);
+
+    /**
+     * Update a CRC-32 with a block of data
+     * @param crc CRC of the preceding data, 0 to start
+     * @param data data to add
+     * @param size size of the data in bytes
+     * @return updated CRC
+     */
+    uint32_t bench_crc32(uint32_t crc, const uint8_t* data, uint32_t size);
+
+    /**
+     * Get the label of a tab, for result lines
+     * @param tabview tabview the tab belongs to
+     * @param index tab index
+     * @return tab label
+     */
+    const char* bench_tab_name(lv_obj_t* tabview, uint32_t index);
+
+    /* Benchmarks */
+    int bench_ui(const bench_options_t* options);
+    int bench_redraw(const bench_options_t* options);
+    int bench_blend(const bench_options_t* options);
+    int bench_downsample(const bench_options_t* options);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* BENCH_H */
@@ -0,0 +1,209 @@
+/*******************************************************************
+ *
+ * bench_blend.c - Software renderer kernel benchmark
+ *
+ * Runs each fill and blend kernel over a full-screen area, once with
+ * the scalar code and, on NEON builds, once with the NEON code, and
+ * checks that both produce the same pixels. Needs no display, so it
+ * also runs under qemu-user in the cross-build container, where the
+ * timings are only meaningful relative to each other.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lvgl/lvgl.h"
+#include "bench.h"
+#include "../lib/blend_neon.h"
+#include "../lib/color_convert.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    const char* name;
+    uint32_t    dest_px_size; // Destination bytes per pixel
+    void (*run)(void);
+} kernel_entry_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint8_t* src_buf;
+static uint8_t* dest_buf;
+static uint8_t* dest_init;
+static int32_t  width;
+static int32_t  height;
+
+/**
+ * Fill a buffer with repeatable pseudo-random bytes
+ * Every fourth byte, the alpha of ARGB8888 pixels, is often fully transparent or opaque
+ * so the special cases of the blend kernels are covered.
+ */
+static void fill_pattern(uint8_t* buf, uint32_t size, uint32_t seed)
+{
+    for(uint32_t i = 0; i < size; i++)
+    {
+        seed   = seed * 1103515245 + 12345;
+        buf[i] = (uint8_t)(seed >> 16);
+        if((i & 3) == 3 && (seed & 0x300) != 0x300)
+        {
+            buf[i] = (seed & 0x100) ? 255 : 0;
+        }
+    }
+}
+
+static void init_fill_dsc(lv_draw_sw_blend_fill_dsc_t* dsc, uint32_t px_size, lv_opa_t opa)
+{
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->dest_buf    = dest_buf;
+    dsc->dest_w      = width;
+    dsc->dest_h      = height;
+    dsc->dest_stride = width * px_size;
+    dsc->color       = lv_color_hex(0x3078FF);
+    dsc->opa         = opa;
+}
+
+static void init_image_dsc(lv_draw_sw_blend_image_dsc_t* dsc, uint32_t dest_px_size,
+                           uint32_t src_px_size)
+{
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->dest_buf    = dest_buf;
+    dsc->dest_w      = width;
+    dsc->dest_h      = height;
+    dsc->dest_stride = width * dest_px_size;
+    dsc->src_buf     = src_buf;
+    dsc->src_stride  = width * src_px_size;
+    dsc->opa         = LV_OPA_COVER;
+    dsc->blend_mode  = LV_BLEND_MODE_NORMAL;
+}
+
+static void run_fill_rgb565(void)
+{
+    lv_draw_sw_blend_fill_dsc_t dsc;
+    init_fill_dsc(&dsc, 2, LV_OPA_COVER);
+    blend_neon_fill_rgb565(&dsc);
+}
+
+static void run_fill_rgb565_opa(void)
+{
+    lv_draw_sw_blend_fill_dsc_t dsc;
+    init_fill_dsc(&dsc, 2, LV_OPA_40);
+    blend_neon_fill_rgb565_opa(&dsc);
+}
+
+static void run_fill_32(void)
+{
+    lv_draw_sw_blend_fill_dsc_t dsc;
+    init_fill_dsc(&dsc, 4, LV_OPA_COVER);
+    blend_neon_fill_32(&dsc);
+}
+
+static void run_rgb565_to_rgb565(void)
+{
+    lv_draw_sw_blend_image_dsc_t dsc;
+    init_image_dsc(&dsc, 2, 2);
+    blend_neon_rgb565_to_rgb565(&dsc);
+}
+
+static void run_argb8888_to_rgb565(void)
+{
+    lv_draw_sw_blend_image_dsc_t dsc;
+    init_image_dsc(&dsc, 2, 4);
+    blend_neon_argb8888_to_rgb565(&dsc);
+}
+
+static void run_xrgb8888_to_32(void)
+{
+    lv_draw_sw_blend_image_dsc_t dsc;
+    init_image_dsc(&dsc, 4, 4);
+    blend_neon_xrgb8888_to_32(&dsc);
+}
+
+static void run_dither_rgb565(void)
+{
+    color_convert_xrgb8888_to_rgb565_dither(src_buf, width * 4, dest_buf, width * 2, 0, 0,
+                                            width, height);
+}
+
+static const kernel_entry_t kernels[] = {
+    {"fill_rgb565", 2, run_fill_rgb565},
+    {"fill_rgb565_opa", 2, run_fill_rgb565_opa},
+    {"fill_32", 4, run_fill_32},
+    {"rgb565_to_rgb565", 2, run_rgb565_to_rgb565},
+    {"argb8888_to_rgb565", 2, run_argb8888_to_rgb565},
+    {"xrgb8888_to_32", 4, run_xrgb8888_to_32},
+    {"dither_rgb565", 2, run_dither_rgb565},
+};
+
+/**
+ * Run a kernel from the same initial destination and return the CRC of the result
+ */
+static uint32_t run_kernel(const kernel_entry_t* kernel, bool scalar, uint32_t iterations)
+{
+    uint32_t size = width * height * kernel->dest_px_size;
+
+    blend_neon_force_scalar(scalar);
+    color_convert_force_scalar(scalar);
+    memcpy(dest_buf, dest_init, size);
+
+    uint64_t start = bench_now_ns();
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        kernel->run();
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    uint64_t px  = (uint64_t)width * height * (iterations ? iterations : 1);
+    uint32_t crc = bench_crc32(0, dest_buf, size);
+    fprintf(stdout, "bench=blend kernel=%s path=%s ns_per_mpx=%llu crc=0x%08x\n", kernel->name,
+            scalar ? "scalar" : "neon", (unsigned long long)(ns * 1000000ULL / px), crc);
+
+    return crc;
+}
+
+/**
+ * Run the fill and blend kernels on full-screen areas, scalar and NEON
+ */
+int bench_blend(const bench_options_t* options)
+{
+    width  = options->width;
+    height = options->height;
+
+    uint32_t size = width * height * 4;
+    src_buf       = malloc(size);
+    dest_buf      = malloc(size);
+    dest_init     = malloc(size);
+    if(!src_buf || !dest_buf || !dest_init)
+    {
+        fprintf(stderr, "Out of memory\n");
+        free(src_buf);
+        free(dest_buf);
+        free(dest_init);
+        return 1;
+    }
+
+    fill_pattern(src_buf, size, 1);
+    fill_pattern(dest_init, size, 2);
+
+    int rc = 0;
+    for(size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+    {
+        uint32_t crc = run_kernel(&kernels[i], true, options->frames);
+        if(BLEND_NEON && run_kernel(&kernels[i], false, options->frames) != crc)
+        {
+            fprintf(stderr, "Kernel %s: NEON result differs from scalar\n", kernels[i].name);
+            rc = 1;
+        }
+    }
+
+    blend_neon_force_scalar(false);
+    color_convert_force_scalar(false);
+
+    free(src_buf);
+    free(dest_buf);
+    free(dest_init);
+    return rc;
+}
@@ -0,0 +1,179 @@
+/*******************************************************************
+ *
+ * bench_downsample.c - History downsampling benchmark
+ *
+ * Reduces synthetic histories of 10k to 1M samples to the display
+ * width with each downsampling function. The input is a slow daily
+ * wave with noise, single-sample spikes and a gap, so the results
+ * also show whether the peaks survive: the min/max envelope must keep
+ * the extremes exactly, LTTB reports whether it kept them. Needs no
+ * display.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bench.h"
+#include "../data/downsample.h"
+#include "../data/sensor_types.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum
+{
+    ALGO_LTTB,
+    ALGO_MINMAX,
+    ALGO_SUM,
+} algo_t;
+
+typedef struct
+{
+    const char* name;
+    algo_t      algo;
+} algo_entry_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const uint32_t input_sizes[] = {10000, 100000, 1000000};
+
+static const algo_entry_t algos[] = {
+    {"lttb", ALGO_LTTB},
+    {"minmax", ALGO_MINMAX},
+    {"sum", ALGO_SUM},
+};
+
+/**
+ * Fill a repeatable temperature-like history, fixed point with one decimal
+ */
+static void fill_history(int32_t* values, uint32_t count)
+{
+    uint32_t seed = 1;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        // Ten days of waves between 5 and 25 degrees, plus up to a degree of noise
+        double wave = 150.0 + 100.0 * sin(i * 2.0 * M_PI * 10.0 / count);
+        values[i]   = (int32_t)wave + (int32_t)((seed >> 16) % 21) - 10;
+
+        // A few spikes of a single sample
+        if((seed >> 8) % 4096 == 0)
+            values[i] += ((seed >> 20) & 1) ? 300 : -300;
+    }
+
+    // A sensor outage of 1%
+    for(uint32_t i = count / 2; i < count / 2 + count / 100; i++)
+    {
+        values[i] = HISTORY_POINT_NONE;
+    }
+}
+
+/**
+ * Get the lowest and highest value, skipping gaps
+ */
+static void find_range(const int32_t* values, uint32_t count, int32_t* min, int32_t* max)
+{
+    *min = HISTORY_POINT_NONE;
+    *max = HISTORY_POINT_NONE;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(values[i] == HISTORY_POINT_NONE)
+            continue;
+        if(*min == HISTORY_POINT_NONE || values[i] < *min)
+            *min = values[i];
+        if(*max == HISTORY_POINT_NONE || values[i] > *max)
+            *max = values[i];
+    }
+}
+
+/**
+ * Run one function on one input and print the result line
+ * @return false if the min/max envelope lost an extreme
+ */
+static bool run_algo(const algo_entry_t* entry, const int32_t* values, uint32_t count,
+                     uint32_t out_count, uint64_t iterations, int32_t* out_a, int32_t* out_b)
+{
+    uint32_t written = 0;
+
+    uint64_t start = bench_now_ns();
+    for(uint64_t i = 0; i < iterations; i++)
+    {
+        if(entry->algo == ALGO_LTTB)
+            written = downsample_lttb(values, count, out_count, out_a);
+        else if(entry->algo == ALGO_MINMAX)
+            written = downsample_minmax(values, count, out_count, out_a, out_b);
+        else
+            written = downsample_sum(values, count, out_count, out_a);
+    }
+    uint64_t ns = (bench_now_ns() - start) / iterations;
+
+    // The extremes of the input against those of the output
+    int32_t in_min, in_max, out_min, out_max, unused;
+    find_range(values, count, &in_min, &in_max);
+    find_range(out_a, written, &out_min, &out_max);
+    if(entry->algo == ALGO_MINMAX)
+        find_range(out_b, written, &unused, &out_max);
+    bool        peaks_kept = (out_min == in_min && out_max == in_max);
+    const char* peaks      = entry->algo == ALGO_SUM ? "n/a" : (peaks_kept ? "yes" : "no");
+
+    uint32_t crc = bench_crc32(0, (const uint8_t*)out_a, written * sizeof(int32_t));
+    fprintf(stdout,
+            "bench=downsample algo=%s points=%u out=%u ns=%llu ns_per_kpoint=%llu "
+            "peaks_kept=%s crc=0x%08x\n",
+            entry->name, (unsigned)count, (unsigned)written, (unsigned long long)ns,
+            (unsigned long long)(ns * 1000ULL / count), peaks, crc);
+
+    if(entry->algo == ALGO_MINMAX && !peaks_kept)
+    {
+        fprintf(stderr, "Min/max envelope of %u points lost an extreme\n", (unsigned)count);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reduce 10k to 1M sample histories to the display width
+ */
+int bench_downsample(const bench_options_t* options)
+{
+    uint32_t max_count = input_sizes[sizeof(input_sizes) / sizeof(input_sizes[0]) - 1];
+    uint32_t out_count = options->width;
+
+    int32_t* values = malloc(max_count * sizeof(int32_t));
+    int32_t* out_a  = malloc(out_count * sizeof(int32_t));
+    int32_t* out_b  = malloc(out_count * sizeof(int32_t));
+    if(!values || !out_a || !out_b)
+    {
+        fprintf(stderr, "Out of memory\n");
+        free(values);
+        free(out_a);
+        free(out_b);
+        return 1;
+    }
+
+    int rc = 0;
+    for(size_t i = 0; i < sizeof(input_sizes) / sizeof(input_sizes[0]); i++)
+    {
+        uint32_t count = input_sizes[i];
+        fill_history(values, count);
+
+        // About the same number of samples for every size
+        uint64_t iterations = (uint64_t)options->frames * 10000 / count;
+        if(iterations == 0)
+            iterations = 1;
+
+        for(size_t j = 0; j < sizeof(algos) / sizeof(algos[0]); j++)
+        {
+            if(!run_algo(&algos[j], values, count, out_count, iterations, out_a, out_b))
+                rc = 1;
+        }
+    }
+
+    free(values);
+    free(out_a);
+    free(out_b);
+    return rc;
+}
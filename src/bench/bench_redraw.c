@@ -0,0 +1,87 @@
+/*******************************************************************
+ *
+ * bench_redraw.c - Full-screen redraw benchmark
+ *
+ * Invalidates the whole screen and renders it synchronously, which
+ * is the worst case for the software renderer and the case that
+ * scales with the number of draw units. Build with different
+ * CAMPER_DRAW_UNITS values to compare.
+ *
+ ******************************************************************/
+#include <stdio.h>
+
+#include "lvgl/lvgl.h"
+#include "bench.h"
+#include "../lib/display_backend.h"
+#include "../lib/logger.h"
+#include "../data/data_manager.h"
+#include "../ui/ui.h"
+#include "../ui/ui_store.h"
+#include "../main.h"
+
+/**
+ * Render the full screen of each tab from data snapshots
+ */
+int bench_redraw(const bench_options_t* options)
+{
+    logger_set_level(LOG_LEVEL_WARNING);
+
+    bench_lvgl_init();
+    data_manager_use_snapshots(options->snapshot_dir);
+
+    display_config_t config = {
+        .type          = DISPLAY_BACKEND_HEADLESS,
+        .width         = options->width,
+        .height        = options->height,
+        .color_profile = options->color_profile,
+    };
+    if(display_backend_init(&config) != 0)
+    {
+        return 1;
+    }
+
+    create_ui();
+
+    // Let the update timers fill in the snapshot data once
+    bench_clock_advance(DATA_CHART_UPDATE_INTERVAL_MS);
+    lv_timer_handler();
+    ui_store_update();
+
+    lv_obj_t* tabview   = ui_get_tabview();
+    uint32_t  tab_count = lv_tabview_get_tab_count(tabview);
+
+    for(uint32_t tab = 0; tab < tab_count; tab++)
+    {
+        ui_set_active_tab(tab);
+        lv_refr_now(NULL);
+
+        uint64_t total_ns = 0;
+        uint64_t max_ns   = 0;
+
+        for(uint32_t i = 0; i < options->frames; i++)
+        {
+            lv_obj_invalidate(lv_screen_active());
+
+            uint64_t start = bench_now_ns();
+            lv_refr_now(NULL);
+            uint64_t ns = bench_now_ns() - start;
+
+            total_ns += ns;
+            if(ns > max_ns)
+            {
+                max_ns = ns;
+            }
+        }
+
+        fprintf(stdout,
+                "bench=redraw tab=%s draw_units=%d width=%d height=%d frames=%u "
+                "ns_per_frame=%llu max_ns=%llu\n",
+                bench_tab_name(tabview, tab), LV_DRAW_SW_DRAW_UNIT_CNT, options->width,
+                options->height, options->frames,
+                options->frames ? (unsigned long long)(total_ns / options->frames) : 0ULL,
+                (unsigned long long)max_ns);
+    }
+
+    display_backend_deinit();
+    return 0;
+}
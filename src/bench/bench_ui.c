@@ -0,0 +1,156 @@
+/*******************************************************************
+ *
+ * bench_ui.c - UI render benchmark on the headless backend
+ *
+ * Creates the full UI on an in-memory display, fed from recorded
+ * API responses and driven by a synthetic clock, then renders each
+ * tab for a fixed number of frames. The update timers fire at the
+ * same synthetic times on every run, so the measured work and the
+ * resulting frames are repeatable.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "lvgl/lvgl.h"
+#include "bench.h"
+#include "../lib/display_backend.h"
+#include "../lib/lv_headless_disp.h"
+#include "../lib/logger.h"
+#include "../data/data_manager.h"
+#include "../ui/ui.h"
+#include "../ui/ui_store.h"
+#include "../main.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    uint32_t frames;     // Refreshes that rendered something
+    uint64_t render_ns;  // Total refresh time of those frames
+    uint64_t max_ns;     // Slowest frame
+    uint64_t dirty_px;   // Total flushed pixels
+    uint32_t crc;        // CRC chained over all rendered frames
+    uint64_t start_ns;   // Start of the current refresh
+    bool     rendered;   // Current refresh rendered something
+    uint64_t frame_px;   // Flushed pixels of the current refresh
+} tab_result_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static tab_result_t result;
+
+/**
+ * Display event callback, measures each refresh and checksums the frame
+ */
+static void bench_display_event_cb(lv_event_t* e)
+{
+    switch(lv_event_get_code(e))
+    {
+        case LV_EVENT_REFR_START:
+            result.start_ns = bench_now_ns();
+            result.rendered = false;
+            result.frame_px = 0;
+            break;
+
+        case LV_EVENT_RENDER_START: result.rendered = true; break;
+
+        case LV_EVENT_FLUSH_START:
+        {
+            const lv_area_t* area = lv_event_get_param(e);
+            if(area)
+            {
+                result.frame_px += lv_area_get_size(area);
+            }
+            break;
+        }
+
+        case LV_EVENT_REFR_READY:
+        {
+            if(!result.rendered)
+                break;
+
+            uint64_t ns = bench_now_ns() - result.start_ns;
+            result.frames++;
+            result.render_ns += ns;
+            result.dirty_px += result.frame_px;
+            if(ns > result.max_ns)
+            {
+                result.max_ns = ns;
+            }
+
+            uint32_t       size;
+            const uint8_t* frame = lv_headless_disp_get_frame(&size);
+            result.crc           = bench_crc32(result.crc, frame, size);
+            break;
+        }
+
+        default: break;
+    }
+}
+
+/**
+ * Render each tab on the headless backend from data snapshots
+ */
+int bench_ui(const bench_options_t* options)
+{
+    // Keep the logs tab and stdout free of routine messages
+    logger_set_level(LOG_LEVEL_WARNING);
+
+    bench_lvgl_init();
+    data_manager_use_snapshots(options->snapshot_dir);
+
+    display_config_t config = {
+        .type          = DISPLAY_BACKEND_HEADLESS,
+        .width         = options->width,
+        .height        = options->height,
+        .color_profile = options->color_profile,
+    };
+    if(display_backend_init(&config) != 0)
+    {
+        return 1;
+    }
+
+    lv_display_t* disp = lv_display_get_default();
+    lv_display_add_event_cb(disp, bench_display_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, bench_display_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, bench_display_event_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(disp, bench_display_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    uint64_t create_start = bench_now_ns();
+    create_ui();
+    fprintf(stdout, "bench=ui scenario=create ns=%llu\n",
+            (unsigned long long)(bench_now_ns() - create_start));
+
+    lv_obj_t* tabview   = ui_get_tabview();
+    uint32_t  tab_count = lv_tabview_get_tab_count(tabview);
+    uint64_t  screen_px = (uint64_t)options->width * options->height;
+
+    for(uint32_t tab = 0; tab < tab_count; tab++)
+    {
+        ui_set_active_tab(tab);
+        lv_obj_invalidate(lv_screen_active());
+        memset(&result, 0, sizeof(result));
+
+        for(uint32_t i = 0; i < options->frames; i++)
+        {
+            bench_clock_advance(BENCH_FRAME_PERIOD_MS);
+            ui_store_update();
+            lv_timer_handler();
+        }
+
+        fprintf(stdout,
+                "bench=ui scenario=tab tab=%s frames=%u rendered=%u ns_per_frame=%llu "
+                "max_ns=%llu dirty_pct=%.2f crc=0x%08x\n",
+                bench_tab_name(tabview, tab), options->frames, result.frames,
+                result.frames ? (unsigned long long)(result.render_ns / result.frames) : 0ULL,
+                (unsigned long long)result.max_ns,
+                result.frames ? 100.0 * result.dirty_px / (screen_px * result.frames) : 0.0,
+                result.crc);
+    }
+
+    display_backend_deinit();
+    return 0;
+}
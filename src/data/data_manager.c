@@ -8,9 +8,13 @@
 #include <stdio.h> // Add this for snprintf
 #include <pthread.h>
 #include <unistd.h>
+#include <errno.h>
 #include "data_manager.h"
 #include "sensor_parsers.h"
 #include "data_actions.h"
+#include "history_series.h"
+#include "history_lod.h"
+#include "sensor_trace.h"
 #include "../lib/http_client.h"
 #include "../lib/logger.h"
 #include "../lib/mem_debug.h"
@@ -23,13 +27,12 @@ static climate_sensor_t inside_climate  = {0};
 static climate_sensor_t outside_climate = {0};
 static camper_sensor_t  camper          = {0};
 
-// Global variable to hold history data
-static entity_history_t  entity_history          = {0};
-static history_request_t current_history_request = {0};
-
 // Mutex for thread safety
 static pthread_mutex_t data_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Changes whenever the sensor data above may have changed, protected by data_mutex
+static uint32_t data_generation = 0;
+
 // Background worker thread
 static pthread_t     worker_thread   = 0;
 static volatile bool fetch_requested = false;
@@ -39,7 +42,7 @@ static volatile bool worker_running  = false;
 typedef struct
 {
     fetch_request_type_t request_type;
-    uint32_t             timestamp; // For prioritization if needed
+    sensor_trace_t       trace; // Stamps on the way to the screen, ENQUEUED ages the request
 
     // For history requests
     history_request_t history_params;
@@ -50,6 +53,14 @@ static volatile int    fetch_queue_head = 0;
 static volatile int    fetch_queue_tail = 0;
 static pthread_mutex_t fetch_mutex      = PTHREAD_MUTEX_INITIALIZER;
 
+// Worker sleeps on this condition until a fetch or action is queued
+static pthread_mutex_t        work_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t         work_cond  = PTHREAD_COND_INITIALIZER;
+static background_notify_cb_t notify_cb  = NULL;
+
+// Recorded API responses served instead of HTTP, for offline benchmarks
+static const char* snapshot_dir = NULL;
+
 static bool is_fetch_queue_empty(void);
 static bool is_fetch_queue_full(void);
 static bool enqueue_fetch_request(fetch_request_type_t request_type);
@@ -76,13 +87,15 @@ static bool  is_action_queue_empty(void);
 static bool  is_action_queue_full(void);
 static bool  enqueue_action(const camper_action_t* action);
 static bool  dequeue_action(camper_action_t* action);
+static void  signal_worker(void);
+static void  wait_for_work(void);
 
-static int fetch_data_internal(fetch_request_type_t request_type);
-static int fetch_camper_data_internal(void);
-static int fetch_climate_data_internal(const char* location);
-static int fetch_smart_solar_data_internal(void);
-static int fetch_smart_shunt_data_internal(void);
-static int fetch_entity_history_data_internal(void);
+static int fetch_data_internal(const fetch_request_t* request);
+static int fetch_camper_data_internal(sensor_trace_t* trace);
+static int fetch_climate_data_internal(const char* location, sensor_trace_t* trace);
+static int fetch_smart_solar_data_internal(sensor_trace_t* trace);
+static int fetch_smart_shunt_data_internal(sensor_trace_t* trace);
+static int fetch_entity_history_data_internal(const history_request_t* request, bool lod);
 
 /**
  * Initialize the background worker system
@@ -101,10 +114,6 @@ int init_background_fetcher(void)
     inside_climate.valid  = false;
     outside_climate.valid = false;
 
-    // Initialize entity_history completely to prevent segfaults
-    memset(&entity_history, 0, sizeof(entity_history_t));
-    entity_history.valid = false;
-
     worker_running    = true;
     fetch_requested   = false;
     action_queue_head = action_queue_tail = 0;
@@ -132,6 +141,7 @@ void shutdown_background_fetcher(void)
 
     log_info("Shutting down background worker");
     worker_running = false;
+    signal_worker();
 
     // Wait for thread to exit
     if(worker_thread)
@@ -149,6 +159,14 @@ bool is_background_busy(void)
     return !is_fetch_queue_empty() || !is_action_queue_empty();
 }
 
+/**
+ * Set a callback invoked from the worker thread after it completed work
+ */
+void set_background_notify_cb(background_notify_cb_t cb)
+{
+    notify_cb = cb;
+}
+
 /*
  * Request a camper action in the background
  */
@@ -179,6 +197,14 @@ void request_camper_action(const char* entity_name, const char* status)
  */
 bool request_data_fetch(fetch_request_type_t request_type)
 {
+    // Snapshots are served synchronously so benchmark runs are reproducible
+    if(snapshot_dir)
+    {
+        fetch_request_t request = {.request_type = request_type};
+        sensor_trace_start(&request.trace);
+        return fetch_data_internal(&request) == 0;
+    }
+
     if(!worker_running)
     {
         log_error("Background worker not running, initialize it first");
@@ -201,17 +227,18 @@ bool request_data_fetch(fetch_request_type_t request_type)
 }
 
 /**
- * Request historical data for a specific entity
+ * Queue a history request, or fetch it right away when serving snapshots
+ * @param request_type FETCH_ENTITY_HISTORY or FETCH_HISTORY_LOD
  * @param sensor_name Name of the sensor (e.g., "inside", "SmartSolar")
  * @param entity_name Name of the entity (e.g., "temperature")
  * @param interval Time interval for data points (e.g., "hour", "day")
  * @param samples Number of data points to retrieve
  * @return true if request was queued successfully, false otherwise
  */
-bool request_entity_history(const char* sensor_name, const char* entity_name, const char* interval,
-                            int samples)
+static bool queue_history_request(fetch_request_type_t request_type, const char* sensor_name,
+                                  const char* entity_name, const char* interval, int samples)
 {
-    if(!worker_running)
+    if(!worker_running && !snapshot_dir)
     {
         log_error("Background worker not running, initialize it first");
         return false;
@@ -230,18 +257,37 @@ bool request_entity_history(const char* sensor_name, const char* entity_name, co
     snprintf(request.interval, sizeof(request.interval), "%s", interval);
     request.samples = samples;
 
-    // Queue the request with history parameters
-    bool queued = enqueue_fetch_request_with_history(FETCH_ENTITY_HISTORY, &request);
-
-    // Store the current request parameters for reference (still used by get_entity_history_data)
-    if(queued)
+    if(snapshot_dir)
     {
-        pthread_mutex_lock(&data_mutex);
-        memcpy(&current_history_request, &request, sizeof(history_request_t));
-        pthread_mutex_unlock(&data_mutex);
+        bool lod = (request_type == FETCH_HISTORY_LOD);
+        return fetch_entity_history_data_internal(&request, lod) == 0;
     }
 
-    return queued;
+    // Queue the request with history parameters
+    return enqueue_fetch_request_with_history(request_type, &request);
+}
+
+/**
+ * Request historical data for a specific entity
+ */
+bool request_entity_history(const char* sensor_name, const char* entity_name, const char* interval,
+                            int samples)
+{
+    return queue_history_request(FETCH_ENTITY_HISTORY, sensor_name, entity_name, interval,
+                                 samples);
+}
+
+/**
+ * Request history for the analytics pyramid
+ * @param sensor_name Name of the sensor (e.g., "SmartShunt")
+ * @param entity_name Name of the entity (e.g., "soc")
+ * @param samples Number of ANALYTICS_PERIOD samples up to now
+ * @return true if request was queued successfully, false otherwise
+ */
+bool request_history_lod(const char* sensor_name, const char* entity_name, int samples)
+{
+    return queue_history_request(FETCH_HISTORY_LOD, sensor_name, entity_name, ANALYTICS_PERIOD,
+                                 samples);
 }
 
 // New function to enqueue a fetch request with history parameters
@@ -268,9 +314,10 @@ static bool enqueue_fetch_request_with_history(fetch_request_type_t request_type
     if(!duplicate && !is_fetch_queue_full())
     {
         fetch_queue[fetch_queue_tail].request_type = request_type;
-        fetch_queue[fetch_queue_tail].timestamp    = time(NULL);
+        sensor_trace_start(&fetch_queue[fetch_queue_tail].trace);
 
-        if(history_params && request_type == FETCH_ENTITY_HISTORY)
+        if(history_params &&
+           (request_type == FETCH_ENTITY_HISTORY || request_type == FETCH_HISTORY_LOD))
         {
             memcpy(&fetch_queue[fetch_queue_tail].history_params, history_params,
                    sizeof(history_request_t));
@@ -282,6 +329,11 @@ static bool enqueue_fetch_request_with_history(fetch_request_type_t request_type
 
     pthread_mutex_unlock(&fetch_mutex);
 
+    if(result)
+    {
+        signal_worker();
+    }
+
     return result;
 }
 
@@ -303,8 +355,8 @@ static bool is_fetch_queue_full(void)
 
 static bool dequeue_fetch_request(fetch_request_t* request)
 {
-    bool   result       = false;
-    time_t current_time = time(NULL);
+    bool     result       = false;
+    uint64_t current_time = sensor_trace_now_ns();
 
     pthread_mutex_lock(&fetch_mutex);
 
@@ -313,11 +365,12 @@ static bool dequeue_fetch_request(fetch_request_t* request)
         *request = fetch_queue[fetch_queue_head];
 
         // Check if the request is stale
-        if(current_time - request->timestamp > REQUEST_TIMEOUT_SECONDS)
+        uint64_t age_s = (current_time - request->trace.stamp_ns[TRACE_ENQUEUED]) / 1000000000ULL;
+        if(age_s > REQUEST_TIMEOUT_SECONDS)
         {
             // Log that we're skipping a stale request
-            log_warning("Skipping stale request type %d (age: %ld seconds)", request->request_type,
-                        current_time - request->timestamp);
+            log_warning("Skipping stale request type %d (age: %llu seconds)",
+                        request->request_type, (unsigned long long)age_s);
 
             // Move to the next request
             fetch_queue_head = (fetch_queue_head + 1) % MAX_FETCH_QUEUE;
@@ -325,7 +378,8 @@ static bool dequeue_fetch_request(fetch_request_t* request)
         }
 
         fetch_queue_head = (fetch_queue_head + 1) % MAX_FETCH_QUEUE;
-        result           = true;
+        sensor_trace_stamp(&request->trace, TRACE_DEQUEUED);
+        result = true;
         break;
     }
 
@@ -368,6 +422,11 @@ static bool enqueue_action(const camper_action_t* action)
 
     pthread_mutex_unlock(&action_mutex);
 
+    if(result)
+    {
+        signal_worker();
+    }
+
     return result;
 }
 
@@ -392,6 +451,29 @@ static bool dequeue_action(camper_action_t* action)
     return result;
 }
 
+/**
+ * Wake the worker thread after queueing work or on shutdown
+ */
+static void signal_worker(void)
+{
+    pthread_mutex_lock(&work_mutex);
+    pthread_cond_signal(&work_cond);
+    pthread_mutex_unlock(&work_mutex);
+}
+
+/**
+ * Block the worker thread until work is queued or it should exit
+ */
+static void wait_for_work(void)
+{
+    pthread_mutex_lock(&work_mutex);
+    while(worker_running && is_fetch_queue_empty() && is_action_queue_empty())
+    {
+        pthread_cond_wait(&work_cond, &work_mutex);
+    }
+    pthread_mutex_unlock(&work_mutex);
+}
+
 /**
  * Background thread function that handles work requests
  */
@@ -409,7 +491,7 @@ static void* background_worker_thread(void* arg)
         // Handle one fetch request from the queue
         if(dequeue_fetch_request(&fetch_request))
         {
-            fetch_data_internal(fetch_request.request_type);
+            fetch_data_internal(&fetch_request);
             did_work = true;
         }
 
@@ -420,10 +502,17 @@ static void* background_worker_thread(void* arg)
             did_work = true;
         }
 
-        // If no work was done this iteration, sleep
-        if(!did_work)
+        // Let the UI pick up the results, or sleep until new work is queued
+        if(did_work)
+        {
+            if(notify_cb)
+            {
+                notify_cb();
+            }
+        }
+        else
         {
-            usleep(BACKGROUND_FETCH_SLEEP_US);
+            wait_for_work();
         }
     }
 
@@ -431,21 +520,130 @@ static void* background_worker_thread(void* arg)
     return NULL;
 }
 
+/**
+ * Read a recorded API response from the snapshot directory
+ * The file name is the URL path without query, with '/' replaced by '_', e.g.
+ * /sensors/camper/states/ is read from sensors_camper_states.json.
+ */
+static http_response_t snapshot_get(const char* api_url)
+{
+    http_response_t response = {0};
+
+    const char* path = api_url + strlen(API_BASE_URL);
+    while(*path == '/')
+    {
+        path++;
+    }
+
+    char name[MAX_URL_LENGTH];
+    int  len = 0;
+    for(; *path && *path != '?' && len < (int)sizeof(name) - 1; path++)
+    {
+        name[len++] = (*path == '/') ? '_' : *path;
+    }
+    while(len > 0 && name[len - 1] == '_')
+    {
+        len--;
+    }
+    name[len] = '\0';
+
+    char file_path[MAX_URL_LENGTH * 2];
+    snprintf(file_path, sizeof(file_path), "%s/%s.json", snapshot_dir, name);
+
+    FILE* fp = fopen(file_path, "rb");
+    if(!fp)
+    {
+        snprintf(response.error, sizeof(response.error), "%s: %s", file_path, strerror(errno));
+        response.status_code = 404;
+        return response;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    response.body = (size >= 0) ? mem_malloc(size + 1) : NULL;
+    if(response.body && fread(response.body, 1, size, fp) == (size_t)size)
+    {
+        response.body[size]  = '\0';
+        response.status_code = 200;
+        response.success     = true;
+    }
+    else
+    {
+        snprintf(response.error, sizeof(response.error), "Failed to read %s", file_path);
+    }
+    fclose(fp);
+
+    return response;
+}
+
+/**
+ * Get an API response over HTTP, or from the snapshot directory when set
+ * @param trace stamped with the request start and the first byte, NULL for none
+ */
+static http_response_t data_get(const char* api_url, sensor_trace_t* trace)
+{
+    http_response_t response;
+
+    sensor_trace_stamp(trace, TRACE_HTTP_START);
+    if(snapshot_dir)
+    {
+        response = snapshot_get(api_url);
+    }
+    else
+    {
+        response = http_get(api_url, HTTP_TIMEOUT_SECONDS);
+    }
+
+    if(trace)
+    {
+        trace->stamp_ns[TRACE_FIRST_BYTE] =
+            trace->stamp_ns[TRACE_HTTP_START] + response.first_byte_us * 1000ULL;
+    }
+
+    return response;
+}
+
+/**
+ * Serve data requests from recorded API responses instead of the server
+ */
+void data_manager_use_snapshots(const char* dir)
+{
+    snapshot_dir = dir;
+    log_info("Serving data from snapshots in %s", dir);
+}
+
 /**
  * Internal function to fetch specific sensor data based on request type
  */
-static int fetch_data_internal(fetch_request_type_t request_type)
+static int fetch_data_internal(const fetch_request_t* request)
 {
-    switch(request_type)
+    sensor_trace_t trace = request->trace;
+    int            rc;
+
+    switch(request->request_type)
     {
-        case FETCH_CAMPER_DATA: return fetch_camper_data_internal();
-        case FETCH_CLIMATE_INSIDE: return fetch_climate_data_internal("inside");
-        case FETCH_CLIMATE_OUTSIDE: return fetch_climate_data_internal("outside");
-        case FETCH_SMART_SOLAR: return fetch_smart_solar_data_internal();
-        case FETCH_SMART_SHUNT: return fetch_smart_shunt_data_internal();
-        case FETCH_ENTITY_HISTORY: return fetch_entity_history_data_internal();
-        default: log_warning("Unimplemented fetch request type: %d", request_type); return -1;
+        case FETCH_CAMPER_DATA: rc = fetch_camper_data_internal(&trace); break;
+        case FETCH_CLIMATE_INSIDE: rc = fetch_climate_data_internal("inside", &trace); break;
+        case FETCH_CLIMATE_OUTSIDE: rc = fetch_climate_data_internal("outside", &trace); break;
+        case FETCH_SMART_SOLAR: rc = fetch_smart_solar_data_internal(&trace); break;
+        case FETCH_SMART_SHUNT: rc = fetch_smart_shunt_data_internal(&trace); break;
+        case FETCH_ENTITY_HISTORY:
+            return fetch_entity_history_data_internal(&request->history_params, false);
+        case FETCH_HISTORY_LOD:
+            return fetch_entity_history_data_internal(&request->history_params, true);
+        default:
+            log_warning("Unimplemented fetch request type: %d", request->request_type);
+            return -1;
     }
+
+    // A failed fetch marks the data invalid, so the data changed either way
+    pthread_mutex_lock(&data_mutex);
+    data_generation++;
+    pthread_mutex_unlock(&data_mutex);
+
+    return rc;
 }
 
 /**
@@ -494,12 +692,12 @@ void clear_entity_history(entity_history_t* history)
 /**
  * Internal function to fetch camper data from the server and update local state
  */
-static int fetch_camper_data_internal(void)
+static int fetch_camper_data_internal(sensor_trace_t* trace)
 {
     char api_url[MAX_URL_LENGTH];
     snprintf(api_url, sizeof(api_url), "%s/sensors/camper/states/", API_BASE_URL);
 
-    http_response_t response = http_get(api_url, HTTP_TIMEOUT_SECONDS);
+    http_response_t response = data_get(api_url, trace);
 
     if(!response.success)
     {
@@ -522,12 +720,15 @@ static int fetch_camper_data_internal(void)
     camper_sensor_t temp_camper = {0};
     if(parse_camper_states(response.body, &temp_camper))
     {
-        temp_camper.valid = true;
+        sensor_trace_stamp(trace, TRACE_PARSED);
+        temp_camper.received_ns = trace->stamp_ns[TRACE_FIRST_BYTE];
+        temp_camper.valid       = true;
 
         // Update the actual data structure in a thread-safe manner
         pthread_mutex_lock(&data_mutex);
         memcpy(&camper, &temp_camper, sizeof(camper_sensor_t));
         pthread_mutex_unlock(&data_mutex);
+        sensor_trace_publish(SENSOR_CAMPER, trace);
 
         // Debug output
         log_debug("Camper data updated: household_v=%.2f, starter_v=%.2f, mains_v=%.2f",
@@ -553,12 +754,12 @@ static int fetch_camper_data_internal(void)
  * Internal function to fetch climate data from the server and update local state
  * @param location "inside" or "outside" to specify which climate sensor to fetch
  */
-static int fetch_climate_data_internal(const char* location)
+static int fetch_climate_data_internal(const char* location, sensor_trace_t* trace)
 {
     char api_url[MAX_URL_LENGTH];
     snprintf(api_url, sizeof(api_url), "%s/sensors/%s/states/", API_BASE_URL, location);
 
-    http_response_t response = http_get(api_url, HTTP_TIMEOUT_SECONDS);
+    http_response_t response = data_get(api_url, trace);
 
     if(!response.success)
     {
@@ -586,8 +787,12 @@ static int fetch_climate_data_internal(const char* location)
 
     // Parse the response
     climate_sensor_t temp_climate = {0};
+    sensor_id_t      sensor       = SENSOR_COUNT;
     if(parse_climate_sensor(response.body, &temp_climate))
     {
+        sensor_trace_stamp(trace, TRACE_PARSED);
+        temp_climate.received_ns = trace->stamp_ns[TRACE_FIRST_BYTE];
+
         // Set valid flag
         temp_climate.valid = true;
 
@@ -598,6 +803,7 @@ static int fetch_climate_data_internal(const char* location)
             memcpy(&inside_climate, &temp_climate, sizeof(climate_sensor_t));
             log_debug("Inside climate data updated: temperature=%.2f, humidity=%.2f, battery=%.2f",
                       inside_climate.temperature, inside_climate.humidity, inside_climate.battery);
+            sensor = SENSOR_CLIMATE_INSIDE;
         }
         else if(strcmp(location, "outside") == 0)
         {
@@ -605,8 +811,14 @@ static int fetch_climate_data_internal(const char* location)
             log_debug("Outside climate data updated: temperature=%.2f, humidity=%.2f, battery=%.2f",
                       outside_climate.temperature, outside_climate.humidity,
                       outside_climate.battery);
+            sensor = SENSOR_CLIMATE_OUTSIDE;
         }
         pthread_mutex_unlock(&data_mutex);
+
+        if(sensor != SENSOR_COUNT)
+        {
+            sensor_trace_publish(sensor, trace);
+        }
     }
     else
     {
@@ -630,12 +842,12 @@ static int fetch_climate_data_internal(const char* location)
 /**
  * Internal function to fetch SmartSolar data from the server and update local state
  */
-static int fetch_smart_solar_data_internal(void)
+static int fetch_smart_solar_data_internal(sensor_trace_t* trace)
 {
     char api_url[MAX_URL_LENGTH];
     snprintf(api_url, sizeof(api_url), "%s/sensors/SmartSolar/states/", API_BASE_URL);
 
-    http_response_t response = http_get(api_url, HTTP_TIMEOUT_SECONDS);
+    http_response_t response = data_get(api_url, trace);
 
     if(!response.success)
     {
@@ -658,6 +870,9 @@ static int fetch_smart_solar_data_internal(void)
     smart_solar_t temp_solar = {0};
     if(parse_smart_solar(response.body, &temp_solar))
     {
+        sensor_trace_stamp(trace, TRACE_PARSED);
+        temp_solar.received_ns = trace->stamp_ns[TRACE_FIRST_BYTE];
+
         // Set valid flag
         temp_solar.valid = true;
 
@@ -665,6 +880,7 @@ static int fetch_smart_solar_data_internal(void)
         pthread_mutex_lock(&data_mutex);
         memcpy(&smart_solar, &temp_solar, sizeof(smart_solar_t));
         pthread_mutex_unlock(&data_mutex);
+        sensor_trace_publish(SENSOR_SMART_SOLAR, trace);
 
         // Debug output
         log_debug("SmartSolar data updated: battery_v=%.2f, charging_current=%.2f, power=%.2f W, "
@@ -688,12 +904,12 @@ static int fetch_smart_solar_data_internal(void)
 /**
  * Internal function to fetch SmartShunt data from the server and update local state
  */
-static int fetch_smart_shunt_data_internal(void)
+static int fetch_smart_shunt_data_internal(sensor_trace_t* trace)
 {
     char api_url[MAX_URL_LENGTH];
     snprintf(api_url, sizeof(api_url), "%s/sensors/SmartShunt/states/", API_BASE_URL);
 
-    http_response_t response = http_get(api_url, HTTP_TIMEOUT_SECONDS);
+    http_response_t response = data_get(api_url, trace);
 
     if(!response.success)
     {
@@ -716,6 +932,9 @@ static int fetch_smart_shunt_data_internal(void)
     smart_shunt_t temp_shunt = {0};
     if(parse_smart_shunt(response.body, &temp_shunt))
     {
+        sensor_trace_stamp(trace, TRACE_PARSED);
+        temp_shunt.received_ns = trace->stamp_ns[TRACE_FIRST_BYTE];
+
         // Set valid flag
         temp_shunt.valid = true;
 
@@ -723,6 +942,7 @@ static int fetch_smart_shunt_data_internal(void)
         pthread_mutex_lock(&data_mutex);
         memcpy(&smart_shunt, &temp_shunt, sizeof(smart_shunt_t));
         pthread_mutex_unlock(&data_mutex);
+        sensor_trace_publish(SENSOR_SMART_SHUNT, trace);
 
         // Debug output
         log_debug(
@@ -745,25 +965,17 @@ static int fetch_smart_shunt_data_internal(void)
 /**
  * Internal function to fetch entity history data from the server
  */
-static int fetch_entity_history_data_internal(void)
+static int fetch_entity_history_data_internal(const history_request_t* request, bool lod)
 {
-    char              api_url[MAX_URL_LENGTH];
-    history_request_t request;
-
-    // Get the history request parameters from the current request being processed
-    pthread_mutex_lock(&fetch_mutex);
-    // Look at head-1 position since we've already dequeued
-    int previous_head = (fetch_queue_head == 0) ? MAX_FETCH_QUEUE - 1 : fetch_queue_head - 1;
-    memcpy(&request, &fetch_queue[previous_head].history_params, sizeof(history_request_t));
-    pthread_mutex_unlock(&fetch_mutex);
+    char api_url[MAX_URL_LENGTH];
 
     // Construct the API URL with the request parameters
     snprintf(api_url, sizeof(api_url), "%s/grouped_states_by_name/%s/%s?period=%s&samples=%d",
-             API_BASE_URL, request.sensor_name, request.entity_name, request.interval,
-             request.samples);
+             API_BASE_URL, request->sensor_name, request->entity_name, request->interval,
+             request->samples);
 
     log_debug("Fetching entity history: %s", api_url);
-    http_response_t response = http_get(api_url, HTTP_TIMEOUT_SECONDS);
+    http_response_t response = data_get(api_url, NULL);
 
     if(!response.success)
     {
@@ -774,11 +986,7 @@ static int fetch_entity_history_data_internal(void)
         }
         http_response_free(&response);
 
-        // Mark data as invalid
-        pthread_mutex_lock(&data_mutex);
-        entity_history.valid = false;
-        pthread_mutex_unlock(&data_mutex);
-
+        // The charts keep showing the previous history
         return -1;
     }
 
@@ -786,38 +994,32 @@ static int fetch_entity_history_data_internal(void)
     entity_history_t temp_history = {0}; // Ensure zero-initialization
 
     // Pre-set the sensor name in the temp structure before parsing
-    strncpy(temp_history.sensor_name, request.sensor_name, sizeof(temp_history.sensor_name) - 1);
+    strncpy(temp_history.sensor_name, request->sensor_name, sizeof(temp_history.sensor_name) - 1);
     temp_history.sensor_name[sizeof(temp_history.sensor_name) - 1] = '\0';
 
     if(parse_entity_history(response.body, &temp_history))
     {
-        // Set valid flag
         temp_history.valid = true;
 
-        // Update the actual data structure in a thread-safe manner
-        pthread_mutex_lock(&data_mutex);
-
-        // Clear old data
-        clear_entity_history(&entity_history);
-
-        // Copy new data including sensor_name
-        memcpy(&entity_history, &temp_history, sizeof(entity_history_t));
-
-        pthread_mutex_unlock(&data_mutex);
+        log_debug("Entity history updated: %s.%s, %d data points", request->sensor_name,
+                  request->entity_name, temp_history.count);
 
-        log_debug("Entity history updated: %s.%s, %d data points", request.sensor_name,
-                  request.entity_name, temp_history.count);
+        // Convert to chart-ready values once, the parsed arrays are not kept
+        if(lod)
+        {
+            history_lod_ingest(&temp_history, request->samples);
+        }
+        else
+        {
+            history_series_ingest(&temp_history);
+        }
+        clear_entity_history(&temp_history);
     }
     else
     {
         log_error("Failed to parse entity history data");
         clear_entity_history(&temp_history);
 
-        // Mark data as invalid
-        pthread_mutex_lock(&data_mutex);
-        entity_history.valid = false;
-        pthread_mutex_unlock(&data_mutex);
-
         http_response_free(&response);
         return -1;
     }
@@ -859,15 +1061,22 @@ bool update_camper_entity(const char* entity_name, const char* state_str)
         updated = false;
     }
 
+    if(updated)
+    {
+        data_generation++;
+    }
+
     pthread_mutex_unlock(&data_mutex);
 
     return updated;
 }
 
 // Thread-safe getter functions to access the sensor data
+// Each thread gets its own copy, so a getter never hands out a buffer that another
+// thread is filling, e.g. when LVGL runs with an OS layer and multiple draw threads.
 smart_solar_t* get_smart_solar_data(void)
 {
-    static smart_solar_t safe_copy;
+    static __thread smart_solar_t safe_copy;
 
     pthread_mutex_lock(&data_mutex);
     memcpy(&safe_copy, &smart_solar, sizeof(smart_solar_t));
@@ -878,7 +1087,7 @@ smart_solar_t* get_smart_solar_data(void)
 
 smart_shunt_t* get_smart_shunt_data(void)
 {
-    static smart_shunt_t safe_copy;
+    static __thread smart_shunt_t safe_copy;
 
     pthread_mutex_lock(&data_mutex);
     memcpy(&safe_copy, &smart_shunt, sizeof(smart_shunt_t));
@@ -889,7 +1098,7 @@ smart_shunt_t* get_smart_shunt_data(void)
 
 climate_sensor_t* get_inside_climate_data(void)
 {
-    static climate_sensor_t safe_copy;
+    static __thread climate_sensor_t safe_copy;
 
     pthread_mutex_lock(&data_mutex);
     memcpy(&safe_copy, &inside_climate, sizeof(climate_sensor_t));
@@ -900,7 +1109,7 @@ climate_sensor_t* get_inside_climate_data(void)
 
 climate_sensor_t* get_outside_climate_data(void)
 {
-    static climate_sensor_t safe_copy;
+    static __thread climate_sensor_t safe_copy;
 
     pthread_mutex_lock(&data_mutex);
     memcpy(&safe_copy, &outside_climate, sizeof(climate_sensor_t));
@@ -909,132 +1118,22 @@ climate_sensor_t* get_outside_climate_data(void)
     return &safe_copy;
 }
 
-camper_sensor_t* get_camper_data(void)
+uint32_t get_data_generation(void)
 {
-    static camper_sensor_t safe_copy;
-
     pthread_mutex_lock(&data_mutex);
-    memcpy(&safe_copy, &camper, sizeof(camper_sensor_t));
+    uint32_t generation = data_generation;
     pthread_mutex_unlock(&data_mutex);
 
-    return &safe_copy;
+    return generation;
 }
 
-/**
- * Get the entity history data
- * @return Pointer to a copy of the entity_history_t data structure
- * @note The caller is responsible for freeing the returned structure with
- * free_entity_history_data()
- */
-entity_history_t* get_entity_history_data(void)
+camper_sensor_t* get_camper_data(void)
 {
-    history_request_t request;
+    static __thread camper_sensor_t safe_copy;
 
-    // Get a copy of the current request to verify the data matches
     pthread_mutex_lock(&data_mutex);
-    memcpy(&request, &current_history_request, sizeof(history_request_t));
-
-    // Allocate memory for history copy
-    entity_history_t* history_copy = (entity_history_t*)malloc(sizeof(entity_history_t));
-    if(!history_copy)
-    {
-        log_error("Failed to allocate memory for history data copy");
-        pthread_mutex_unlock(&data_mutex);
-        return NULL;
-    }
-
-    // Zero-initialize the history copy to prevent accessing garbage data
-    memset(history_copy, 0, sizeof(entity_history_t));
-
-    /*
-    // First verify this is the data we're looking for, but only if entity_history is valid
-    if(entity_history.valid && (entity_history.sensor_name[0] != '\0') &&
-       (strcmp(entity_history.sensor_name, request.sensor_name) != 0))
-    {
-        log_warning("Entity history mismatch: requested %s but have %s", request.sensor_name,
-                    entity_history.sensor_name);
-        // Mark as invalid since it's not the requested data
-        history_copy->valid = false;
-        pthread_mutex_unlock(&data_mutex);
-        return history_copy;
-    }
-    */
-
-    // Copy basic fields
-    history_copy->is_numeric = entity_history.is_numeric;
-    strncpy(history_copy->sensor_name, entity_history.sensor_name,
-            sizeof(history_copy->sensor_name) - 1);
-    history_copy->sensor_name[sizeof(history_copy->sensor_name) - 1] =
-        '\0'; // Ensure null termination
-
-    strncpy(history_copy->entity_name, entity_history.entity_name,
-            sizeof(history_copy->entity_name) - 1);
-    history_copy->entity_name[sizeof(history_copy->entity_name) - 1] =
-        '\0'; // Ensure null termination
-
-    strncpy(history_copy->unit, entity_history.unit, sizeof(history_copy->unit) - 1);
-    history_copy->unit[sizeof(history_copy->unit) - 1] = '\0'; // Ensure null termination
-
-    history_copy->count = entity_history.count;
-    history_copy->valid = entity_history.valid;
-
-    // Allocate and copy arrays
-    history_copy->timestamps = NULL;
-    history_copy->min        = NULL;
-    history_copy->max        = NULL;
-    history_copy->mean       = NULL;
-
-    if(entity_history.count > 0)
-    {
-        // Allocate and copy timestamps
-        history_copy->timestamps = (char**)malloc(entity_history.count * sizeof(char*));
-        if(history_copy->timestamps)
-        {
-            memset(history_copy->timestamps, 0, entity_history.count * sizeof(char*));
-            for(int i = 0; i < entity_history.count; i++)
-            {
-                if(entity_history.timestamps[i])
-                {
-                    history_copy->timestamps[i] = strdup(entity_history.timestamps[i]);
-                }
-            }
-        }
-
-        // Allocate and copy data arrays
-        history_copy->min  = (float*)malloc(entity_history.count * sizeof(float));
-        history_copy->max  = (float*)malloc(entity_history.count * sizeof(float));
-        history_copy->mean = (float*)malloc(entity_history.count * sizeof(float));
-
-        if(history_copy->min && entity_history.min)
-        {
-            memcpy(history_copy->min, entity_history.min, entity_history.count * sizeof(float));
-        }
-
-        if(history_copy->max && entity_history.max)
-        {
-            memcpy(history_copy->max, entity_history.max, entity_history.count * sizeof(float));
-        }
-
-        if(history_copy->mean && entity_history.mean)
-        {
-            memcpy(history_copy->mean, entity_history.mean, entity_history.count * sizeof(float));
-        }
-    }
-
+    memcpy(&safe_copy, &camper, sizeof(camper_sensor_t));
     pthread_mutex_unlock(&data_mutex);
 
-    return history_copy;
-}
-
-/**
- * Free memory allocated for an entity_history_t structure
- * @param history Pointer to the entity_history_t structure to free
- */
-void free_entity_history_data(entity_history_t* history)
-{
-    if(!history)
-        return;
-
-    clear_entity_history(history);
-    free(history);
+    return &safe_copy;
 }
@@ -7,6 +7,7 @@
 #define DATA_MANAGER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "sensor_types.h"
 
 #ifdef __cplusplus
@@ -27,9 +28,15 @@ extern "C"
         FETCH_CLIMATE_INSIDE,
         FETCH_CLIMATE_OUTSIDE,
         FETCH_ENTITY_HISTORY,
+        FETCH_HISTORY_LOD, // History for the analytics pyramid
         FETCH_TYPE_COUNT // Keep this last - used to validate request types
     } fetch_request_type_t;
 
+    /**
+     * Callback invoked from the worker thread after it completed a fetch or action
+     */
+    typedef void (*background_notify_cb_t)(void);
+
     /**
      * Initialize the background worker system
      * @return 0 on success, non-zero on failure
@@ -46,6 +53,20 @@ extern "C"
      */
     bool is_background_busy(void);
 
+    /**
+     * Set a callback invoked from the worker thread after it completed work
+     * The callback must be thread-safe, e.g. to wake up the main loop.
+     */
+    void set_background_notify_cb(background_notify_cb_t cb);
+
+    /**
+     * Serve data requests from recorded API responses instead of the server
+     * Requests are then handled synchronously on the calling thread, which makes
+     * benchmark runs reproducible. Camper actions are not affected.
+     * @param dir directory with one JSON file per API path, e.g. sensors_camper_states.json
+     */
+    void data_manager_use_snapshots(const char* dir);
+
     /**
      * Request a new fetch operation
      */
@@ -61,6 +82,12 @@ extern "C"
      */
     camper_sensor_t* get_camper_data(void);
 
+    /**
+     * Get a counter that changes whenever the sensor data may have changed
+     * Cheap enough to compare on every main loop iteration.
+     */
+    uint32_t get_data_generation(void);
+
     bool update_camper_entity(const char* entity_name, const char* status);
 
     /**
@@ -87,19 +114,16 @@ extern "C"
 
     /**
      * Request entity history data
+     * The result is available to the charts through history_series_acquire().
      */
     bool request_entity_history(const char* sensor_name, const char* entity_name,
                                 const char* interval, int samples);
 
     /**
-     * Get a copy of the current entity history data
-     */
-    entity_history_t* get_entity_history_data(void);
-
-    /**
-     * Free the memory allocated for entity history data
+     * Request the newest ANALYTICS_PERIOD samples of an entity for the analytics pyramid
+     * The result is available through history_lod_query().
      */
-    void free_entity_history_data(entity_history_t* history);
+    bool request_history_lod(const char* sensor_name, const char* entity_name, int samples);
 
     /**
      * History request parameters
@@ -0,0 +1,187 @@
+/*******************************************************************
+ *
+ * downsample.c - Reduce series to the points a chart can show
+ *
+ * The history API returns as many samples as requested, which can be
+ * far more than a chart has pixels. These reductions run once on the
+ * fetch thread when a history arrives, each in a single pass over the
+ * input, so requesting finer data costs no work on the UI thread.
+ *
+ ******************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "downsample.h"
+#include "sensor_types.h"
+
+/**
+ * Start of a bucket when count values are split into out_count buckets
+ */
+static inline uint32_t bucket_start(uint32_t bucket, uint32_t count, uint32_t out_count)
+{
+    return (uint32_t)((uint64_t)bucket * count / out_count);
+}
+
+/**
+ * Copy an input that already fits
+ */
+static uint32_t copy_values(const int32_t* values, uint32_t count, int32_t* out)
+{
+    memcpy(out, values, count * sizeof(int32_t));
+    return count;
+}
+
+uint32_t downsample_lttb(const int32_t* values, uint32_t count, uint32_t out_count,
+                         int32_t* out)
+{
+    if(out_count >= count)
+        return copy_values(values, count, out);
+
+    if(out_count < 3)
+    {
+        // No buckets between the first and last point, keep evenly spaced values
+        for(uint32_t i = 0; i < out_count; i++)
+        {
+            out[i] = values[(uint64_t)i * (count - 1) / (out_count > 1 ? out_count - 1 : 1)];
+        }
+        return out_count;
+    }
+
+    // The values between the first and the last one are split into out_count - 2 buckets
+    uint32_t inner   = count - 2;
+    uint32_t buckets = out_count - 2;
+
+    out[0]             = values[0];
+    out[out_count - 1] = values[count - 1];
+
+    uint32_t a_x     = 0; // Previous pick
+    bool     a_valid = values[0] != HISTORY_POINT_NONE;
+
+    for(uint32_t i = 0; i < buckets; i++)
+    {
+        uint32_t start = 1 + bucket_start(i, inner, buckets);
+        uint32_t end   = 1 + bucket_start(i + 1, inner, buckets);
+
+        // Average of the next bucket, the last bucket is followed by the last value
+        uint32_t next_start = end;
+        uint32_t next_end   = (i + 1 < buckets) ? 1 + bucket_start(i + 2, inner, buckets) : count;
+        double   sum_x      = 0.0;
+        double   sum_y      = 0.0;
+        uint32_t valid      = 0;
+        for(uint32_t j = next_start; j < next_end; j++)
+        {
+            if(values[j] != HISTORY_POINT_NONE)
+            {
+                sum_x += j;
+                sum_y += values[j];
+                valid++;
+            }
+        }
+        bool   c_valid = valid > 0;
+        double c_x     = c_valid ? sum_x / valid : 0.0;
+        double c_y     = c_valid ? sum_y / valid : 0.0;
+        double a_y     = a_valid ? values[a_x] : 0.0;
+
+        // Pick the value with the largest triangle, without a neighbour the largest jump
+        double   best_area = -1.0;
+        uint32_t best      = start;
+        for(uint32_t j = start; j < end; j++)
+        {
+            if(values[j] == HISTORY_POINT_NONE)
+                continue;
+
+            double area;
+            if(a_valid && c_valid)
+                area = fabs(((double)a_x - c_x) * (values[j] - a_y) -
+                            ((double)a_x - j) * (c_y - a_y));
+            else if(a_valid)
+                area = fabs(values[j] - a_y);
+            else if(c_valid)
+                area = fabs(values[j] - c_y);
+            else
+                area = 0.0;
+
+            if(area > best_area)
+            {
+                best_area = area;
+                best      = j;
+            }
+        }
+
+        if(best_area < 0.0)
+        {
+            // Gap, the previous pick stays the anchor of the next bucket
+            out[i + 1] = HISTORY_POINT_NONE;
+            continue;
+        }
+
+        out[i + 1] = values[best];
+        a_x        = best;
+        a_valid    = true;
+    }
+
+    return out_count;
+}
+
+uint32_t downsample_minmax(const int32_t* values, uint32_t count, uint32_t out_count,
+                           int32_t* min_out, int32_t* max_out)
+{
+    if(out_count >= count)
+    {
+        copy_values(values, count, min_out);
+        return copy_values(values, count, max_out);
+    }
+
+    for(uint32_t i = 0; i < out_count; i++)
+    {
+        uint32_t end = bucket_start(i + 1, count, out_count);
+        int32_t  min = HISTORY_POINT_NONE;
+        int32_t  max = HISTORY_POINT_NONE;
+        for(uint32_t j = bucket_start(i, count, out_count); j < end; j++)
+        {
+            int32_t value = values[j];
+            if(value == HISTORY_POINT_NONE)
+                continue;
+
+            if(min == HISTORY_POINT_NONE || value < min)
+                min = value;
+            if(max == HISTORY_POINT_NONE || value > max)
+                max = value;
+        }
+        min_out[i] = min;
+        max_out[i] = max;
+    }
+
+    return out_count;
+}
+
+uint32_t downsample_sum(const int32_t* values, uint32_t count, uint32_t out_count, int32_t* out)
+{
+    if(out_count >= count)
+        return copy_values(values, count, out);
+
+    for(uint32_t i = 0; i < out_count; i++)
+    {
+        uint32_t end   = bucket_start(i + 1, count, out_count);
+        int64_t  sum   = 0;
+        bool     valid = false;
+        for(uint32_t j = bucket_start(i, count, out_count); j < end; j++)
+        {
+            if(values[j] != HISTORY_POINT_NONE)
+            {
+                sum += values[j];
+                valid = true;
+            }
+        }
+
+        // Keep the total below HISTORY_POINT_NONE so it is not taken for a gap
+        if(sum >= HISTORY_POINT_NONE)
+            sum = HISTORY_POINT_NONE - 1;
+        else if(sum < INT32_MIN)
+            sum = INT32_MIN;
+        out[i] = valid ? (int32_t)sum : HISTORY_POINT_NONE;
+    }
+
+    return out_count;
+}
@@ -0,0 +1,64 @@
+/*******************************************************************
+ *
+ * downsample.h - Reduce series to the points a chart can show
+ *
+ ******************************************************************/
+#ifndef DOWNSAMPLE_H
+#define DOWNSAMPLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * All functions take evenly spaced values in chronological order and skip
+     * HISTORY_POINT_NONE values. An output point without any value in its part of the
+     * input is HISTORY_POINT_NONE. When the input already fits, it is copied unchanged.
+     */
+
+    /**
+     * Largest-Triangle-Three-Buckets: pick the input points that keep the visual shape
+     * The first and last values are kept, every other output point is the value of its
+     * bucket that forms the largest triangle with the previous pick and the average of
+     * the next bucket, so peaks and dips survive while flat stretches are thinned.
+     * @param values input values
+     * @param count number of input values
+     * @param out_count output points, e.g. the chart width in pixels
+     * @param out output values, out_count entries
+     * @return points written, the smaller of count and out_count
+     */
+    uint32_t downsample_lttb(const int32_t* values, uint32_t count, uint32_t out_count,
+                             int32_t* out);
+
+    /**
+     * Min/max envelope: the lowest and highest value of each bucket
+     * Drawn as two series, or as a bar per point, it shows every peak of the input.
+     * @param values input values
+     * @param count number of input values
+     * @param out_count output points
+     * @param min_out minimum per point, out_count entries
+     * @param max_out maximum per point, out_count entries
+     * @return points written, the smaller of count and out_count
+     */
+    uint32_t downsample_minmax(const int32_t* values, uint32_t count, uint32_t out_count,
+                               int32_t* min_out, int32_t* max_out);
+
+    /**
+     * Bucket totals, for amounts per interval such as the hourly solar yield
+     * @param values input values
+     * @param count number of input values
+     * @param out_count output points
+     * @param out sum per point, out_count entries
+     * @return points written, the smaller of count and out_count
+     */
+    uint32_t downsample_sum(const int32_t* values, uint32_t count, uint32_t out_count,
+                            int32_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DOWNSAMPLE_H */
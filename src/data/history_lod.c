@@ -0,0 +1,396 @@
+/*******************************************************************
+ *
+ * history_lod.c - Min/max level-of-detail pyramid of one history
+ *
+ * The history is kept in ANALYTICS_PERIOD_S buckets, grouped in tiles
+ * of one day in a ring of ANALYTICS_DAYS + 1 tiles. Each tile holds
+ * the minimum and maximum per bucket and HISTORY_LOD_LEVELS - 1
+ * coarser levels that each merge two buckets of the level below, so a
+ * query reads at most one value pair per point whatever the range.
+ * New samples only rewrite the buckets that were not covered yet and
+ * recompute the tiles they fall in.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "history_lod.h"
+#include "../lib/logger.h"
+
+#if HISTORY_LOD_TILE_BUCKETS % (1 << (HISTORY_LOD_LEVELS - 1)) != 0
+#error "A tile must split evenly into the buckets of every level"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define HISTORY_LOD_TILES (ANALYTICS_DAYS + 1)
+
+/* Buckets of all levels of a tile, less than twice the base buckets */
+#define HISTORY_LOD_TILE_VALUES (2 * HISTORY_LOD_TILE_BUCKETS)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    int64_t day;   // Days since the epoch, -1 while unused
+    bool    dirty; // Base buckets changed, coarser levels are outdated
+    int32_t min[HISTORY_LOD_TILE_VALUES];
+    int32_t max[HISTORY_LOD_TILE_VALUES];
+} lod_tile_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lod_tile_t*     tiles     = NULL;
+static pthread_mutex_t lod_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t        level_offset[HISTORY_LOD_LEVELS];
+static char            selected_sensor[32];
+static char            selected_entity[32];
+static uint32_t        generation = 0;
+
+// Buckets received, from the oldest up to the current one, which is still incomplete
+static bool    covered = false;
+static int64_t covered_from;
+static int64_t covered_to;
+
+/**
+ * Parse an ISO timestamp, the server reports local time
+ */
+static bool parse_timestamp(const char* iso_timestamp, int64_t* epoch_s)
+{
+    struct tm tm = {0};
+    if(iso_timestamp == NULL ||
+       sscanf(iso_timestamp, "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+              &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+        return false;
+
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+
+    time_t t = mktime(&tm);
+    if(t == (time_t)-1)
+        return false;
+
+    *epoch_s = (int64_t)t;
+    return true;
+}
+
+/**
+ * Mark every bucket of a tile as empty
+ */
+static void reset_tile(lod_tile_t* tile, int64_t day)
+{
+    tile->day   = day;
+    tile->dirty = false;
+    for(uint32_t i = 0; i < HISTORY_LOD_TILE_VALUES; i++)
+    {
+        tile->min[i] = HISTORY_POINT_NONE;
+        tile->max[i] = HISTORY_POINT_NONE;
+    }
+}
+
+/**
+ * Get the tile of a day, NULL if the ring slot holds another day
+ */
+static lod_tile_t* find_tile(int64_t day)
+{
+    lod_tile_t* tile = &tiles[day % HISTORY_LOD_TILES];
+    return tile->day == day ? tile : NULL;
+}
+
+/**
+ * Write a base bucket, taking over the ring slot of an older day
+ */
+static void write_bucket(int64_t bucket, int32_t min, int32_t max)
+{
+    int64_t     day  = bucket / HISTORY_LOD_TILE_BUCKETS;
+    lod_tile_t* tile = &tiles[day % HISTORY_LOD_TILES];
+    if(tile->day != day)
+    {
+        reset_tile(tile, day);
+    }
+
+    uint32_t idx   = (uint32_t)(bucket % HISTORY_LOD_TILE_BUCKETS);
+    tile->min[idx] = min;
+    tile->max[idx] = max;
+    tile->dirty    = true;
+}
+
+/**
+ * Merge two buckets of a level into one of the next level, gaps are skipped
+ */
+static void merge_buckets(const int32_t* src, int32_t* dst, uint32_t count, bool take_min)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        int32_t a = src[2 * i];
+        int32_t b = src[2 * i + 1];
+        if(a == HISTORY_POINT_NONE)
+            dst[i] = b;
+        else if(b == HISTORY_POINT_NONE)
+            dst[i] = a;
+        else
+            dst[i] = take_min ? (a < b ? a : b) : (a > b ? a : b);
+    }
+}
+
+/**
+ * Recompute the coarser levels of a tile from its base buckets
+ */
+static void build_levels(lod_tile_t* tile)
+{
+    for(uint32_t level = 1; level < HISTORY_LOD_LEVELS; level++)
+    {
+        uint32_t count = HISTORY_LOD_TILE_BUCKETS >> level;
+        uint32_t src   = level_offset[level - 1];
+        uint32_t dst   = level_offset[level];
+        merge_buckets(&tile->min[src], &tile->min[dst], count, true);
+        merge_buckets(&tile->max[src], &tile->max[dst], count, false);
+    }
+    tile->dirty = false;
+}
+
+bool history_lod_select(const char* sensor_name, const char* entity_name)
+{
+    pthread_mutex_lock(&lod_mutex);
+
+    if(tiles == NULL)
+    {
+        tiles = malloc(HISTORY_LOD_TILES * sizeof(lod_tile_t));
+        if(tiles == NULL)
+        {
+            pthread_mutex_unlock(&lod_mutex);
+            log_error("Failed to allocate history pyramid");
+            return false;
+        }
+
+        uint32_t offset = 0;
+        for(uint32_t level = 0; level < HISTORY_LOD_LEVELS; level++)
+        {
+            level_offset[level] = offset;
+            offset += HISTORY_LOD_TILE_BUCKETS >> level;
+        }
+    }
+
+    for(uint32_t i = 0; i < HISTORY_LOD_TILES; i++)
+    {
+        tiles[i].day = -1;
+    }
+
+    snprintf(selected_sensor, sizeof(selected_sensor), "%s", sensor_name);
+    snprintf(selected_entity, sizeof(selected_entity), "%s", entity_name);
+    covered = false;
+    generation++;
+
+    pthread_mutex_unlock(&lod_mutex);
+    return true;
+}
+
+void history_lod_release(void)
+{
+    pthread_mutex_lock(&lod_mutex);
+    free(tiles);
+    tiles              = NULL;
+    selected_sensor[0] = '\0';
+    selected_entity[0] = '\0';
+    covered            = false;
+    pthread_mutex_unlock(&lod_mutex);
+}
+
+bool history_lod_ingest(const entity_history_t* history, int samples)
+{
+    if(!history->is_numeric || history->min == NULL || history->max == NULL ||
+       history->timestamps == NULL || history->count <= 0 || samples <= 0)
+        return false;
+
+    // Parse outside the lock, the UI thread queries while the history is converted
+    int64_t* times = malloc(history->count * sizeof(int64_t));
+    if(times == NULL)
+        return false;
+
+    for(int i = 0; i < history->count; i++)
+    {
+        if(!parse_timestamp(history->timestamps[i], &times[i]))
+        {
+            times[i] = -1;
+        }
+    }
+
+    int64_t now_bucket  = (int64_t)time(NULL) / ANALYTICS_PERIOD_S;
+    int64_t now_day     = now_bucket / HISTORY_LOD_TILE_BUCKETS;
+    int64_t from_bucket = now_bucket - samples + 1;
+    int     written     = 0;
+    bool    added       = false;
+
+    pthread_mutex_lock(&lod_mutex);
+
+    if(tiles != NULL && strcmp(history->sensor_name, selected_sensor) == 0 &&
+       strcmp(history->entity_name, selected_entity) == 0)
+    {
+        for(int i = 0; i < history->count; i++)
+        {
+            if(times[i] < 0)
+                continue;
+
+            // A sample of a coarser period fills all buckets up to the next sample
+            int64_t first = times[i] / ANALYTICS_PERIOD_S;
+            int64_t end   = first + 1;
+            if(i + 1 < history->count && times[i + 1] > times[i])
+            {
+                end = times[i + 1] / ANALYTICS_PERIOD_S;
+                if(end - first > HISTORY_LOD_TILE_BUCKETS)
+                    end = first + 1;
+            }
+
+            int32_t min = (int32_t)(history->min[i] * HISTORY_LOD_SCALE);
+            int32_t max = (int32_t)(history->max[i] * HISTORY_LOD_SCALE);
+            for(int64_t bucket = first; bucket < end; bucket++)
+            {
+                // Completed buckets that were received before stay as they are, days
+                // beyond the ring would replace newer tiles
+                if(covered && bucket >= covered_from && bucket < covered_to)
+                    continue;
+                if(bucket / HISTORY_LOD_TILE_BUCKETS <= now_day - HISTORY_LOD_TILES)
+                    continue;
+
+                write_bucket(bucket, min, max);
+                written++;
+            }
+        }
+
+        // Only the tiles that received buckets are recomputed
+        for(uint32_t i = 0; i < HISTORY_LOD_TILES; i++)
+        {
+            if(tiles[i].day >= 0 && tiles[i].dirty)
+            {
+                build_levels(&tiles[i]);
+            }
+        }
+
+        if(covered && from_bucket <= covered_to && now_bucket >= covered_from)
+        {
+            covered_from = from_bucket < covered_from ? from_bucket : covered_from;
+            covered_to   = now_bucket > covered_to ? now_bucket : covered_to;
+        }
+        else
+        {
+            covered_from = from_bucket;
+            covered_to   = now_bucket;
+            covered      = true;
+        }
+
+        generation++;
+        added = true;
+    }
+
+    pthread_mutex_unlock(&lod_mutex);
+    free(times);
+
+    if(added)
+    {
+        log_debug("History pyramid %s.%s: %d buckets written", history->sensor_name,
+                  history->entity_name, written);
+    }
+    return added;
+}
+
+uint32_t history_lod_generation(void)
+{
+    pthread_mutex_lock(&lod_mutex);
+    uint32_t value = generation;
+    pthread_mutex_unlock(&lod_mutex);
+    return value;
+}
+
+void history_lod_query(int64_t start_s, int64_t end_s, uint32_t max_points, int32_t* min_out,
+                       int32_t* max_out, history_lod_view_t* view)
+{
+    memset(view, 0, sizeof(*view));
+    if(end_s <= start_s || max_points == 0)
+        return;
+
+    // Coarsest level needed to fit the range into max_points
+    int64_t  first_bucket = start_s / ANALYTICS_PERIOD_S;
+    int64_t  end_bucket   = (end_s + ANALYTICS_PERIOD_S - 1) / ANALYTICS_PERIOD_S;
+    uint32_t level        = 0;
+    while(level < HISTORY_LOD_LEVELS - 1 &&
+          ((end_bucket - first_bucket + (1 << level) - 1) >> level) > max_points)
+    {
+        level++;
+    }
+
+    int64_t first = first_bucket >> level;
+    int64_t end   = (end_bucket + (1 << level) - 1) >> level;
+    int64_t count = end - first;
+    if(count > max_points)
+    {
+        // Aligning can add a point at each edge, drop the oldest so the newest stays shown
+        first += count - max_points;
+        count  = max_points;
+    }
+
+    view->level   = level;
+    view->start_s = (first << level) * ANALYTICS_PERIOD_S;
+    view->count   = (uint32_t)count;
+
+    pthread_mutex_lock(&lod_mutex);
+    for(int64_t i = 0; i < count; i++)
+    {
+        int64_t     bucket = (first + i) << level;
+        lod_tile_t* tile   = tiles ? find_tile(bucket / HISTORY_LOD_TILE_BUCKETS) : NULL;
+        if(tile == NULL)
+        {
+            min_out[i] = HISTORY_POINT_NONE;
+            max_out[i] = HISTORY_POINT_NONE;
+            continue;
+        }
+
+        uint32_t offset = (uint32_t)(bucket % HISTORY_LOD_TILE_BUCKETS);
+        uint32_t idx    = level_offset[level] + (offset >> level);
+        min_out[i]      = tile->min[idx];
+        max_out[i]      = tile->max[idx];
+        if(min_out[i] == HISTORY_POINT_NONE)
+            continue;
+
+        if(!view->has_data || min_out[i] < view->min)
+            view->min = min_out[i];
+        if(!view->has_data || max_out[i] > view->max)
+            view->max = max_out[i];
+        view->has_data = true;
+    }
+    pthread_mutex_unlock(&lod_mutex);
+}
+
+int history_lod_missing_samples(int64_t start_s, int64_t now_s)
+{
+    int64_t now_bucket    = now_s / ANALYTICS_PERIOD_S;
+    int64_t oldest_bucket = now_bucket - (int64_t)ANALYTICS_DAYS * HISTORY_LOD_TILE_BUCKETS;
+    int64_t start_bucket  = start_s / ANALYTICS_PERIOD_S;
+    if(start_bucket < oldest_bucket)
+        start_bucket = oldest_bucket;
+
+    int samples = 0;
+
+    pthread_mutex_lock(&lod_mutex);
+    if(tiles != NULL)
+    {
+        if(!covered || start_bucket < covered_from)
+        {
+            // Older buckets can only be requested together with everything up to now
+            samples = (int)(now_bucket - start_bucket + 1);
+        }
+        else if(now_bucket > covered_to)
+        {
+            samples = (int)(now_bucket - covered_to + 1);
+        }
+    }
+    pthread_mutex_unlock(&lod_mutex);
+
+    return samples;
+}
@@ -0,0 +1,98 @@
+/*******************************************************************
+ *
+ * history_lod.h - Min/max level-of-detail pyramid of one history
+ *
+ ******************************************************************/
+#ifndef HISTORY_LOD_H
+#define HISTORY_LOD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_types.h"
+#include "../main.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Base buckets per tile, one day of ANALYTICS_PERIOD_S buckets */
+#define HISTORY_LOD_TILE_BUCKETS (86400 / ANALYTICS_PERIOD_S)
+
+/* Pyramid levels, each level halves the buckets of the previous one */
+#define HISTORY_LOD_LEVELS 6
+
+/* Values are fixed point with two decimals */
+#define HISTORY_LOD_SCALE 100
+
+    /**
+     * Result of a pyramid query
+     */
+    typedef struct
+    {
+        uint32_t count;    // Points written
+        uint32_t level;    // Pyramid level, a point covers ANALYTICS_PERIOD_S << level
+        int64_t  start_s;  // Start time of the first point
+        int32_t  min;      // Range of the points, set if has_data
+        int32_t  max;
+        bool     has_data; // At least one point has a value
+    } history_lod_view_t;
+
+    /**
+     * Select the history kept in the pyramid (UI thread)
+     * Allocates the pyramid on first use and drops the data of a previous selection.
+     * @param sensor_name sensor, e.g. "inside"
+     * @param entity_name entity, e.g. "temperature"
+     * @return false if the pyramid cannot be allocated
+     */
+    bool history_lod_select(const char* sensor_name, const char* entity_name);
+
+    /**
+     * Free the pyramid and clear the selection (UI thread)
+     */
+    void history_lod_release(void);
+
+    /**
+     * Add a received history to the pyramid (fetch thread)
+     * Only buckets outside the time already covered are written, and only the tiles
+     * they fall in are recomputed. Histories of another selection are ignored.
+     * @param history parsed history with min/max values in chronological order
+     * @param samples samples requested, the history covers that many buckets up to now
+     * @return true if the history was added
+     */
+    bool history_lod_ingest(const entity_history_t* history, int samples);
+
+    /**
+     * Get a counter that changes whenever new data was added
+     */
+    uint32_t history_lod_generation(void);
+
+    /**
+     * Get the min/max points of a time range at the coarsest level that still has at
+     * most max_points points
+     * @param start_s start of the range, seconds since the epoch
+     * @param end_s end of the range
+     * @param max_points capacity of min_out and max_out, e.g. the chart width in pixels
+     * @param min_out minimum per point, HISTORY_POINT_NONE without data
+     * @param max_out maximum per point, HISTORY_POINT_NONE without data
+     * @param view output for the point count, level and value range
+     */
+    void history_lod_query(int64_t start_s, int64_t end_s, uint32_t max_points, int32_t* min_out,
+                           int32_t* max_out, history_lod_view_t* view);
+
+    /**
+     * Get the number of samples to request to cover a range up to now
+     * The history API counts samples back from now, so an uncovered start needs every
+     * sample since then, while a covered start only needs the samples since the newest
+     * one received.
+     * @param start_s start of the range shown
+     * @param now_s current time
+     * @return samples to request, 0 if the range is covered
+     */
+    int history_lod_missing_samples(int64_t start_s, int64_t now_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORY_LOD_H */
@@ -0,0 +1,362 @@
+/*******************************************************************
+ *
+ * history_series.c - Chart view models of the received histories
+ *
+ * Each channel has a front buffer the charts draw from and a back
+ * buffer the fetch thread converts new history into: the points, the
+ * Y axis range, the marker texts and the time labels. Acquiring swaps
+ * the two once the back buffer is complete, so the UI thread does no
+ * chart math and the fetch thread never writes a buffer that is on
+ * screen.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "history_series.h"
+#include "downsample.h"
+#include "../lib/logger.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum
+{
+    HISTORY_SOURCE_MEAN,         // Mean per interval
+    HISTORY_SOURCE_MAX_INCREASE, // Increase of a cumulative counter, from the max per interval
+} history_source_t;
+
+typedef struct
+{
+    const char*      sensor_name;
+    history_source_t source;
+    bool             floor_enabled;   // Replace small values so they stay visible or vanish
+    float            floor_threshold; // Values at or below this are small
+    int32_t          floor_value;     // Fixed point value drawn for small values
+    const char*      label_fmt;       // printf format of the marker texts
+    bool             zero_based;      // Y axis from 0 to the maximum plus 10%
+    int32_t          min_top;         // zero_based: smallest axis maximum (fixed point)
+    int32_t          min_padding;     // !zero_based: smallest padding around the data
+} history_channel_config_t;
+
+typedef struct
+{
+    history_series_t buffers[2];
+    uint8_t          front;      // Buffer the charts draw from
+    bool             back_ready; // Back buffer holds a complete series not yet acquired
+} history_channel_state_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const history_channel_config_t channel_configs[HISTORY_CHANNEL_COUNT] = {
+    // Range fits the data with at least 2 degrees padding
+    [HISTORY_INSIDE_TEMPERATURE] =
+        {
+            .sensor_name = "inside",
+            .source      = HISTORY_SOURCE_MEAN,
+            .label_fmt   = "%.1f°C",
+            .min_padding = 2 * HISTORY_SERIES_SCALE,
+        },
+    [HISTORY_OUTSIDE_TEMPERATURE] =
+        {
+            .sensor_name = "outside",
+            .source      = HISTORY_SOURCE_MEAN,
+            .label_fmt   = "%.1f°C",
+            .min_padding = 2 * HISTORY_SERIES_SCALE,
+        },
+    // Hours without yield draw no bar, the axis runs from 0 to at least 100 Wh
+    [HISTORY_SOLAR_YIELD] =
+        {
+            .sensor_name     = "SmartSolar",
+            .source          = HISTORY_SOURCE_MAX_INCREASE,
+            .floor_enabled   = true,
+            .floor_threshold = 0.1f,
+            .floor_value     = HISTORY_POINT_NONE,
+            .label_fmt       = "%.1f Wh",
+            .zero_based      = true,
+            .min_top         = 100 * HISTORY_SERIES_SCALE,
+        },
+    // Hours without consumption (charging) get a small bar so they stay visible, the axis
+    // runs from 0 to at least 10 Ah
+    [HISTORY_BATTERY_CONSUMED] =
+        {
+            .sensor_name     = "SmartShunt",
+            .source          = HISTORY_SOURCE_MAX_INCREASE,
+            .floor_enabled   = true,
+            .floor_threshold = 0.1f,
+            .floor_value     = 1 * HISTORY_SERIES_SCALE,
+            .label_fmt       = "%.1f Ah",
+            .zero_based      = true,
+            .min_top         = 10 * HISTORY_SERIES_SCALE,
+        },
+};
+
+static history_channel_state_t channels[HISTORY_CHANNEL_COUNT];
+static pthread_mutex_t         series_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Get the value shown for a sample, the samples are in chronological order
+ * @return false if the history has no value there
+ */
+static bool get_source_value(const entity_history_t* history, history_source_t source, int idx,
+                             float* value)
+{
+    if(source == HISTORY_SOURCE_MEAN)
+    {
+        if(history->mean == NULL || idx < 0 || idx >= history->count)
+            return false;
+
+        *value = history->mean[idx];
+        return true;
+    }
+
+    // A sample lower than the previous one is a counter reset and counts from zero
+    if(history->max == NULL || idx < 1 || idx >= history->count)
+        return false;
+
+    float prev = history->max[idx - 1];
+    float next = history->max[idx];
+    *value     = (prev > next) ? next : next - prev;
+    return true;
+}
+
+/**
+ * Format an ISO timestamp (YYYY-MM-DDThh:mm:ss) as "DD-MM HH:MM"
+ */
+static void format_time_label(const char* iso_timestamp, char* output, size_t output_size)
+{
+    output[0] = '\0';
+    if(iso_timestamp == NULL)
+        return;
+
+    if(strlen(iso_timestamp) >= 16 && iso_timestamp[4] == '-' && iso_timestamp[7] == '-' &&
+       iso_timestamp[10] == 'T')
+    {
+        snprintf(output, output_size, "%.2s-%.2s %.2s:%.2s", &iso_timestamp[8], &iso_timestamp[5],
+                 &iso_timestamp[11], &iso_timestamp[14]);
+    }
+    else
+    {
+        // Fallback if the timestamp isn't in the expected format
+        snprintf(output, output_size, "%s", iso_timestamp);
+    }
+}
+
+/**
+ * Set the Y axis range and the marker texts from the value range
+ */
+static void prepare_axis(const history_channel_config_t* cfg, history_series_t* series)
+{
+    if(cfg->zero_based)
+    {
+        // Maximum plus 10%, rounded up to a whole unit: ceil(max / 10 * 1.1)
+        int32_t top   = series->max > 0 ? (series->max * 11 + 99) / 100 : 0;
+        series->y_min = 0;
+        series->y_max = top * HISTORY_SERIES_SCALE;
+        if(series->y_max < cfg->min_top)
+            series->y_max = cfg->min_top;
+
+        // The axis starts at 0, so a negative maximum is shown as 0
+        if(series->max < 0)
+            series->max = 0;
+    }
+    else
+    {
+        // 10% padding so the data does not touch the edges
+        int32_t padding = (series->max - series->min) / 10;
+        if(padding < cfg->min_padding)
+            padding = cfg->min_padding;
+        series->y_min = series->min - padding;
+        series->y_max = series->max + padding;
+    }
+
+    snprintf(series->min_label, sizeof(series->min_label), cfg->label_fmt,
+             (float)series->min / HISTORY_SERIES_SCALE);
+    snprintf(series->max_label, sizeof(series->max_label), cfg->label_fmt,
+             (float)series->max / HISTORY_SERIES_SCALE);
+}
+
+/**
+ * Reduce a history with more samples than the chart has points
+ * Means keep their shape through LTTB, increases are added up per point so the bars still
+ * show the totals. The markers get the extremes of all samples.
+ * @return false if the samples cannot be buffered
+ */
+static bool reduce_history(const entity_history_t* history, const history_channel_config_t* cfg,
+                           int first, history_series_t* series)
+{
+    uint32_t count = history->count - first;
+    int32_t* raw   = malloc(count * sizeof(int32_t));
+    if(raw == NULL)
+    {
+        log_error("Memory allocation failed for %u history samples", (unsigned)count);
+        return false;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        float value;
+        raw[i] = get_source_value(history, cfg->source, first + i, &value)
+                     ? (int32_t)(value * HISTORY_SERIES_SCALE)
+                     : HISTORY_POINT_NONE;
+    }
+
+    if(cfg->source == HISTORY_SOURCE_MEAN)
+    {
+        downsample_lttb(raw, count, HISTORY_SERIES_POINTS, series->values);
+        downsample_minmax(raw, count, 1, &series->min, &series->max);
+    }
+    else
+    {
+        downsample_sum(raw, count, HISTORY_SERIES_POINTS, series->values);
+        downsample_minmax(series->values, HISTORY_SERIES_POINTS, 1, &series->min, &series->max);
+    }
+
+    free(raw);
+    series->has_data = series->max != HISTORY_POINT_NONE;
+    return true;
+}
+
+/**
+ * Take the newest samples that fit the chart, the newest one is drawn at the right edge
+ */
+static void align_history(const entity_history_t* history, const history_channel_config_t* cfg,
+                          history_series_t* series)
+{
+    series->has_data = false;
+    for(int i = 0; i < HISTORY_SERIES_POINTS; i++)
+    {
+        int   idx = history->count - HISTORY_SERIES_POINTS + i;
+        float value;
+        if(!get_source_value(history, cfg->source, idx, &value))
+        {
+            series->values[i] = HISTORY_POINT_NONE;
+            continue;
+        }
+
+        int32_t fixed     = (int32_t)(value * HISTORY_SERIES_SCALE);
+        series->values[i] = fixed;
+
+        if(!series->has_data || fixed < series->min)
+            series->min = fixed;
+        if(!series->has_data || fixed > series->max)
+            series->max = fixed;
+        series->has_data = true;
+    }
+}
+
+/**
+ * Convert a history into chart order, tracking the range
+ */
+static void convert_history(const entity_history_t* history, const history_channel_config_t* cfg,
+                            history_series_t* series)
+{
+    // An increase needs the sample before it
+    int first   = (cfg->source == HISTORY_SOURCE_MAX_INCREASE) ? 1 : 0;
+    int samples = 0; // Samples covered by the points, including the one before an increase
+
+    if(history->count - first > HISTORY_SERIES_POINTS &&
+       reduce_history(history, cfg, first, series))
+    {
+        samples = history->count;
+    }
+    else
+    {
+        align_history(history, cfg, series);
+        samples = history->count < HISTORY_SERIES_POINTS + first ? history->count
+                                                                  : HISTORY_SERIES_POINTS + first;
+    }
+
+    // Small values are replaced after the markers are taken, so they show the real range
+    int shown = 0;
+    for(int i = 0; i < HISTORY_SERIES_POINTS; i++)
+    {
+        int32_t fixed = series->values[i];
+        if(fixed == HISTORY_POINT_NONE)
+            continue;
+
+        if(cfg->floor_enabled && fixed <= (int32_t)(cfg->floor_threshold * HISTORY_SERIES_SCALE))
+            series->values[i] = cfg->floor_value;
+        shown++;
+    }
+
+    series->valid = shown > 0;
+
+    if(series->has_data)
+    {
+        prepare_axis(cfg, series);
+    }
+
+    series->left_time_label[0]  = '\0';
+    series->right_time_label[0] = '\0';
+    if(series->valid && history->timestamps != NULL && samples <= history->count)
+    {
+        format_time_label(history->timestamps[history->count - samples],
+                          series->left_time_label, sizeof(series->left_time_label));
+        format_time_label(history->timestamps[history->count - 1], series->right_time_label,
+                          sizeof(series->right_time_label));
+    }
+}
+
+bool history_series_ingest(const entity_history_t* history)
+{
+    int channel = -1;
+    for(int i = 0; i < HISTORY_CHANNEL_COUNT; i++)
+    {
+        if(strcmp(history->sensor_name, channel_configs[i].sensor_name) == 0)
+        {
+            channel = i;
+            break;
+        }
+    }
+
+    if(channel < 0)
+    {
+        log_warning("Unknown sensor name in history data: %s", history->sensor_name);
+        return false;
+    }
+
+    history_channel_state_t* state = &channels[channel];
+
+    // Only the UI thread moves the front buffer, and not while the back buffer is not ready
+    pthread_mutex_lock(&series_mutex);
+    state->back_ready      = false;
+    history_series_t* back = &state->buffers[state->front ^ 1];
+    pthread_mutex_unlock(&series_mutex);
+
+    convert_history(history, &channel_configs[channel], back);
+
+    pthread_mutex_lock(&series_mutex);
+    state->back_ready = true;
+    pthread_mutex_unlock(&series_mutex);
+
+    if(history->count > HISTORY_SERIES_POINTS + 1)
+    {
+        log_debug("History %s reduced from %d samples to %d points", history->sensor_name,
+                  history->count, HISTORY_SERIES_POINTS);
+    }
+    return true;
+}
+
+const history_series_t* history_series_acquire(history_channel_t channel)
+{
+    if(channel >= HISTORY_CHANNEL_COUNT)
+        return NULL;
+
+    history_channel_state_t* state  = &channels[channel];
+    const history_series_t*  series = NULL;
+
+    pthread_mutex_lock(&series_mutex);
+    if(state->back_ready)
+    {
+        state->front ^= 1;
+        state->back_ready = false;
+        series            = &state->buffers[state->front];
+    }
+    pthread_mutex_unlock(&series_mutex);
+
+    return series;
+}
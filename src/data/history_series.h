@@ -0,0 +1,38 @@
+/*******************************************************************
+ *
+ * history_series.h - Chart-ready history series
+ *
+ ******************************************************************/
+#ifndef HISTORY_SERIES_H
+#define HISTORY_SERIES_H
+
+#include <stdbool.h>
+#include "sensor_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Convert a received entity history into the series of its channel
+     * Called on the fetch thread, writes the back buffer of the channel.
+     * @param history parsed history, sensor_name selects the channel
+     * @return true if the history belongs to a known channel
+     */
+    bool history_series_ingest(const entity_history_t* history);
+
+    /**
+     * Take the latest series of a channel (UI thread)
+     * The returned buffer stays unchanged until the next call for the same channel that
+     * returns non-NULL, so charts can draw straight from it.
+     * @param channel history channel
+     * @return new series since the last call, NULL if there is none
+     */
+    const history_series_t* history_series_acquire(history_channel_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORY_SERIES_H */
@@ -0,0 +1,106 @@
+/*******************************************************************
+ *
+ * sensor_trace.c - Stamps of a sensor reading on its way to the screen
+ *
+ * A fetch request carries a trace that the worker stamps as it
+ * dequeues, requests, receives and parses the reading. Publishing
+ * leaves the trace in a slot per sensor, where the UI takes it when
+ * it applies the data, so the trace follows the reading across the
+ * thread switch without extra queues.
+ *
+ ******************************************************************/
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "sensor_trace.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+// Latest published trace per sensor, protected by trace_mutex
+static sensor_trace_t  published[SENSOR_COUNT];
+static bool            has_published[SENSOR_COUNT];
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Get the CLOCK_MONOTONIC time the stamps use
+ */
+uint64_t sensor_trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Start a trace, clears it and stamps TRACE_ENQUEUED
+ */
+void sensor_trace_start(sensor_trace_t* trace)
+{
+    memset(trace, 0, sizeof(*trace));
+    trace->stamp_ns[TRACE_ENQUEUED] = sensor_trace_now_ns();
+}
+
+/**
+ * Stamp a stage with the current time
+ */
+void sensor_trace_stamp(sensor_trace_t* trace, trace_stage_t stage)
+{
+    if(trace)
+    {
+        trace->stamp_ns[stage] = sensor_trace_now_ns();
+    }
+}
+
+/**
+ * Stamp TRACE_PUBLISHED and hand the trace to the UI
+ */
+void sensor_trace_publish(sensor_id_t sensor, sensor_trace_t* trace)
+{
+    sensor_trace_stamp(trace, TRACE_PUBLISHED);
+
+    pthread_mutex_lock(&trace_mutex);
+    published[sensor]     = *trace;
+    has_published[sensor] = true;
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+/**
+ * Take the trace of the latest published reading
+ */
+bool sensor_trace_take(sensor_id_t sensor, sensor_trace_t* trace)
+{
+    pthread_mutex_lock(&trace_mutex);
+    bool taken = has_published[sensor];
+    if(taken)
+    {
+        *trace                = published[sensor];
+        has_published[sensor] = false;
+    }
+    pthread_mutex_unlock(&trace_mutex);
+
+    return taken;
+}
+
+/**
+ * Get the time between two stamps
+ */
+float sensor_trace_interval_ms(const sensor_trace_t* trace, trace_stage_t from, trace_stage_t to)
+{
+    if(trace->stamp_ns[from] == 0 || trace->stamp_ns[to] < trace->stamp_ns[from])
+        return 0.0f;
+
+    return (trace->stamp_ns[to] - trace->stamp_ns[from]) / 1000000.0f;
+}
+
+/**
+ * Get the age of a reading
+ */
+uint32_t sensor_trace_age_ms(uint64_t received_ns)
+{
+    if(received_ns == 0)
+        return 0;
+
+    return (uint32_t)((sensor_trace_now_ns() - received_ns) / 1000000ULL);
+}
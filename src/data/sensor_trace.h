@@ -0,0 +1,95 @@
+/*******************************************************************
+ *
+ * sensor_trace.h - Stamps of a sensor reading on its way to the screen
+ *
+ ******************************************************************/
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Pipeline stages, in the order a reading passes them
+     */
+    typedef enum
+    {
+        TRACE_ENQUEUED = 0, // Fetch request queued
+        TRACE_DEQUEUED,     // Picked up by the worker
+        TRACE_HTTP_START,   // Request sent
+        TRACE_FIRST_BYTE,   // First byte of the response received
+        TRACE_PARSED,       // Response parsed
+        TRACE_PUBLISHED,    // Copied into the data the getters return
+        TRACE_APPLIED,      // Copied into the UI subjects
+        TRACE_DISPLAYED,    // Flushed to the display
+        TRACE_STAGE_COUNT
+    } trace_stage_t;
+
+    /**
+     * CLOCK_MONOTONIC time per stage, 0 for stages not reached
+     */
+    typedef struct
+    {
+        uint64_t stamp_ns[TRACE_STAGE_COUNT];
+    } sensor_trace_t;
+
+    /**
+     * Get the CLOCK_MONOTONIC time the stamps use
+     * @return time in nanoseconds
+     */
+    uint64_t sensor_trace_now_ns(void);
+
+    /**
+     * Start a trace, clears it and stamps TRACE_ENQUEUED
+     * @param trace trace to start
+     */
+    void sensor_trace_start(sensor_trace_t* trace);
+
+    /**
+     * Stamp a stage with the current time
+     * @param trace trace to stamp, NULL for untraced requests such as histories
+     */
+    void sensor_trace_stamp(sensor_trace_t* trace, trace_stage_t stage);
+
+    /**
+     * Stamp TRACE_PUBLISHED and hand the trace to the UI (worker thread)
+     * Call after the reading is visible through the getters. A trace the UI did not take
+     * yet is replaced, the UI only shows the latest reading either way.
+     * @param sensor sensor the reading belongs to
+     * @param trace trace of the reading
+     */
+    void sensor_trace_publish(sensor_id_t sensor, sensor_trace_t* trace);
+
+    /**
+     * Take the trace of the latest published reading (UI thread)
+     * @param sensor sensor to take the trace of
+     * @param trace receives the trace
+     * @return true if a reading was published since the last call
+     */
+    bool sensor_trace_take(sensor_id_t sensor, sensor_trace_t* trace);
+
+    /**
+     * Get the time between two stamps
+     * @return milliseconds, 0 if either stage was not reached
+     */
+    float sensor_trace_interval_ms(const sensor_trace_t* trace, trace_stage_t from,
+                                   trace_stage_t to);
+
+    /**
+     * Get the age of a reading
+     * @param received_ns received_ns of the sensor data
+     * @return milliseconds since the reading was received, 0 if it never was
+     */
+    uint32_t sensor_trace_age_ms(uint64_t received_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_TRACE_H */
@@ -6,6 +6,9 @@
 #ifndef SENSOR_TYPES_H
 #define SENSOR_TYPES_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -13,44 +16,61 @@ extern "C"
 
     typedef struct
     {
-        float battery_voltage;
-        float battery_charging_current;
-        float solar_power;
-        float yield_today;
-        char  charge_state[32];
-        bool  valid;
+        float    battery_voltage;
+        float    battery_charging_current;
+        float    solar_power;
+        float    yield_today;
+        char     charge_state[32];
+        uint64_t received_ns; // CLOCK_MONOTONIC time of the response, 0 if never received
+        bool     valid;
     } smart_solar_t;
 
     typedef struct
     {
-        float voltage;
-        float current;
-        int   remaining_mins;
-        float soc;
-        float consumed_ah;
-        bool  valid;
+        float    voltage;
+        float    current;
+        int      remaining_mins;
+        float    soc;
+        float    consumed_ah;
+        uint64_t received_ns; // CLOCK_MONOTONIC time of the response, 0 if never received
+        bool     valid;
     } smart_shunt_t;
 
     typedef struct
     {
-        float temperature;
-        float humidity;
-        float battery;
-        bool  valid;
+        float    temperature;
+        float    humidity;
+        float    battery;
+        uint64_t received_ns; // CLOCK_MONOTONIC time of the response, 0 if never received
+        bool     valid;
     } climate_sensor_t;
 
     typedef struct
     {
-        float household_voltage;
-        float starter_voltage;
-        float mains_voltage;
-        bool  household_state;
-        bool  pump_state;
-        int   water_state; // Percentage 0-100
-        int   waste_state; // Percentage 0-100
-        bool  valid;
+        float    household_voltage;
+        float    starter_voltage;
+        float    mains_voltage;
+        bool     household_state;
+        bool     pump_state;
+        int      water_state; // Percentage 0-100
+        int      waste_state; // Percentage 0-100
+        uint64_t received_ns; // CLOCK_MONOTONIC time of the response, 0 if never received
+        bool     valid;
     } camper_sensor_t;
 
+    /**
+     * Sensors whose readings are traced from request to display
+     */
+    typedef enum
+    {
+        SENSOR_CAMPER = 0,
+        SENSOR_CLIMATE_INSIDE,
+        SENSOR_CLIMATE_OUTSIDE,
+        SENSOR_SMART_SOLAR,
+        SENSOR_SMART_SHUNT,
+        SENSOR_COUNT
+    } sensor_id_t;
+
     /**
      * Structure for entity history data
      */
@@ -68,6 +88,46 @@ extern "C"
         bool   valid;
     } entity_history_t;
 
+/* Points per history series, one per hour over two days */
+#define HISTORY_SERIES_POINTS 48
+
+/* History values are fixed point with one decimal */
+#define HISTORY_SERIES_SCALE 10
+
+/* No value at this point, equal to LV_CHART_POINT_NONE */
+#define HISTORY_POINT_NONE INT32_MAX
+
+    /**
+     * History series shown by the charts
+     */
+    typedef enum
+    {
+        HISTORY_INSIDE_TEMPERATURE = 0,
+        HISTORY_OUTSIDE_TEMPERATURE,
+        HISTORY_SOLAR_YIELD,      // Hourly yield in Wh
+        HISTORY_BATTERY_CONSUMED, // Hourly consumption in Ah
+        HISTORY_CHANNEL_COUNT
+    } history_channel_t;
+
+    /**
+     * Chart view model of a history, prepared once on the fetch thread when the history
+     * is received, so the UI thread only binds it
+     */
+    typedef struct
+    {
+        int32_t values[HISTORY_SERIES_POINTS]; // Left to right, HISTORY_POINT_NONE for gaps
+        int32_t min;                           // Marker values, real values before small
+        int32_t max;                           // values are raised to stay visible
+        int32_t y_min;                         // Y axis range that fits this series
+        int32_t y_max;
+        bool    has_data;                      // min, max and the range are set
+        bool    valid;                         // History was received and usable
+        char    min_label[16];                 // Marker texts, e.g. "21.5°C"
+        char    max_label[16];
+        char    left_time_label[16];           // "DD-MM HH:MM" of the leftmost point
+        char    right_time_label[16];          // "DD-MM HH:MM" of the rightmost point
+    } history_series_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,317 @@
+/*******************************************************************
+ *
+ * blend_neon.c - NEON fill and blend kernels for the software renderer
+ *
+ * Every kernel runs its NEON loop over blocks of 8 pixels and finishes
+ * each row with the scalar loop, which is also the whole implementation
+ * on targets without NEON. Both paths produce identical pixels, the
+ * blend benchmark checks that.
+ *
+ ******************************************************************/
+#include "blend_neon.h"
+
+#if BLEND_NEON
+#include <arm_neon.h>
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static bool force_scalar = false;
+
+/**
+ * Run the scalar versions of the kernels
+ */
+void blend_neon_force_scalar(bool scalar)
+{
+    force_scalar = scalar;
+}
+
+/**
+ * Mix an RGB565 foreground into a background, mix5 in 0..32
+ * Close to LVGL's lv_color_16_16_mix(), within 1 LSB per channel.
+ */
+static inline uint16_t mix_rgb565(uint16_t fg, uint16_t bg, int32_t mix5)
+{
+    int32_t r = (bg >> 11) + ((((fg >> 11) - (bg >> 11)) * mix5) >> 5);
+    int32_t g = ((bg >> 5) & 0x3F) + (((((fg >> 5) & 0x3F) - ((bg >> 5) & 0x3F)) * mix5) >> 5);
+    int32_t b = (bg & 0x1F) + ((((fg & 0x1F) - (bg & 0x1F)) * mix5) >> 5);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+/**
+ * Blend an ARGB8888 pixel onto RGB565, close to LVGL's lv_color_24_16_mix()
+ * within 1 LSB per channel.
+ */
+static inline uint16_t mix_argb8888_rgb565(const uint8_t* src, uint16_t dst)
+{
+    uint8_t a = src[3];
+    if(a == 0)
+        return dst;
+
+    uint16_t r = src[2] >> 3, g = src[1] >> 2, b = src[0] >> 3;
+    if(a != 255)
+    {
+        uint8_t inv = 255 - a;
+        r           = (r * a + (dst >> 11) * inv) >> 8;
+        g           = (g * a + ((dst >> 5) & 0x3F) * inv) >> 8;
+        b           = (b * a + (dst & 0x1F) * inv) >> 8;
+    }
+    return (r << 11) | (g << 5) | b;
+}
+
+#if BLEND_NEON
+/**
+ * Pack 8-bit channel vectors, already reduced to 5/6/5 bits, into RGB565
+ */
+static inline uint16x8_t pack_rgb565(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+    uint16x8_t px = vshlq_n_u16(vmovl_u8(r), 11);
+    px            = vorrq_u16(px, vshlq_n_u16(vmovl_u8(g), 5));
+    return vorrq_u16(px, vmovl_u8(b));
+}
+#endif
+
+/**
+ * Opaque solid fill of an RGB565 area
+ */
+lv_result_t blend_neon_fill_rgb565(lv_draw_sw_blend_fill_dsc_t* dsc)
+{
+    if(dsc->mask_buf || dsc->opa < LV_OPA_MAX)
+        return LV_RESULT_INVALID;
+
+    uint16_t color = lv_color_to_u16(dsc->color);
+    int32_t  w     = dsc->dest_w;
+
+    for(int32_t y = 0; y < dsc->dest_h; y++)
+    {
+        uint16_t* d = (uint16_t*)((uint8_t*)dsc->dest_buf + y * dsc->dest_stride);
+        int32_t   x = 0;
+#if BLEND_NEON
+        if(!force_scalar)
+        {
+            uint16x8_t c = vdupq_n_u16(color);
+            for(; x + 8 <= w; x += 8)
+            {
+                vst1q_u16(d + x, c);
+            }
+        }
+#endif
+        for(; x < w; x++)
+        {
+            d[x] = color;
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+/**
+ * Solid fill of an RGB565 area with opacity
+ */
+lv_result_t blend_neon_fill_rgb565_opa(lv_draw_sw_blend_fill_dsc_t* dsc)
+{
+    if(dsc->mask_buf)
+        return LV_RESULT_INVALID;
+    if(dsc->opa >= LV_OPA_MAX)
+        return blend_neon_fill_rgb565(dsc);
+
+    uint16_t color = lv_color_to_u16(dsc->color);
+    int32_t  mix5  = (dsc->opa + 4) >> 3;
+    int32_t  w     = dsc->dest_w;
+
+    for(int32_t y = 0; y < dsc->dest_h; y++)
+    {
+        uint16_t* d = (uint16_t*)((uint8_t*)dsc->dest_buf + y * dsc->dest_stride);
+        int32_t   x = 0;
+#if BLEND_NEON
+        if(!force_scalar)
+        {
+            int16x8_t  fr    = vdupq_n_s16(color >> 11);
+            int16x8_t  fg    = vdupq_n_s16((color >> 5) & 0x3F);
+            int16x8_t  fb    = vdupq_n_s16(color & 0x1F);
+            int16x8_t  m     = vdupq_n_s16(mix5);
+            uint16x8_t mask6 = vdupq_n_u16(0x3F);
+            uint16x8_t mask5 = vdupq_n_u16(0x1F);
+
+            for(; x + 8 <= w; x += 8)
+            {
+                uint16x8_t px = vld1q_u16(d + x);
+                int16x8_t  br = vreinterpretq_s16_u16(vshrq_n_u16(px, 11));
+                int16x8_t  bg = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(px, 5), mask6));
+                int16x8_t  bb = vreinterpretq_s16_u16(vandq_u16(px, mask5));
+
+                br = vaddq_s16(br, vshrq_n_s16(vmulq_s16(vsubq_s16(fr, br), m), 5));
+                bg = vaddq_s16(bg, vshrq_n_s16(vmulq_s16(vsubq_s16(fg, bg), m), 5));
+                bb = vaddq_s16(bb, vshrq_n_s16(vmulq_s16(vsubq_s16(fb, bb), m), 5));
+
+                px = vshlq_n_u16(vreinterpretq_u16_s16(br), 11);
+                px = vorrq_u16(px, vshlq_n_u16(vreinterpretq_u16_s16(bg), 5));
+                px = vorrq_u16(px, vreinterpretq_u16_s16(bb));
+                vst1q_u16(d + x, px);
+            }
+        }
+#endif
+        for(; x < w; x++)
+        {
+            d[x] = mix_rgb565(color, d[x], mix5);
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+/**
+ * Opaque solid fill of an ARGB8888 or XRGB8888 area
+ */
+lv_result_t blend_neon_fill_32(lv_draw_sw_blend_fill_dsc_t* dsc)
+{
+    if(dsc->mask_buf || dsc->opa < LV_OPA_MAX)
+        return LV_RESULT_INVALID;
+
+    uint32_t color = lv_color_to_u32(dsc->color);
+    int32_t  w     = dsc->dest_w;
+
+    for(int32_t y = 0; y < dsc->dest_h; y++)
+    {
+        uint32_t* d = (uint32_t*)((uint8_t*)dsc->dest_buf + y * dsc->dest_stride);
+        int32_t   x = 0;
+#if BLEND_NEON
+        if(!force_scalar)
+        {
+            uint32x4_t c = vdupq_n_u32(color);
+            for(; x + 8 <= w; x += 8)
+            {
+                vst1q_u32(d + x, c);
+                vst1q_u32(d + x + 4, c);
+            }
+        }
+#endif
+        for(; x < w; x++)
+        {
+            d[x] = color;
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+/**
+ * Copy an RGB565 image onto RGB565
+ */
+lv_result_t blend_neon_rgb565_to_rgb565(lv_draw_sw_blend_image_dsc_t* dsc)
+{
+    if(dsc->mask_buf || dsc->opa < LV_OPA_MAX || dsc->blend_mode != LV_BLEND_MODE_NORMAL)
+        return LV_RESULT_INVALID;
+
+    int32_t w = dsc->dest_w;
+
+    for(int32_t y = 0; y < dsc->dest_h; y++)
+    {
+        uint16_t*       d = (uint16_t*)((uint8_t*)dsc->dest_buf + y * dsc->dest_stride);
+        const uint16_t* s = (const uint16_t*)((const uint8_t*)dsc->src_buf + y * dsc->src_stride);
+        int32_t         x = 0;
+#if BLEND_NEON
+        if(!force_scalar)
+        {
+            for(; x + 8 <= w; x += 8)
+            {
+                vst1q_u16(d + x, vld1q_u16(s + x));
+            }
+        }
+#endif
+        for(; x < w; x++)
+        {
+            d[x] = s[x];
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+/**
+ * Blend an ARGB8888 image with per-pixel alpha onto RGB565
+ */
+lv_result_t blend_neon_argb8888_to_rgb565(lv_draw_sw_blend_image_dsc_t* dsc)
+{
+    if(dsc->mask_buf || dsc->opa < LV_OPA_MAX || dsc->blend_mode != LV_BLEND_MODE_NORMAL)
+        return LV_RESULT_INVALID;
+
+    int32_t w = dsc->dest_w;
+
+    for(int32_t y = 0; y < dsc->dest_h; y++)
+    {
+        uint16_t*      d = (uint16_t*)((uint8_t*)dsc->dest_buf + y * dsc->dest_stride);
+        const uint8_t* s = (const uint8_t*)dsc->src_buf + y * dsc->src_stride;
+        int32_t        x = 0;
+#if BLEND_NEON
+        if(!force_scalar)
+        {
+            for(; x + 8 <= w; x += 8)
+            {
+                // Memory order of ARGB8888 on little endian: B, G, R, A
+                uint8x8x4_t src = vld4_u8(s + x * 4);
+                uint16x8_t  px  = vld1q_u16(d + x);
+                uint8x8_t   a   = src.val[3];
+                uint8x8_t   inv = vmvn_u8(a);
+
+                uint8x8_t sr = vshr_n_u8(src.val[2], 3);
+                uint8x8_t sg = vshr_n_u8(src.val[1], 2);
+                uint8x8_t sb = vshr_n_u8(src.val[0], 3);
+                uint8x8_t dr = vmovn_u16(vshrq_n_u16(px, 11));
+                uint8x8_t dg = vmovn_u16(vandq_u16(vshrq_n_u16(px, 5), vdupq_n_u16(0x3F)));
+                uint8x8_t db = vmovn_u16(vandq_u16(px, vdupq_n_u16(0x1F)));
+
+                uint8x8_t r = vshrn_n_u16(vmlal_u8(vmull_u8(sr, a), dr, inv), 8);
+                uint8x8_t g = vshrn_n_u16(vmlal_u8(vmull_u8(sg, a), dg, inv), 8);
+                uint8x8_t b = vshrn_n_u16(vmlal_u8(vmull_u8(sb, a), db, inv), 8);
+
+                // Fully opaque pixels take the source, transparent ones keep the destination
+                uint8x8_t opaque = vceq_u8(a, vdup_n_u8(255));
+                r                = vbsl_u8(opaque, sr, r);
+                g                = vbsl_u8(opaque, sg, g);
+                b                = vbsl_u8(opaque, sb, b);
+
+                uint16x8_t transparent = vmovl_u8(vceq_u8(a, vdup_n_u8(0)));
+                transparent            = vorrq_u16(transparent, vshlq_n_u16(transparent, 8));
+                vst1q_u16(d + x, vbslq_u16(transparent, px, pack_rgb565(r, g, b)));
+            }
+        }
+#endif
+        for(; x < w; x++)
+        {
+            d[x] = mix_argb8888_rgb565(s + x * 4, d[x]);
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+/**
+ * Copy an XRGB8888 image onto ARGB8888 or XRGB8888, setting alpha to opaque
+ */
+lv_result_t blend_neon_xrgb8888_to_32(lv_draw_sw_blend_image_dsc_t* dsc)
+{
+    if(dsc->mask_buf || dsc->opa < LV_OPA_MAX || dsc->blend_mode != LV_BLEND_MODE_NORMAL)
+        return LV_RESULT_INVALID;
+
+    int32_t w = dsc->dest_w;
+
+    for(int32_t y = 0; y < dsc->dest_h; y++)
+    {
+        uint32_t*       d = (uint32_t*)((uint8_t*)dsc->dest_buf + y * dsc->dest_stride);
+        const uint32_t* s = (const uint32_t*)((const uint8_t*)dsc->src_buf + y * dsc->src_stride);
+        int32_t         x = 0;
+#if BLEND_NEON
+        if(!force_scalar)
+        {
+            uint32x4_t alpha = vdupq_n_u32(0xFF000000);
+            for(; x + 8 <= w; x += 8)
+            {
+                vst1q_u32(d + x, vorrq_u32(vld1q_u32(s + x), alpha));
+                vst1q_u32(d + x + 4, vorrq_u32(vld1q_u32(s + x + 4), alpha));
+            }
+        }
+#endif
+        for(; x < w; x++)
+        {
+            d[x] = s[x] | 0xFF000000;
+        }
+    }
+    return LV_RESULT_OK;
+}
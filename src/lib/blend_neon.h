@@ -0,0 +1,73 @@
+/*******************************************************************
+ *
+ * blend_neon.h - NEON fill and blend kernels for the software renderer
+ *
+ * Included by LVGL's software blender through
+ * LV_DRAW_SW_ASM_CUSTOM_INCLUDE when built with CAMPER_NEON. Each hook
+ * returns LV_RESULT_INVALID for cases it does not cover, LVGL then
+ * uses its generic C implementation.
+ *
+ ******************************************************************/
+#ifndef BLEND_NEON_H
+#define BLEND_NEON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+#include "lvgl/src/draw/sw/blend/lv_draw_sw_blend_private.h"
+
+#if defined(CAMPER_USE_NEON) && defined(__ARM_NEON)
+#define BLEND_NEON 1
+#else
+#define BLEND_NEON 0
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Fill kernels, opaque fills and RGB565 fills with opacity, without mask
+     * @param dsc LVGL fill descriptor
+     * @return LV_RESULT_OK if handled, LV_RESULT_INVALID to fall back to LVGL
+     */
+    lv_result_t blend_neon_fill_rgb565(lv_draw_sw_blend_fill_dsc_t* dsc);
+    lv_result_t blend_neon_fill_rgb565_opa(lv_draw_sw_blend_fill_dsc_t* dsc);
+    lv_result_t blend_neon_fill_32(lv_draw_sw_blend_fill_dsc_t* dsc);
+
+    /**
+     * Image kernels, normal blend mode at full opacity without mask
+     * @param dsc LVGL image descriptor
+     * @return LV_RESULT_OK if handled, LV_RESULT_INVALID to fall back to LVGL
+     */
+    lv_result_t blend_neon_rgb565_to_rgb565(lv_draw_sw_blend_image_dsc_t* dsc);
+    lv_result_t blend_neon_argb8888_to_rgb565(lv_draw_sw_blend_image_dsc_t* dsc);
+    lv_result_t blend_neon_xrgb8888_to_32(lv_draw_sw_blend_image_dsc_t* dsc);
+
+    /**
+     * Run the scalar versions of the kernels, for comparison in the benchmark
+     * @param scalar true to bypass the NEON code paths
+     */
+    void blend_neon_force_scalar(bool scalar);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#if BLEND_NEON
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) blend_neon_fill_rgb565(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc) blend_neon_fill_rgb565_opa(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_ARGB8888(dsc) blend_neon_fill_32(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB888(dsc, dest_px_size)                                       \
+    ((dest_px_size) == 4 ? blend_neon_fill_32(dsc) : LV_RESULT_INVALID)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) blend_neon_rgb565_to_rgb565(dsc)
+#define LV_DRAW_SW_ARGB8888_BLEND_NORMAL_TO_RGB565(dsc) blend_neon_argb8888_to_rgb565(dsc)
+#define LV_DRAW_SW_RGB888_BLEND_NORMAL_TO_ARGB8888(dsc, src_px_size)                              \
+    ((src_px_size) == 4 ? blend_neon_xrgb8888_to_32(dsc) : LV_RESULT_INVALID)
+#define LV_DRAW_SW_RGB888_BLEND_NORMAL_TO_RGB888(dsc, dest_px_size, src_px_size)                  \
+    ((dest_px_size) == 4 && (src_px_size) == 4 ? blend_neon_xrgb8888_to_32(dsc)                   \
+                                                : LV_RESULT_INVALID)
+#endif
+
+#endif /* BLEND_NEON_H */
@@ -0,0 +1,105 @@
+/*******************************************************************
+ *
+ * color_convert.c - Pixel format conversion for display output
+ *
+ ******************************************************************/
+#include "color_convert.h"
+
+#if defined(CAMPER_USE_NEON) && defined(__ARM_NEON)
+#define COLOR_CONVERT_NEON 1
+#include <arm_neon.h>
+#else
+#define COLOR_CONVERT_NEON 0
+#endif
+
+// 4x4 Bayer threshold matrix, values 0..15
+static const uint8_t bayer_4x4[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+static bool force_scalar = false;
+
+/**
+ * Run the scalar conversion only
+ */
+void color_convert_force_scalar(bool scalar)
+{
+    force_scalar = scalar;
+}
+
+/**
+ * Add a dither offset to a channel and truncate it to the given number of bits
+ */
+static inline uint16_t dither_channel(uint8_t value, uint8_t threshold, uint8_t bits)
+{
+    // Spread the threshold over one quantization step of the target depth
+    uint16_t offset = (threshold << (8 - bits)) >> 4;
+    uint16_t v      = value + offset;
+    if(v > 255)
+        v = 255;
+    return v >> (8 - bits);
+}
+
+/**
+ * Convert an area of XRGB8888 pixels to RGB565 with 4x4 ordered dithering
+ */
+void color_convert_xrgb8888_to_rgb565_dither(const uint8_t* src, uint32_t src_stride,
+                                             uint8_t* dst, uint32_t dst_stride, int32_t x,
+                                             int32_t y, int32_t w, int32_t h)
+{
+    for(int32_t row = y; row < y + h; row++)
+    {
+        const uint8_t* s   = src + row * src_stride + x * 4;
+        uint16_t*      d   = (uint16_t*)(dst + row * dst_stride) + x;
+        const uint8_t* t   = bayer_4x4[row & 3];
+        int32_t        col = x;
+
+#if COLOR_CONVERT_NEON
+        if(!force_scalar)
+        {
+            // The pattern repeats every 4 columns, so 8 thresholds cover every block
+            uint8_t thresholds[8];
+            for(int i = 0; i < 8; i++)
+            {
+                thresholds[i] = t[(col + i) & 3];
+            }
+            uint8x8_t th   = vld1_u8(thresholds);
+            uint8x8_t off5 = vshr_n_u8(th, 1); // Offset for 5-bit channels
+            uint8x8_t off6 = vshr_n_u8(th, 2); // Offset for the 6-bit channel
+
+            for(; col + 8 <= x + w; col += 8)
+            {
+                // Memory order of XRGB8888 on little endian: B, G, R, X
+                uint8x8x4_t px = vld4_u8(s);
+                uint8x8_t   b  = vshr_n_u8(vqadd_u8(px.val[0], off5), 3);
+                uint8x8_t   g  = vshr_n_u8(vqadd_u8(px.val[1], off6), 2);
+                uint8x8_t   r  = vshr_n_u8(vqadd_u8(px.val[2], off5), 3);
+
+                uint16x8_t out = vshlq_n_u16(vmovl_u8(r), 11);
+                out            = vorrq_u16(out, vshlq_n_u16(vmovl_u8(g), 5));
+                out            = vorrq_u16(out, vmovl_u8(b));
+                vst1q_u16(d, out);
+
+                s += 32;
+                d += 8;
+            }
+        }
+#endif
+
+        for(; col < x + w; col++)
+        {
+            uint8_t threshold = t[col & 3];
+
+            // Memory order of XRGB8888 on little endian: B, G, R, X
+            uint16_t b = dither_channel(s[0], threshold, 5);
+            uint16_t g = dither_channel(s[1], threshold, 6);
+            uint16_t r = dither_channel(s[2], threshold, 5);
+
+            *d++ = (r << 11) | (g << 5) | b;
+            s += 4;
+        }
+    }
+}
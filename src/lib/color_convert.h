@@ -0,0 +1,38 @@
+/*******************************************************************
+ *
+ * color_convert.h - Pixel format conversion for display output
+ *
+ ******************************************************************/
+#ifndef COLOR_CONVERT_H
+#define COLOR_CONVERT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Convert an area of XRGB8888 pixels to RGB565 with 4x4 ordered dithering
+ *
+ * The dither pattern is anchored to the screen position of each pixel, so
+ * partial updates line up with the surrounding pixels. Both buffers are
+ * full-frame buffers, only the given area is converted.
+ *
+ * @param src XRGB8888 source buffer
+ * @param src_stride source stride in bytes
+ * @param dst RGB565 destination buffer
+ * @param dst_stride destination stride in bytes
+ * @param x left edge of the area in pixels
+ * @param y top edge of the area in pixels
+ * @param w width of the area in pixels
+ * @param h height of the area in pixels
+ */
+void color_convert_xrgb8888_to_rgb565_dither(const uint8_t* src, uint32_t src_stride,
+                                             uint8_t* dst, uint32_t dst_stride, int32_t x,
+                                             int32_t y, int32_t w, int32_t h);
+
+/**
+ * Run the scalar conversion only, for comparison with the NEON path in the benchmark
+ * @param scalar true to bypass the NEON code path
+ */
+void color_convert_force_scalar(bool scalar);
+
+#endif /* COLOR_CONVERT_H */
@@ -0,0 +1,404 @@
+/*******************************************************************
+ *
+ * display_backend.c - Runtime selection of the display backend
+ *
+ * The SDL backend handles its own input through SDL events. The
+ * DRM and fbdev backends have no window system, so touch input is
+ * read from evdev by a dedicated thread. SDL is optional at build time
+ * (LV_USE_SDL) for minimal-footprint deployments.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "lvgl/lvgl.h"
+#include "display_backend.h"
+#include "lv_sdl_disp.h"
+#include "lv_drm_disp.h"
+#include "lv_fbdev_disp.h"
+#include "lv_headless_disp.h"
+#include "evdev_touch.h"
+#include "drm_power.h"
+#include "../ui/ui.h"
+#include "../main.h"
+#include "logger.h"
+
+static display_backend_type_t active_type      = DISPLAY_BACKEND_COUNT;
+static uint32_t               last_inactive_ms = 0;
+static int                    wakeup_fd        = -1; // Wakes the main loop for non-SDL backends
+
+static const char* backend_names[DISPLAY_BACKEND_COUNT] = {
+    [DISPLAY_BACKEND_SDL]      = "sdl",
+    [DISPLAY_BACKEND_DRM]      = "drm",
+    [DISPLAY_BACKEND_FBDEV]    = "fbdev",
+    [DISPLAY_BACKEND_HEADLESS] = "headless",
+};
+
+static const bool backend_available[DISPLAY_BACKEND_COUNT] = {
+    [DISPLAY_BACKEND_SDL]      = LV_USE_SDL,
+    [DISPLAY_BACKEND_DRM]      = true,
+    [DISPLAY_BACKEND_FBDEV]    = LV_USE_LINUX_FBDEV,
+    [DISPLAY_BACKEND_HEADLESS] = true,
+};
+
+/**
+ * Look up a display backend by name
+ */
+bool display_backend_from_name(const char* name, display_backend_type_t* type)
+{
+    for(int i = 0; i < DISPLAY_BACKEND_COUNT; i++)
+    {
+        if(strcmp(name, backend_names[i]) == 0 && backend_available[i])
+        {
+            *type = (display_backend_type_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Get the name of a display backend
+ */
+const char* display_backend_name(display_backend_type_t type)
+{
+    if(type >= DISPLAY_BACKEND_COUNT)
+        return "none";
+
+    return backend_names[type];
+}
+
+/**
+ * Create an evdev touch input device for backends without a window system
+ */
+static void evdev_input_init(const display_config_t* config)
+{
+    lv_display_t* disp = lv_display_get_default();
+
+    if(!evdev_touch_create(config->input_device, lv_display_get_horizontal_resolution(disp),
+                           lv_display_get_vertical_resolution(disp)))
+    {
+        log_error("Failed to open touch input device %s", config->input_device);
+    }
+}
+
+#if LV_USE_SDL
+/**
+ * Create the SDL display and its mouse and touch input devices
+ */
+static int sdl_backend_init(const display_config_t* config)
+{
+    lv_color_format_t color_format = (config->color_profile == DISPLAY_COLOR_32BPP)
+                                         ? LV_COLOR_FORMAT_ARGB8888
+                                         : LV_COLOR_FORMAT_RGB565;
+
+    lv_port_disp_init(config->width, config->height, color_format,
+                      config->color_profile == DISPLAY_COLOR_RGB565_DITHER);
+
+    if(!lv_sdl_mouse_create())
+    {
+        log_error("Failed to create mouse input device.");
+    }
+
+    if(!lv_sdl_touch_create())
+    {
+        log_error("Warning: Failed to create touch input device.");
+    }
+
+    // Power management is only possible when SDL runs on KMS/DRM
+    int drm_fd = lv_sdl_get_drm_fd();
+    if(drm_fd >= 0)
+    {
+        drm_power_init(drm_fd, 0);
+    }
+
+    return 0;
+}
+
+/**
+ * Blank the SDL display through the DRM fd SDL uses under KMS/DRM
+ */
+static int sdl_backend_blank(bool blank)
+{
+    // Let SDL allow the screensaver while the display is off
+    SDL_SetHint(SDL_HINT_VIDEO_ALLOW_SCREENSAVER, blank ? "1" : "0");
+    if(blank)
+    {
+        SDL_EnableScreenSaver();
+    }
+    else
+    {
+        SDL_DisableScreenSaver();
+    }
+    return drm_power_set_blank(blank);
+}
+#endif
+
+/**
+ * Create the DRM display and an evdev touch input device
+ */
+static int drm_backend_init(const display_config_t* config)
+{
+    const char* device = config->display_device ? config->display_device : DISPLAY_DRM_DEVICE;
+
+    // LVGL renders straight into scanout memory, there is no conversion step to dither in
+    if(config->color_profile == DISPLAY_COLOR_RGB565_DITHER)
+    {
+        log_warning("Dithering is not supported by the drm backend, using plain RGB565");
+    }
+
+    lv_color_format_t color_format = (config->color_profile == DISPLAY_COLOR_32BPP)
+                                         ? LV_COLOR_FORMAT_XRGB8888
+                                         : LV_COLOR_FORMAT_RGB565;
+
+    if(lv_drm_disp_init(device, config->width, config->height, color_format) != 0)
+    {
+        return -1;
+    }
+
+    drm_power_init(lv_drm_disp_get_fd(), lv_drm_disp_get_connector_id());
+    evdev_input_init(config);
+    return 0;
+}
+
+#if LV_USE_LINUX_FBDEV
+/**
+ * Create the framebuffer display and an evdev touch input device
+ */
+static int fbdev_backend_init(const display_config_t* config)
+{
+    const char* device = config->display_device ? config->display_device : DISPLAY_FBDEV_DEVICE;
+
+    // LVGL's fbdev driver follows the framebuffer's configured depth
+    if(config->color_profile != DISPLAY_COLOR_32BPP)
+    {
+        log_info("fbdev backend uses the framebuffer depth, set it with fbset -depth 16");
+    }
+
+    if(lv_fbdev_disp_init(device) != 0)
+    {
+        return -1;
+    }
+
+    evdev_input_init(config);
+    return 0;
+}
+#endif
+
+/**
+ * Create the headless display, it has no input devices
+ */
+static int headless_backend_init(const display_config_t* config)
+{
+    if(config->color_profile == DISPLAY_COLOR_RGB565_DITHER)
+    {
+        log_warning("Dithering is not supported by the headless backend, using plain RGB565");
+    }
+
+    lv_color_format_t color_format = (config->color_profile == DISPLAY_COLOR_32BPP)
+                                         ? LV_COLOR_FORMAT_XRGB8888
+                                         : LV_COLOR_FORMAT_RGB565;
+
+    return lv_headless_disp_init(config->width, config->height, color_format);
+}
+
+/**
+ * Initialize the configured display backend and its input devices
+ */
+int display_backend_init(const display_config_t* config)
+{
+    int rv = -1;
+
+    switch(config->type)
+    {
+#if LV_USE_SDL
+        case DISPLAY_BACKEND_SDL: rv = sdl_backend_init(config); break;
+#endif
+        case DISPLAY_BACKEND_DRM: rv = drm_backend_init(config); break;
+#if LV_USE_LINUX_FBDEV
+        case DISPLAY_BACKEND_FBDEV: rv = fbdev_backend_init(config); break;
+#endif
+        case DISPLAY_BACKEND_HEADLESS: rv = headless_backend_init(config); break;
+        default: log_error("Unknown display backend %d", config->type); break;
+    }
+
+    if(rv == 0 && config->type != DISPLAY_BACKEND_SDL)
+    {
+        wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(wakeup_fd < 0)
+        {
+            log_error("Failed to create wakeup eventfd: %s", strerror(errno));
+        }
+    }
+
+    if(rv == 0)
+    {
+        active_type = config->type;
+        log_info("Display backend: %s", display_backend_name(active_type));
+    }
+
+    return rv;
+}
+
+/**
+ * Clean up the active display backend
+ */
+void display_backend_deinit(void)
+{
+    evdev_touch_delete();
+    drm_power_deinit();
+
+    switch(active_type)
+    {
+#if LV_USE_SDL
+        case DISPLAY_BACKEND_SDL: lv_port_disp_deinit(); break;
+#endif
+        case DISPLAY_BACKEND_DRM: lv_drm_disp_deinit(); break;
+#if LV_USE_LINUX_FBDEV
+        case DISPLAY_BACKEND_FBDEV: lv_fbdev_disp_deinit(); break;
+#endif
+        case DISPLAY_BACKEND_HEADLESS: lv_headless_disp_deinit(); break;
+        default: break;
+    }
+
+    if(wakeup_fd >= 0)
+    {
+        close(wakeup_fd);
+        wakeup_fd = -1;
+    }
+
+    active_type = DISPLAY_BACKEND_COUNT;
+}
+
+/**
+ * Forward evdev input activity to the inactivity timer
+ * evdev input bypasses the SDL event loop, so LVGL's activity tracking is used instead.
+ */
+static void evdev_track_activity(void)
+{
+    uint32_t inactive_ms = lv_display_get_inactive_time(NULL);
+    if(inactive_ms < last_inactive_ms && !ui_is_sleeping())
+    {
+        ui_reset_inactivity_timer();
+    }
+    last_inactive_ms = inactive_ms;
+}
+
+/**
+ * Handle backend events (called in the main loop)
+ */
+void display_backend_handle_events(void)
+{
+    switch(active_type)
+    {
+#if LV_USE_SDL
+        case DISPLAY_BACKEND_SDL: lv_sdl_handle_events(); break;
+#endif
+        case DISPLAY_BACKEND_DRM:
+            lv_drm_disp_handle_events();
+            evdev_touch_process();
+            evdev_track_activity();
+            break;
+
+        case DISPLAY_BACKEND_FBDEV:
+            evdev_touch_process();
+            evdev_track_activity();
+            break;
+
+        default: break;
+    }
+}
+
+/**
+ * Wait on the touch, page flip and wakeup fds of the non-SDL backends
+ */
+static void poll_backend_fds(uint32_t timeout_ms)
+{
+    struct pollfd fds[3];
+    nfds_t        nfds = 0;
+
+    int touch_fd = evdev_touch_get_wake_fd();
+    if(touch_fd >= 0)
+    {
+        fds[nfds++] = (struct pollfd){.fd = touch_fd, .events = POLLIN};
+    }
+    if(active_type == DISPLAY_BACKEND_DRM)
+    {
+        fds[nfds++] = (struct pollfd){.fd = lv_drm_disp_get_fd(), .events = POLLIN};
+    }
+    if(wakeup_fd >= 0)
+    {
+        fds[nfds++] = (struct pollfd){.fd = wakeup_fd, .events = POLLIN};
+    }
+
+    if(poll(fds, nfds, (int)timeout_ms) > 0 && wakeup_fd >= 0)
+    {
+        uint64_t count;
+        if(read(wakeup_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+            log_warning("Failed to clear wakeup eventfd: %s", strerror(errno));
+        }
+    }
+}
+
+/**
+ * Block until backend input is pending, a wakeup is requested or the timeout expires
+ */
+void display_backend_wait_events(uint32_t timeout_ms)
+{
+    switch(active_type)
+    {
+#if LV_USE_SDL
+        case DISPLAY_BACKEND_SDL: lv_sdl_wait_events(timeout_ms); break;
+#endif
+        case DISPLAY_BACKEND_DRM:
+        case DISPLAY_BACKEND_FBDEV:
+        case DISPLAY_BACKEND_HEADLESS: poll_backend_fds(timeout_ms); break;
+
+        default: usleep(timeout_ms * 1000); break;
+    }
+}
+
+/**
+ * Wake up display_backend_wait_events(), safe to call from any thread
+ */
+void display_backend_wakeup(void)
+{
+#if LV_USE_SDL
+    if(active_type == DISPLAY_BACKEND_SDL)
+    {
+        lv_sdl_wakeup();
+        return;
+    }
+#endif
+
+    uint64_t one = 1;
+    if(wakeup_fd >= 0 && write(wakeup_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    {
+        log_warning("Failed to signal wakeup eventfd: %s", strerror(errno));
+    }
+}
+
+/**
+ * Blank or unblank the display
+ */
+int display_backend_blank(bool blank)
+{
+    switch(active_type)
+    {
+#if LV_USE_SDL
+        case DISPLAY_BACKEND_SDL: return sdl_backend_blank(blank);
+#endif
+        case DISPLAY_BACKEND_DRM: return drm_power_set_blank(blank);
+#if LV_USE_LINUX_FBDEV
+        case DISPLAY_BACKEND_FBDEV: return lv_fbdev_disp_blank(blank ? 1 : 0);
+#endif
+        case DISPLAY_BACKEND_HEADLESS: return 0;
+
+        default: return -1;
+    }
+}
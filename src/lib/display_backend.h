@@ -0,0 +1,103 @@
+/*******************************************************************
+ *
+ * display_backend.h - Runtime selection of the display backend
+ *
+ ******************************************************************/
+#ifndef DISPLAY_BACKEND_H
+#define DISPLAY_BACKEND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Available display backends
+     */
+    typedef enum
+    {
+        DISPLAY_BACKEND_SDL = 0,  // SDL2 window with software renderer
+        DISPLAY_BACKEND_DRM,      // Native DRM/KMS with page flipping
+        DISPLAY_BACKEND_FBDEV,    // Linux framebuffer, minimal footprint
+        DISPLAY_BACKEND_HEADLESS, // Renders into memory only, for benchmarks and CI
+        DISPLAY_BACKEND_COUNT
+    } display_backend_type_t;
+
+    /**
+     * Color profiles for rendering and output
+     */
+    typedef enum
+    {
+        DISPLAY_COLOR_32BPP = 0,     // Render and output 32 bpp
+        DISPLAY_COLOR_RGB565,        // Render and output RGB565, halves buffer bandwidth
+        DISPLAY_COLOR_RGB565_DITHER, // Render 32 bpp, output RGB565 with ordered dithering
+    } display_color_profile_t;
+
+    /**
+     * Display backend configuration
+     */
+    typedef struct
+    {
+        display_backend_type_t  type;
+        int                     width;          // Preferred width in pixels
+        int                     height;         // Preferred height in pixels
+        display_color_profile_t color_profile;  // Render and output color format
+        const char*             display_device; // DRM or framebuffer device node, NULL for default
+        const char*             input_device;   // evdev touch device for non-SDL backends
+    } display_config_t;
+
+    /**
+     * Look up a display backend by name
+     * @param name backend name ("sdl", "drm", "fbdev", "headless")
+     * @param type output for the backend type
+     * @return true if the name is known and the backend is compiled in
+     */
+    bool display_backend_from_name(const char* name, display_backend_type_t* type);
+
+    /**
+     * Get the name of a display backend
+     * @param type backend type
+     * @return backend name
+     */
+    const char* display_backend_name(display_backend_type_t type);
+
+    /**
+     * Initialize the configured display backend and its input devices
+     * @param config backend configuration
+     * @return 0 on success, -1 on failure
+     */
+    int  display_backend_init(const display_config_t* config);
+    void display_backend_deinit(void);
+
+    /**
+     * Handle backend events (called in the main loop)
+     */
+    void display_backend_handle_events(void);
+
+    /**
+     * Block until backend input is pending, a wakeup is requested or the timeout expires
+     * Replaces a fixed sleep in the main loop so it only runs when there is work to do.
+     * @param timeout_ms maximum time to wait in milliseconds
+     */
+    void display_backend_wait_events(uint32_t timeout_ms);
+
+    /**
+     * Wake up display_backend_wait_events(), safe to call from any thread
+     */
+    void display_backend_wakeup(void);
+
+    /**
+     * Blank or unblank the display
+     * @param blank true to turn the display off, false to turn it on
+     * @return 0 on success, -1 on failure
+     */
+    int display_backend_blank(bool blank);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* DISPLAY_BACKEND_H */
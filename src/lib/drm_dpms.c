@@ -0,0 +1,99 @@
+/*******************************************************************
+ *
+ * drm_dpms.c - DRM connector power management helpers
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include "drm_dpms.h"
+#include "logger.h"
+
+/**
+ * Find the first connected connector with at least one mode
+ */
+uint32_t drm_find_connected_connector(int drm_fd)
+{
+    drmModeRes* res = drmModeGetResources(drm_fd);
+    if(!res)
+    {
+        log_error("drmModeGetResources failed: %s", strerror(errno));
+        return 0;
+    }
+
+    uint32_t connector_id = 0;
+    for(int i = 0; i < res->count_connectors && connector_id == 0; i++)
+    {
+        drmModeConnector* conn = drmModeGetConnector(drm_fd, res->connectors[i]);
+        if(!conn)
+            continue;
+
+        if(conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0)
+        {
+            connector_id = conn->connector_id;
+        }
+        drmModeFreeConnector(conn);
+    }
+
+    drmModeFreeResources(res);
+    return connector_id;
+}
+
+/**
+ * Find the DPMS property ID of a connector
+ */
+uint32_t drm_find_dpms_property_id(int drm_fd, uint32_t connector_id)
+{
+    drmModeObjectProperties* props =
+        drmModeObjectGetProperties(drm_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR);
+    if(!props)
+    {
+        log_error("drmModeObjectGetProperties failed: %s", strerror(errno));
+        return 0;
+    }
+
+    // Search properties for "DPMS"
+    uint32_t dpms_prop_id = 0;
+    for(uint32_t i = 0; i < props->count_props; i++)
+    {
+        drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
+        if(prop)
+        {
+            if(strcmp(prop->name, "DPMS") == 0)
+            {
+                dpms_prop_id = prop->prop_id;
+                drmModeFreeProperty(prop);
+                break;
+            }
+            drmModeFreeProperty(prop);
+        }
+    }
+
+    drmModeFreeObjectProperties(props);
+    return dpms_prop_id;
+}
+
+/**
+ * Set the DPMS state of a connector
+ */
+int drm_set_dpms(int drm_fd, uint32_t connector_id, uint32_t dpms_prop_id, int off)
+{
+    if(dpms_prop_id == 0)
+    {
+        log_error("DPMS property not found on connector %u", connector_id);
+        return -1;
+    }
+
+    uint64_t dpms_val = off ? DRM_MODE_DPMS_OFF : DRM_MODE_DPMS_ON;
+    int      ret      = drmModeConnectorSetProperty(drm_fd, connector_id, dpms_prop_id, dpms_val);
+    if(ret != 0)
+    {
+        log_error("Failed to set DPMS property to %s on connector %u: %s (err=%d)",
+                  off ? "OFF" : "ON", connector_id, strerror(errno), ret);
+        return -1;
+    }
+    return 0;
+}
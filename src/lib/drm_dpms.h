@@ -0,0 +1,45 @@
+/*******************************************************************
+ *
+ * drm_dpms.h - DRM connector power management helpers
+ *
+ ******************************************************************/
+#ifndef DRM_DPMS_H
+#define DRM_DPMS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Find the first connected connector with at least one mode
+     * @param drm_fd open DRM file descriptor
+     * @return connector ID, or 0 if no connector is connected
+     */
+    uint32_t drm_find_connected_connector(int drm_fd);
+
+    /**
+     * Find the DPMS property ID of a connector
+     * @param drm_fd open DRM file descriptor
+     * @param connector_id connector to inspect
+     * @return property ID, or 0 if the connector has no DPMS property
+     */
+    uint32_t drm_find_dpms_property_id(int drm_fd, uint32_t connector_id);
+
+    /**
+     * Set the DPMS state of a connector
+     * @param drm_fd open DRM file descriptor
+     * @param connector_id connector to blank or unblank
+     * @param dpms_prop_id DPMS property ID from drm_find_dpms_property_id()
+     * @param off 1 to blank, 0 to unblank
+     * @return 0 on success, -1 on failure
+     */
+    int drm_set_dpms(int drm_fd, uint32_t connector_id, uint32_t dpms_prop_id, int off);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* DRM_DPMS_H */
@@ -0,0 +1,305 @@
+/*******************************************************************
+ *
+ * drm_power.c - Asynchronous DRM display power management
+ *
+ * The connector, its DPMS property and the sysfs backlight are looked
+ * up once at startup. Blank and unblank requests are handed to a
+ * power thread, so the UI thread never waits for the DPMS ioctl or a
+ * backlight fade and can render the wake-up frame right away. Only the
+ * latest request counts, a wake during a fade-out cancels the fade.
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "drm_power.h"
+#include "drm_dpms.h"
+#include "logger.h"
+#include "../main.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static int      drm_fd       = -1;
+static uint32_t connector_id = 0;
+static uint32_t dpms_prop_id = 0;
+
+// Backlight, unused when backlight_max is 0
+static char backlight_path[PATH_MAX];
+static int  backlight_max      = 0;
+static int  backlight_on_level = 0; // Brightness restored on unblank
+
+static pthread_t       power_thread;
+static pthread_mutex_t power_mutex     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  power_cond      = PTHREAD_COND_INITIALIZER;
+static bool            thread_running  = false;
+static bool            request_pending = false;
+static bool            requested_blank = false;
+
+// Power thread only
+static bool applied_blank = false;
+
+/**
+ * Read an integer from a sysfs attribute
+ */
+static int read_sysfs_int(const char* path)
+{
+    FILE* fp = fopen(path, "r");
+    if(!fp)
+        return -1;
+
+    int value = -1;
+    if(fscanf(fp, "%d", &value) != 1)
+    {
+        value = -1;
+    }
+    fclose(fp);
+    return value;
+}
+
+/**
+ * Find the first backlight device and remember its brightness
+ */
+static void backlight_init(void)
+{
+    DIR* dir = opendir(DISPLAY_BACKLIGHT_DIR);
+    if(!dir)
+    {
+        log_debug("No backlight control in %s", DISPLAY_BACKLIGHT_DIR);
+        return;
+    }
+
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL)
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s/max_brightness", DISPLAY_BACKLIGHT_DIR,
+                 entry->d_name);
+        int max = read_sysfs_int(path);
+
+        snprintf(path, sizeof(path), "%s/%s/brightness", DISPLAY_BACKLIGHT_DIR, entry->d_name);
+        int level = read_sysfs_int(path);
+
+        if(max <= 0 || level < 0 || access(path, W_OK) != 0)
+            continue;
+
+        snprintf(backlight_path, sizeof(backlight_path), "%s", path);
+        backlight_max      = max;
+        backlight_on_level = (level > 0) ? level : max;
+        log_info("Backlight: %s (%d/%d)", entry->d_name, level, max);
+        break;
+    }
+
+    closedir(dir);
+}
+
+/**
+ * Set the backlight brightness
+ */
+static void backlight_set(int level)
+{
+    int fd = open(backlight_path, O_WRONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        log_warning("Failed to open %s: %s", backlight_path, strerror(errno));
+        return;
+    }
+
+    char buf[16];
+    int  len = snprintf(buf, sizeof(buf), "%d", level);
+    if(write(fd, buf, len) != len)
+    {
+        log_warning("Failed to set backlight to %d: %s", level, strerror(errno));
+    }
+    close(fd);
+}
+
+/**
+ * Check whether a newer request is waiting
+ */
+static bool request_superseded(void)
+{
+    pthread_mutex_lock(&power_mutex);
+    bool pending = request_pending || !thread_running;
+    pthread_mutex_unlock(&power_mutex);
+    return pending;
+}
+
+/**
+ * Fade the backlight between two levels
+ * @return false if a newer request cancelled the fade
+ */
+static bool backlight_fade(int from, int to)
+{
+    for(int step = 1; step <= DISPLAY_BACKLIGHT_FADE_STEPS; step++)
+    {
+        if(request_superseded())
+            return false;
+
+        backlight_set(from + (to - from) * step / DISPLAY_BACKLIGHT_FADE_STEPS);
+        if(step < DISPLAY_BACKLIGHT_FADE_STEPS)
+        {
+            usleep(DISPLAY_BACKLIGHT_FADE_MS * 1000 / DISPLAY_BACKLIGHT_FADE_STEPS);
+        }
+    }
+    return true;
+}
+
+/**
+ * Apply a blank or unblank request (power thread)
+ */
+static void apply_blank(bool blank)
+{
+    if(blank)
+    {
+        if(applied_blank)
+            return;
+
+        if(backlight_max > 0)
+        {
+            int level = read_sysfs_int(backlight_path);
+            if(level > 0)
+            {
+                backlight_on_level = level;
+            }
+            // A dark backlight, e.g. after a failed blank, is not lit up to fade it out again
+            if(!backlight_fade(level >= 0 ? level : backlight_on_level, 0))
+                return;
+        }
+
+        // A failed blank stays unapplied, so the next blank request retries it
+        if(dpms_prop_id != 0 && drm_set_dpms(drm_fd, connector_id, dpms_prop_id, 1) != 0)
+            return;
+        applied_blank = true;
+    }
+    else
+    {
+        // A failed unblank stays blanked, so the next unblank request retries it
+        bool unblanked = !applied_blank || dpms_prop_id == 0 ||
+                         drm_set_dpms(drm_fd, connector_id, dpms_prop_id, 0) == 0;
+        if(unblanked)
+        {
+            applied_blank = false;
+        }
+
+        // Also restores the level after a cancelled fade-out
+        if(backlight_max > 0)
+        {
+            int level = read_sysfs_int(backlight_path);
+            backlight_fade(level >= 0 ? level : 0, backlight_on_level);
+        }
+    }
+}
+
+/**
+ * Power thread, applies the latest request
+ */
+static void* power_thread_cb(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&power_mutex);
+    while(thread_running)
+    {
+        if(!request_pending)
+        {
+            pthread_cond_wait(&power_cond, &power_mutex);
+            continue;
+        }
+
+        bool blank      = requested_blank;
+        request_pending = false;
+        pthread_mutex_unlock(&power_mutex);
+
+        apply_blank(blank);
+
+        pthread_mutex_lock(&power_mutex);
+    }
+    pthread_mutex_unlock(&power_mutex);
+
+    return NULL;
+}
+
+/**
+ * Resolve the connector, DPMS property and backlight, and start the power thread
+ */
+int drm_power_init(int fd, uint32_t connector)
+{
+    drm_fd       = fd;
+    connector_id = connector ? connector : drm_find_connected_connector(fd);
+    dpms_prop_id = connector_id ? drm_find_dpms_property_id(fd, connector_id) : 0;
+
+    backlight_init();
+
+    if(dpms_prop_id == 0 && backlight_max == 0)
+    {
+        log_error("No DPMS property or backlight to control display power");
+        drm_fd = -1;
+        return -1;
+    }
+
+    thread_running = true;
+    int rc         = pthread_create(&power_thread, NULL, power_thread_cb, NULL);
+    if(rc != 0)
+    {
+        log_error("Failed to create display power thread: %s", strerror(rc));
+        thread_running = false;
+        drm_fd         = -1;
+        return -1;
+    }
+
+    log_info("Display power: connector %u, DPMS %s, backlight %s", connector_id,
+             dpms_prop_id ? "yes" : "no", backlight_max ? "yes" : "no");
+    return 0;
+}
+
+/**
+ * Stop the power thread
+ */
+void drm_power_deinit(void)
+{
+    pthread_mutex_lock(&power_mutex);
+    bool running   = thread_running;
+    thread_running = false;
+    pthread_cond_signal(&power_cond);
+    pthread_mutex_unlock(&power_mutex);
+
+    if(running)
+    {
+        pthread_join(power_thread, NULL);
+    }
+
+    drm_fd          = -1;
+    dpms_prop_id    = 0;
+    backlight_max   = 0;
+    request_pending = false;
+    applied_blank   = false;
+}
+
+/**
+ * Request the display to be blanked or unblanked
+ */
+int drm_power_set_blank(bool blank)
+{
+    pthread_mutex_lock(&power_mutex);
+    bool running = thread_running;
+    if(running)
+    {
+        requested_blank = blank;
+        request_pending = true;
+        pthread_cond_signal(&power_cond);
+    }
+    pthread_mutex_unlock(&power_mutex);
+
+    return running ? 0 : -1;
+}
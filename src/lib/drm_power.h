@@ -0,0 +1,40 @@
+/*******************************************************************
+ *
+ * drm_power.h - Asynchronous DRM display power management
+ *
+ ******************************************************************/
+#ifndef DRM_POWER_H
+#define DRM_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Resolve the connector, its DPMS property and the backlight once and start the
+     * power thread that applies blank requests
+     * @param drm_fd open DRM file descriptor, must stay open until drm_power_deinit()
+     * @param connector_id connector to control, 0 for the first connected connector
+     * @return 0 on success, -1 if neither DPMS nor a backlight can be controlled
+     */
+    int  drm_power_init(int drm_fd, uint32_t connector_id);
+    void drm_power_deinit(void);
+
+    /**
+     * Request the display to be blanked or unblanked
+     * Returns immediately, the power thread applies the latest request. Blanking
+     * fades the backlight out before DPMS off, unblanking restores it after DPMS on.
+     * @param blank true to turn the display off, false to turn it on
+     * @return 0 if the request was queued, -1 if power management is not available
+     */
+    int drm_power_set_blank(bool blank);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* DRM_POWER_H */
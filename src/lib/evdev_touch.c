@@ -0,0 +1,393 @@
+/*******************************************************************
+ *
+ * evdev_touch.c - Threaded evdev touchscreen input
+ *
+ * A reader thread blocks on the touchscreen and publishes the latest
+ * state as a single 64-bit word, so the LVGL read callback never
+ * waits for it. Every state change is also signalled on an eventfd
+ * the main loop can poll to react without waiting for its next tick.
+ * A press is also latched until LVGL read it, so a tap released
+ * between two reads is not lost. Only the first finger (multi-touch
+ * slot 0) is tracked.
+ *
+ ******************************************************************/
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <libevdev/libevdev.h>
+
+#include "evdev_touch.h"
+#include "indev_idle.h"
+#include "logger.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define LATENCY_MAX_AGE_NS 1000000000ULL // Discard samples when nothing was rendered in time
+
+// Layout of the published touch state
+#define STATE_X(s) ((int32_t)((s) & 0xFFFF))
+#define STATE_Y(s) ((int32_t)(((s) >> 16) & 0xFFFF))
+#define STATE_PRESSED(s) ((bool)(((s) >> 32) & 0x1))
+#define STATE_SEQ(s) ((uint32_t)((s) >> 33))
+#define STATE_PACK(x, y, pressed, seq)                                                            \
+    (((uint64_t)(uint16_t)(x)) | ((uint64_t)(uint16_t)(y) << 16) |                                \
+     ((uint64_t)((pressed) ? 1 : 0) << 32) | ((uint64_t)(seq) << 33))
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static struct libevdev* evdev   = NULL;
+static int              dev_fd  = -1;
+static int              wake_fd = -1;
+static lv_indev_t*      indev   = NULL;
+static pthread_t        reader_thread;
+static bool             reader_running = false;
+
+// Calibration
+static int32_t display_hor_res;
+static int32_t display_ver_res;
+static int     abs_x_code = ABS_X;
+static int     abs_y_code = ABS_Y;
+
+// Shared between the reader thread and the UI thread, accessed atomically
+static uint64_t published_state   = 0;
+static uint64_t published_press   = 0; // Position of the latest press, its seq counts presses
+static uint64_t published_time_ns = 0;
+
+// UI thread only
+static uint32_t            last_read_seq   = 0;
+static uint32_t            last_press_seq  = 0;
+static bool                latency_pending = false;
+static uint64_t            latency_start_ns;
+static evdev_touch_stats_t stats;
+static uint64_t            latency_sum_us = 0;
+
+/**
+ * Get the current CLOCK_MONOTONIC time in nanoseconds
+ */
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Scale a raw axis value to display coordinates
+ */
+static int32_t scale_axis(int code, int value, int32_t resolution)
+{
+    const struct input_absinfo* info = libevdev_get_abs_info(evdev, code);
+    if(!info || info->maximum <= info->minimum)
+        return value;
+
+    int32_t scaled = (int64_t)(value - info->minimum) * (resolution - 1) /
+                     (info->maximum - info->minimum);
+    return LV_CLAMP(0, scaled, resolution - 1);
+}
+
+/**
+ * Reader thread, blocks on the device and publishes every complete report
+ */
+static void* reader_thread_cb(void* arg)
+{
+    (void)arg;
+
+    int32_t  x = 0, y = 0;
+    bool     pressed   = false;
+    int      slot      = 0;
+    uint32_t seq       = 0;
+    uint32_t press_seq = 0;
+    uint64_t last      = STATE_PACK(0, 0, false, 0);
+
+    unsigned int flags = LIBEVDEV_READ_FLAG_NORMAL | LIBEVDEV_READ_FLAG_BLOCKING;
+
+    while(reader_running)
+    {
+        struct input_event ev;
+        int                rc = libevdev_next_event(evdev, flags, &ev);
+
+        if(rc == LIBEVDEV_READ_STATUS_SYNC)
+        {
+            // Events were dropped, continue with the re-synced device state
+            flags = LIBEVDEV_READ_FLAG_SYNC;
+        }
+        else if(rc == -EAGAIN)
+        {
+            flags = LIBEVDEV_READ_FLAG_NORMAL | LIBEVDEV_READ_FLAG_BLOCKING;
+            continue;
+        }
+        else if(rc < 0)
+        {
+            if(rc == -EINTR)
+                continue;
+
+            log_error("Touch device read failed: %s", strerror(-rc));
+            break;
+        }
+
+        if(ev.type == EV_ABS && ev.code == ABS_MT_SLOT)
+        {
+            slot = ev.value;
+        }
+        else if(ev.type == EV_ABS && ev.code > ABS_MT_SLOT && slot != 0)
+        {
+            // Other fingers must not move the pointer or release it
+            continue;
+        }
+        else if(ev.type == EV_ABS && ev.code == abs_x_code)
+        {
+            x = scale_axis(abs_x_code, ev.value, display_hor_res);
+        }
+        else if(ev.type == EV_ABS && ev.code == abs_y_code)
+        {
+            y = scale_axis(abs_y_code, ev.value, display_ver_res);
+        }
+        else if(ev.type == EV_ABS && ev.code == ABS_MT_TRACKING_ID)
+        {
+            pressed = (ev.value >= 0);
+        }
+        else if(ev.type == EV_KEY && ev.code == BTN_TOUCH)
+        {
+            pressed = (ev.value != 0);
+        }
+        else if(ev.type == EV_SYN && ev.code == SYN_REPORT)
+        {
+            // Only publish reports that change the position or the pressed state
+            uint64_t value = STATE_PACK(x, y, pressed, 0);
+            if(value == last)
+                continue;
+
+            // Latch the press before the state, so a reader seeing the state also sees it
+            if(pressed && !STATE_PRESSED(last))
+            {
+                __atomic_store_n(&published_press, STATE_PACK(x, y, true, ++press_seq),
+                                 __ATOMIC_RELEASE);
+            }
+
+            last           = value;
+            uint64_t state = STATE_PACK(x, y, pressed, ++seq);
+
+            uint64_t event_ns = (uint64_t)ev.input_event_sec * 1000000000ULL +
+                                (uint64_t)ev.input_event_usec * 1000ULL;
+            __atomic_store_n(&published_time_ns, event_ns, __ATOMIC_RELAXED);
+            __atomic_store_n(&published_state, state, __ATOMIC_RELEASE);
+
+            uint64_t one = 1;
+            if(write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+            {
+                log_warning("Failed to signal touch event: %s", strerror(errno));
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * LVGL read callback, picks up the latest published state
+ */
+static void evdev_touch_read(lv_indev_t* indev_drv, lv_indev_data_t* data)
+{
+    uint64_t state = __atomic_load_n(&published_state, __ATOMIC_ACQUIRE);
+    uint64_t press = __atomic_load_n(&published_press, __ATOMIC_ACQUIRE);
+    uint64_t shown = state;
+
+    // A press released again before this read is reported once, the next read releases it
+    if(STATE_SEQ(press) != last_press_seq)
+    {
+        last_press_seq = STATE_SEQ(press);
+        if(!STATE_PRESSED(state))
+        {
+            shown = press;
+        }
+    }
+
+    data->point.x = STATE_X(shown);
+    data->point.y = STATE_Y(shown);
+    data->state   = STATE_PRESSED(shown) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    // Start a latency measurement for the first unmeasured report
+    if(STATE_SEQ(state) != last_read_seq)
+    {
+        last_read_seq = STATE_SEQ(state);
+        if(!latency_pending)
+        {
+            latency_start_ns = __atomic_load_n(&published_time_ns, __ATOMIC_RELAXED);
+            latency_pending  = true;
+        }
+    }
+
+    indev_idle_update(indev_drv, data);
+}
+
+/**
+ * Display render callback, completes a pending latency measurement
+ */
+static void render_ready_cb(lv_event_t* e)
+{
+    (void)e;
+
+    if(!latency_pending)
+        return;
+    latency_pending = false;
+
+    uint64_t now = monotonic_ns();
+    if(now < latency_start_ns || now - latency_start_ns > LATENCY_MAX_AGE_NS)
+        return;
+
+    uint32_t latency_us = (uint32_t)((now - latency_start_ns) / 1000);
+    stats.samples++;
+    latency_sum_us += latency_us;
+    if(latency_us > stats.max_latency_us)
+    {
+        stats.max_latency_us = latency_us;
+    }
+}
+
+/**
+ * Create a touchscreen input device read by a dedicated thread
+ */
+lv_indev_t* evdev_touch_create(const char* device, int32_t hor_res, int32_t ver_res)
+{
+    dev_fd = open(device, O_RDONLY | O_CLOEXEC);
+    if(dev_fd < 0)
+    {
+        log_error("Failed to open touch device %s: %s", device, strerror(errno));
+        return NULL;
+    }
+
+    int rc = libevdev_new_from_fd(dev_fd, &evdev);
+    if(rc < 0)
+    {
+        log_error("Failed to initialize libevdev for %s: %s", device, strerror(-rc));
+        evdev_touch_delete();
+        return NULL;
+    }
+
+    // Kernel timestamps on the same clock as the latency measurement
+    libevdev_set_clock_id(evdev, CLOCK_MONOTONIC);
+
+    // Prefer multi-touch slot 0 coordinates when the device reports them
+    if(libevdev_has_event_code(evdev, EV_ABS, ABS_MT_POSITION_X) &&
+       !libevdev_has_event_code(evdev, EV_ABS, ABS_X))
+    {
+        abs_x_code = ABS_MT_POSITION_X;
+        abs_y_code = ABS_MT_POSITION_Y;
+    }
+
+    display_hor_res = hor_res;
+    display_ver_res = ver_res;
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(wake_fd < 0)
+    {
+        log_error("Failed to create touch eventfd: %s", strerror(errno));
+        evdev_touch_delete();
+        return NULL;
+    }
+
+    reader_running = true;
+    rc             = pthread_create(&reader_thread, NULL, reader_thread_cb, NULL);
+    if(rc != 0)
+    {
+        log_error("Failed to create touch reader thread: %s", strerror(rc));
+        reader_running = false;
+        evdev_touch_delete();
+        return NULL;
+    }
+
+    indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, evdev_touch_read);
+
+    lv_display_add_event_cb(lv_display_get_default(), render_ready_cb, LV_EVENT_RENDER_READY,
+                            NULL);
+
+    log_info("Touch input: %s (%s)", libevdev_get_name(evdev), device);
+    return indev;
+}
+
+/**
+ * Stop the reader thread and delete the input device
+ */
+void evdev_touch_delete(void)
+{
+    if(reader_running)
+    {
+        reader_running = false;
+        pthread_cancel(reader_thread);
+        pthread_join(reader_thread, NULL);
+    }
+
+    if(indev)
+    {
+        lv_display_remove_event_cb_with_user_data(lv_display_get_default(), render_ready_cb,
+                                                  NULL);
+        lv_indev_delete(indev);
+        indev = NULL;
+    }
+
+    if(evdev)
+    {
+        libevdev_free(evdev);
+        evdev = NULL;
+    }
+
+    if(dev_fd >= 0)
+    {
+        close(dev_fd);
+        dev_fd = -1;
+    }
+
+    if(wake_fd >= 0)
+    {
+        close(wake_fd);
+        wake_fd = -1;
+    }
+}
+
+/**
+ * Get the file descriptor that becomes readable when the touch state changed
+ */
+int evdev_touch_get_wake_fd(void)
+{
+    return wake_fd;
+}
+
+/**
+ * Feed a pending touch change to LVGL right away
+ */
+void evdev_touch_process(void)
+{
+    uint64_t count;
+    if(wake_fd < 0 || read(wake_fd, &count, sizeof(count)) != sizeof(count))
+        return;
+
+    indev_idle_wake(indev);
+}
+
+/**
+ * Get the latency statistics collected since the last reset
+ */
+void evdev_touch_get_stats(evdev_touch_stats_t* out, bool reset)
+{
+    *out = stats;
+
+    if(stats.samples > 0)
+    {
+        out->avg_latency_us = (float)latency_sum_us / stats.samples;
+    }
+
+    if(reset)
+    {
+        memset(&stats, 0, sizeof(stats));
+        latency_sum_us = 0;
+    }
+}
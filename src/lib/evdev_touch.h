@@ -0,0 +1,69 @@
+/*******************************************************************
+ *
+ * evdev_touch.h - Threaded evdev touchscreen input
+ *
+ ******************************************************************/
+#ifndef EVDEV_TOUCH_H
+#define EVDEV_TOUCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Touch-to-render latency statistics
+     * Measured from the kernel timestamp of a touch report to the end of the
+     * first frame rendered after LVGL has read it.
+     */
+    typedef struct
+    {
+        uint32_t samples;        // Number of measured touch reports
+        float    avg_latency_us; // Average latency
+        uint32_t max_latency_us; // Highest latency
+    } evdev_touch_stats_t;
+
+    /**
+     * Create a touchscreen input device read by a dedicated thread
+     * The thread blocks on the device and publishes the latest touch state,
+     * which the LVGL read callback picks up without locking.
+     * @param device evdev device node, e.g. "/dev/input/event0"
+     * @param hor_res horizontal display resolution to scale to
+     * @param ver_res vertical display resolution to scale to
+     * @return the LVGL input device, or NULL on failure
+     */
+    lv_indev_t* evdev_touch_create(const char* device, int32_t hor_res, int32_t ver_res);
+
+    /**
+     * Stop the reader thread and delete the input device
+     */
+    void evdev_touch_delete(void);
+
+    /**
+     * Get the file descriptor that becomes readable when the touch state changed
+     * @return eventfd to poll on, or -1 if no touch device is open
+     */
+    int evdev_touch_get_wake_fd(void);
+
+    /**
+     * Feed a pending touch change to LVGL right away (called in the main loop)
+     * Clears the wake fd and reads the input device outside the read timer period.
+     */
+    void evdev_touch_process(void);
+
+    /**
+     * Get the latency statistics collected since the last reset
+     * @param stats output structure
+     * @param reset true to start a new measurement interval
+     */
+    void evdev_touch_get_stats(evdev_touch_stats_t* stats, bool reset);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* EVDEV_TOUCH_H */
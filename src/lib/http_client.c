@@ -179,6 +179,13 @@ http_response_t http_get(const char* url, int timeout_seconds)
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
     response.status_code = (int)http_code;
 
+    // Time to the first byte, for the latency traces
+    curl_off_t first_byte_us = 0;
+    if(curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &first_byte_us) == CURLE_OK)
+    {
+        response.first_byte_us = (uint32_t)first_byte_us;
+    }
+
     // Check if it's a successful HTTP status
     response.success = (http_code >= 200 && http_code < 300);
 
@@ -3,16 +3,18 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * Response structure for HTTP requests
  */
 typedef struct
 {
-    int   status_code; // HTTP status code
-    char* body;        // Response body (dynamically allocated)
-    bool  success;     // Overall success of the request
-    char  error[256];  // Error message if request failed
+    int      status_code;   // HTTP status code
+    char*    body;          // Response body (dynamically allocated)
+    bool     success;       // Overall success of the request
+    char     error[256];    // Error message if request failed
+    uint32_t first_byte_us; // Time from the start of the request to the first response byte
 } http_response_t;
 
 /**
@@ -0,0 +1,43 @@
+/*******************************************************************
+ *
+ * indev_idle.c - Pause input device polling while idle
+ *
+ * LVGL polls every input device from a timer each refresh period,
+ * which keeps the main loop waking up even when nobody touches the
+ * screen. The drivers know when new input arrives, so the timer is
+ * paused while released and resumed from the driver's event path.
+ *
+ ******************************************************************/
+#include "indev_idle.h"
+
+/**
+ * Pause the read timer of an input device once it has nothing left to do
+ */
+void indev_idle_update(lv_indev_t* indev, const lv_indev_data_t* data)
+{
+    if(data->state == LV_INDEV_STATE_PRESSED || lv_indev_get_scroll_obj(indev) != NULL)
+        return;
+
+    lv_timer_t* timer = lv_indev_get_read_timer(indev);
+    if(timer)
+    {
+        lv_timer_pause(timer);
+    }
+}
+
+/**
+ * Resume polling and read an input device right away after new input arrived
+ */
+void indev_idle_wake(lv_indev_t* indev)
+{
+    if(!indev)
+        return;
+
+    lv_timer_t* timer = lv_indev_get_read_timer(indev);
+    if(timer)
+    {
+        lv_timer_resume(timer);
+    }
+
+    lv_indev_read(indev);
+}
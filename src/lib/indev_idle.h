@@ -0,0 +1,35 @@
+/*******************************************************************
+ *
+ * indev_idle.h - Pause input device polling while idle
+ *
+ ******************************************************************/
+#ifndef INDEV_IDLE_H
+#define INDEV_IDLE_H
+
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Pause the read timer of an input device once it has nothing left to do
+     * Call at the end of the read callback. The timer keeps running while the
+     * pointer is pressed or a scroll throw is still in progress.
+     * @param indev input device
+     * @param data state returned by the read callback
+     */
+    void indev_idle_update(lv_indev_t* indev, const lv_indev_data_t* data);
+
+    /**
+     * Resume polling and read an input device right away after new input arrived
+     * @param indev input device, NULL is ignored
+     */
+    void indev_idle_wake(lv_indev_t* indev);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* INDEV_IDLE_H */
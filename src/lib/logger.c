@@ -175,6 +175,16 @@ void logger_update_ui(lv_obj_t* log_container)
     static uint32_t  last_update_count           = 0;
     static uint32_t  last_update_index           = 0;
     static lv_obj_t* log_labels[MAX_LOG_ENTRIES] = {NULL};
+    static lv_obj_t* last_container              = NULL;
+
+    // A new container, e.g. after the logs tab was recreated, is populated from scratch
+    if(log_container != last_container)
+    {
+        last_update_count = 0;
+        last_update_index = 0;
+        memset(log_labels, 0, sizeof(log_labels));
+        last_container = log_container;
+    }
 
     // Get current log count
     uint32_t           current_count;
@@ -0,0 +1,457 @@
+/*******************************************************************
+ *
+ * lv_drm_disp.c - Native DRM/KMS display backend
+ *
+ * LVGL renders in direct mode into two dumb buffers that are mapped
+ * into our address space. Once a frame is complete the buffer is
+ * presented with a page flip on vblank, so there are no intermediate
+ * copies and no tearing.
+ *
+ ******************************************************************/
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include "lv_drm_disp.h"
+#include "lvgl/lvgl.h"
+#include "../lib/logger.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define DRM_BUFFER_COUNT 2
+#define DRM_FLIP_TIMEOUT_MS 100 // Give up waiting for a page flip after this time
+
+/*********************
+ *      TYPEDEFS
+ *********************/
+// Dumb buffer used as LVGL draw buffer and scanout framebuffer
+typedef struct
+{
+    uint32_t handle;
+    uint32_t fb_id;
+    uint32_t pitch;
+    uint64_t size;
+    uint8_t* map;
+} drm_buffer_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static int             drm_fd       = -1;
+static uint32_t        connector_id = 0;
+static uint32_t        crtc_id      = 0;
+static drmModeModeInfo mode;
+static drmModeCrtc*    saved_crtc = NULL;
+static drm_buffer_t    buffers[DRM_BUFFER_COUNT];
+static lv_display_t*   display      = NULL;
+static bool            flip_pending = false;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void drm_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
+static void drm_flush_wait(lv_display_t* disp);
+static void page_flip_handler(int fd, unsigned int frame, unsigned int sec, unsigned int usec,
+                              void* data);
+static int  find_output(int width, int height);
+static int  create_buffer(drm_buffer_t* buf, uint32_t width, uint32_t height, uint32_t bpp);
+static void destroy_buffer(drm_buffer_t* buf);
+
+static drmEventContext event_context = {
+    .version           = 2,
+    .page_flip_handler = page_flip_handler,
+};
+
+/**********************
+ *   DISPLAY FUNCTIONS
+ **********************/
+
+/**
+ * Display flush callback for LVGL
+ *
+ * In direct mode LVGL has already rendered into the mapped scanout buffer,
+ * so only the last flush of a frame needs to do anything: queue a page flip
+ * to that buffer. The flush is completed from the page flip event.
+ */
+static void drm_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map)
+{
+    LV_UNUSED(area);
+
+    if(!lv_display_flush_is_last(disp))
+    {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    drm_buffer_t* buf = NULL;
+    for(int i = 0; i < DRM_BUFFER_COUNT; i++)
+    {
+        if(buffers[i].map == px_map)
+        {
+            buf = &buffers[i];
+            break;
+        }
+    }
+
+    if(!buf)
+    {
+        log_error("DRM flush with unknown buffer %p", (void*)px_map);
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    if(drmModePageFlip(drm_fd, crtc_id, buf->fb_id, DRM_MODE_PAGE_FLIP_EVENT, NULL) == 0)
+    {
+        flip_pending = true;
+        return;
+    }
+
+    // Page flipping can fail while the CRTC is off, fall back to a synchronous mode set
+    if(drmModeSetCrtc(drm_fd, crtc_id, buf->fb_id, 0, 0, &connector_id, 1, &mode) != 0)
+    {
+        log_error("Failed to present DRM buffer: %s", strerror(errno));
+    }
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Block until the pending page flip has completed
+ * Called by LVGL before it renders into a buffer that may still be on screen.
+ */
+static void drm_flush_wait(lv_display_t* disp)
+{
+    while(flip_pending)
+    {
+        struct pollfd pfd = {.fd = drm_fd, .events = POLLIN};
+
+        int ret = poll(&pfd, 1, DRM_FLIP_TIMEOUT_MS);
+        if(ret > 0)
+        {
+            drmHandleEvent(drm_fd, &event_context);
+        }
+        else if(ret == 0 || errno != EINTR)
+        {
+            log_warning("Timeout waiting for DRM page flip");
+            flip_pending = false;
+            lv_display_flush_ready(disp);
+        }
+    }
+}
+
+/**
+ * Page flip completion handler, the flipped-out buffer may be reused now
+ */
+static void page_flip_handler(int fd, unsigned int frame, unsigned int sec, unsigned int usec,
+                              void* data)
+{
+    LV_UNUSED(fd);
+    LV_UNUSED(frame);
+    LV_UNUSED(sec);
+    LV_UNUSED(usec);
+    LV_UNUSED(data);
+
+    flip_pending = false;
+    lv_display_flush_ready(display);
+}
+
+/**
+ * Find a connected connector, a mode and a CRTC to drive it
+ * A mode matching width x height is preferred, otherwise the
+ * connector's preferred mode is used.
+ */
+static int find_output(int width, int height)
+{
+    drmModeRes* res = drmModeGetResources(drm_fd);
+    if(!res)
+    {
+        log_error("drmModeGetResources failed: %s", strerror(errno));
+        return -1;
+    }
+
+    drmModeConnector* conn = NULL;
+    for(int i = 0; i < res->count_connectors; i++)
+    {
+        conn = drmModeGetConnector(drm_fd, res->connectors[i]);
+        if(conn && conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0)
+        {
+            break;
+        }
+        drmModeFreeConnector(conn);
+        conn = NULL;
+    }
+
+    if(!conn)
+    {
+        log_error("No connected DRM connector found");
+        drmModeFreeResources(res);
+        return -1;
+    }
+
+    // Select the mode
+    int mode_index = 0;
+    for(int i = 0; i < conn->count_modes; i++)
+    {
+        if(conn->modes[i].hdisplay == width && conn->modes[i].vdisplay == height)
+        {
+            mode_index = i;
+            break;
+        }
+        if(conn->modes[i].type & DRM_MODE_TYPE_PREFERRED)
+        {
+            mode_index = i;
+        }
+    }
+    mode         = conn->modes[mode_index];
+    connector_id = conn->connector_id;
+
+    // Use the CRTC of the current encoder, or find one the encoders can drive
+    crtc_id = 0;
+    if(conn->encoder_id)
+    {
+        drmModeEncoder* enc = drmModeGetEncoder(drm_fd, conn->encoder_id);
+        if(enc)
+        {
+            crtc_id = enc->crtc_id;
+            drmModeFreeEncoder(enc);
+        }
+    }
+
+    for(int i = 0; i < conn->count_encoders && crtc_id == 0; i++)
+    {
+        drmModeEncoder* enc = drmModeGetEncoder(drm_fd, conn->encoders[i]);
+        if(!enc)
+            continue;
+
+        for(int j = 0; j < res->count_crtcs; j++)
+        {
+            if(enc->possible_crtcs & (1 << j))
+            {
+                crtc_id = res->crtcs[j];
+                break;
+            }
+        }
+        drmModeFreeEncoder(enc);
+    }
+
+    drmModeFreeConnector(conn);
+    drmModeFreeResources(res);
+
+    if(crtc_id == 0)
+    {
+        log_error("No CRTC available for connector %u", connector_id);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Create a dumb buffer, register it as framebuffer and map it
+ */
+static int create_buffer(drm_buffer_t* buf, uint32_t width, uint32_t height, uint32_t bpp)
+{
+    struct drm_mode_create_dumb create_req = {0};
+    create_req.width                       = width;
+    create_req.height                      = height;
+    create_req.bpp                         = bpp;
+
+    if(drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create_req) < 0)
+    {
+        log_error("Failed to create dumb buffer: %s", strerror(errno));
+        return -1;
+    }
+
+    buf->handle = create_req.handle;
+    buf->pitch  = create_req.pitch;
+    buf->size   = create_req.size;
+
+    uint8_t depth = (bpp == 32) ? 24 : 16;
+    if(drmModeAddFB(drm_fd, width, height, depth, bpp, buf->pitch, buf->handle, &buf->fb_id) != 0)
+    {
+        log_error("Failed to add framebuffer: %s", strerror(errno));
+        destroy_buffer(buf);
+        return -1;
+    }
+
+    struct drm_mode_map_dumb map_req = {0};
+    map_req.handle                   = buf->handle;
+
+    if(drmIoctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map_req) < 0)
+    {
+        log_error("Failed to prepare dumb buffer mapping: %s", strerror(errno));
+        destroy_buffer(buf);
+        return -1;
+    }
+
+    buf->map = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, map_req.offset);
+    if(buf->map == MAP_FAILED)
+    {
+        log_error("Failed to map dumb buffer: %s", strerror(errno));
+        buf->map = NULL;
+        destroy_buffer(buf);
+        return -1;
+    }
+
+    memset(buf->map, 0, buf->size);
+    return 0;
+}
+
+/**
+ * Unmap and release a dumb buffer
+ */
+static void destroy_buffer(drm_buffer_t* buf)
+{
+    if(buf->map)
+    {
+        munmap(buf->map, buf->size);
+        buf->map = NULL;
+    }
+
+    if(buf->fb_id)
+    {
+        drmModeRmFB(drm_fd, buf->fb_id);
+        buf->fb_id = 0;
+    }
+
+    if(buf->handle)
+    {
+        struct drm_mode_destroy_dumb destroy_req = {0};
+        destroy_req.handle                       = buf->handle;
+        drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy_req);
+        buf->handle = 0;
+    }
+}
+
+/**
+ * Initialize the native DRM/KMS display
+ */
+int lv_drm_disp_init(const char* device, int width, int height, lv_color_format_t color_format)
+{
+    drm_fd = open(device, O_RDWR | O_CLOEXEC);
+    if(drm_fd < 0)
+    {
+        log_error("Failed to open DRM device %s: %s", device, strerror(errno));
+        return -1;
+    }
+
+    if(find_output(width, height) != 0)
+    {
+        lv_drm_disp_deinit();
+        return -1;
+    }
+
+    log_info("DRM output: connector %u, CRTC %u, mode %s (%ux%u@%u)", connector_id, crtc_id,
+             mode.name, mode.hdisplay, mode.vdisplay, mode.vrefresh);
+
+    uint32_t bpp = (color_format == LV_COLOR_FORMAT_RGB565) ? 16 : 32;
+    for(int i = 0; i < DRM_BUFFER_COUNT; i++)
+    {
+        if(create_buffer(&buffers[i], mode.hdisplay, mode.vdisplay, bpp) != 0)
+        {
+            lv_drm_disp_deinit();
+            return -1;
+        }
+    }
+
+    // Remember the current CRTC configuration so it can be restored on exit
+    saved_crtc = drmModeGetCrtc(drm_fd, crtc_id);
+
+    // Scan out the second buffer, LVGL starts rendering into the first
+    if(drmModeSetCrtc(drm_fd, crtc_id, buffers[1].fb_id, 0, 0, &connector_id, 1, &mode) != 0)
+    {
+        log_error("Failed to set CRTC mode: %s", strerror(errno));
+        lv_drm_disp_deinit();
+        return -1;
+    }
+
+    display = lv_display_create(mode.hdisplay, mode.vdisplay);
+    if(!display)
+    {
+        log_error("Failed to create display");
+        lv_drm_disp_deinit();
+        return -1;
+    }
+
+    lv_display_set_color_format(display, (bpp == 32) ? LV_COLOR_FORMAT_XRGB8888
+                                                     : LV_COLOR_FORMAT_RGB565);
+
+    // Both scanout buffers are handed to LVGL, which keeps them in sync in direct mode
+    uint32_t buf_size = buffers[0].pitch * mode.vdisplay;
+    lv_display_set_buffers_with_stride(display, buffers[0].map, buffers[1].map, buf_size,
+                                       buffers[0].pitch, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(display, drm_flush);
+    lv_display_set_flush_wait_cb(display, drm_flush_wait);
+
+    return 0;
+}
+
+/**
+ * Clean up DRM display resources and restore the previous CRTC configuration
+ */
+void lv_drm_disp_deinit(void)
+{
+    if(drm_fd < 0)
+        return;
+
+    if(display)
+    {
+        drm_flush_wait(display);
+        lv_display_delete(display);
+        display = NULL;
+    }
+
+    if(saved_crtc)
+    {
+        drmModeSetCrtc(drm_fd, saved_crtc->crtc_id, saved_crtc->buffer_id, saved_crtc->x,
+                       saved_crtc->y, &connector_id, 1, &saved_crtc->mode);
+        drmModeFreeCrtc(saved_crtc);
+        saved_crtc = NULL;
+    }
+
+    for(int i = 0; i < DRM_BUFFER_COUNT; i++)
+    {
+        destroy_buffer(&buffers[i]);
+    }
+
+    close(drm_fd);
+    drm_fd = -1;
+}
+
+/**
+ * Get the connector the display is shown on
+ */
+uint32_t lv_drm_disp_get_connector_id(void)
+{
+    return connector_id;
+}
+
+/**
+ * Handle pending DRM events such as page flip completion
+ */
+void lv_drm_disp_handle_events(void)
+{
+    if(!flip_pending)
+        return;
+
+    struct pollfd pfd = {.fd = drm_fd, .events = POLLIN};
+    if(poll(&pfd, 1, 0) > 0)
+    {
+        drmHandleEvent(drm_fd, &event_context);
+    }
+}
+
+/**
+ * Get the DRM fd, readable when a page flip completed
+ */
+int lv_drm_disp_get_fd(void)
+{
+    return drm_fd;
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef LV_DRM_DISP_H
+#define LV_DRM_DISP_H
+
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Initialize the native DRM/KMS display
+     * LVGL renders directly into two mmap'd dumb buffers which are
+     * presented with page flips on vblank.
+     * @param device DRM device node, e.g. "/dev/dri/card0"
+     * @param width preferred width in pixels, the connector's preferred mode is used if no
+     * mode matches
+     * @param height preferred height in pixels
+     * @param color_format scanout format, LV_COLOR_FORMAT_XRGB8888 or LV_COLOR_FORMAT_RGB565
+     * @return 0 on success, -1 on failure
+     */
+    int lv_drm_disp_init(const char* device, int width, int height,
+                         lv_color_format_t color_format);
+    void lv_drm_disp_deinit(void);
+
+    /**
+     * Get the connector the display is shown on, for power management
+     * @return connector ID, or 0 if the display is not initialized
+     */
+    uint32_t lv_drm_disp_get_connector_id(void);
+
+    /**
+     * Handle pending DRM events such as page flip completion (called in the main loop)
+     */
+    void lv_drm_disp_handle_events(void);
+
+    /**
+     * Get the DRM fd, readable when a page flip completed
+     * @return file descriptor, or -1 if the display is not initialized
+     */
+    int lv_drm_disp_get_fd(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRM_DISP_H*/
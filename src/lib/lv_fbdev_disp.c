@@ -0,0 +1,96 @@
+/*******************************************************************
+ *
+ * lv_fbdev_disp.c - Linux framebuffer display backend
+ *
+ * Thin wrapper around LVGL's fbdev driver, which maps the
+ * framebuffer and renders into it in partial mode as configured
+ * in lv_conf.h. Adds blanking through FBIOBLANK.
+ *
+ ******************************************************************/
+#include "lvgl/lvgl.h"
+
+#if LV_USE_LINUX_FBDEV
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/fb.h>
+
+#include "lv_fbdev_disp.h"
+#include "../lib/logger.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_display_t* display  = NULL;
+static int           blank_fd = -1;
+
+/**
+ * Initialize the Linux framebuffer display
+ */
+int lv_fbdev_disp_init(const char* device)
+{
+    // Separate fd for blanking, LVGL's driver keeps its own fd private
+    blank_fd = open(device, O_RDWR | O_CLOEXEC);
+    if(blank_fd < 0)
+    {
+        log_error("Failed to open framebuffer %s: %s", device, strerror(errno));
+        return -1;
+    }
+
+    display = lv_linux_fbdev_create();
+    if(!display)
+    {
+        log_error("Failed to create fbdev display");
+        lv_fbdev_disp_deinit();
+        return -1;
+    }
+
+    lv_linux_fbdev_set_file(display, device);
+
+    log_info("Framebuffer output: %s (%dx%d)", device,
+             (int)lv_display_get_horizontal_resolution(display),
+             (int)lv_display_get_vertical_resolution(display));
+
+    return 0;
+}
+
+/**
+ * Clean up framebuffer display resources
+ */
+void lv_fbdev_disp_deinit(void)
+{
+    if(display)
+    {
+        lv_display_delete(display);
+        display = NULL;
+    }
+
+    if(blank_fd >= 0)
+    {
+        close(blank_fd);
+        blank_fd = -1;
+    }
+}
+
+/**
+ * Blank the framebuffer display
+ */
+int lv_fbdev_disp_blank(int blank)
+{
+    if(blank_fd < 0)
+        return -1;
+
+    if(ioctl(blank_fd, FBIOBLANK, blank ? FB_BLANK_POWERDOWN : FB_BLANK_UNBLANK) != 0)
+    {
+        log_error("Failed to %s framebuffer: %s", blank ? "blank" : "unblank", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+#endif /*LV_USE_LINUX_FBDEV*/
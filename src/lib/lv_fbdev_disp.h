@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef LV_FBDEV_DISP_H
+#define LV_FBDEV_DISP_H
+
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Initialize the Linux framebuffer display
+     * LVGL renders in partial mode and copies the rendered areas into the
+     * mmap'd framebuffer, without SDL in between.
+     * @param device framebuffer device node, e.g. "/dev/fb0"
+     * @return 0 on success, -1 on failure
+     */
+    int  lv_fbdev_disp_init(const char* device);
+    void lv_fbdev_disp_deinit(void);
+
+    /**
+     * Blank the framebuffer display
+     * @param blank 1 to blank (turn off), 0 to unblank (turn on)
+     * @return 0 on success, -1 on failure
+     */
+    int lv_fbdev_disp_blank(int blank);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FBDEV_DISP_H*/
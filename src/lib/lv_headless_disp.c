@@ -0,0 +1,80 @@
+/*******************************************************************
+ *
+ * lv_headless_disp.c - Headless display backend
+ *
+ * Renders into memory without any output device, for benchmarks
+ * and CI runs on machines without a display.
+ *
+ ******************************************************************/
+#include <stdlib.h>
+
+#include "lv_headless_disp.h"
+#include "../lib/logger.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_display_t* display    = NULL;
+static uint8_t*      frame      = NULL;
+static uint32_t      frame_size = 0;
+
+/**
+ * Flush callback, the frame stays in the render buffer
+ */
+static void headless_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map)
+{
+    (void)area;
+    (void)px_map;
+
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Initialize a headless display rendering into memory
+ */
+int lv_headless_disp_init(int width, int height, lv_color_format_t color_format)
+{
+    frame_size = width * height * lv_color_format_get_size(color_format);
+    frame      = malloc(frame_size);
+    if(!frame)
+    {
+        log_error("Failed to allocate %u bytes for the headless display", frame_size);
+        return -1;
+    }
+
+    display = lv_display_create(width, height);
+    lv_display_set_color_format(display, color_format);
+    lv_display_set_flush_cb(display, headless_flush);
+    lv_display_set_buffers(display, frame, NULL, frame_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+
+    log_info("Headless output: %dx%d, %u bytes per frame", width, height, frame_size);
+    return 0;
+}
+
+/**
+ * Clean up the headless display
+ */
+void lv_headless_disp_deinit(void)
+{
+    if(display)
+    {
+        lv_display_delete(display);
+        display = NULL;
+    }
+
+    free(frame);
+    frame      = NULL;
+    frame_size = 0;
+}
+
+/**
+ * Get the rendered frame
+ */
+const uint8_t* lv_headless_disp_get_frame(uint32_t* size)
+{
+    if(size)
+    {
+        *size = frame_size;
+    }
+    return frame;
+}
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef LV_HEADLESS_DISP_H
+#define LV_HEADLESS_DISP_H
+
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Initialize a headless display rendering into memory
+     * LVGL renders in direct mode into a single full-screen buffer, so after
+     * each refresh the buffer holds the complete frame.
+     * @param width width in pixels
+     * @param height height in pixels
+     * @param color_format render format, e.g. LV_COLOR_FORMAT_XRGB8888 or LV_COLOR_FORMAT_RGB565
+     * @return 0 on success, -1 on failure
+     */
+    int  lv_headless_disp_init(int width, int height, lv_color_format_t color_format);
+    void lv_headless_disp_deinit(void);
+
+    /**
+     * Get the rendered frame
+     * @param size output for the frame size in bytes, may be NULL
+     * @return frame buffer, or NULL if the display is not initialized
+     */
+    const uint8_t* lv_headless_disp_get_frame(uint32_t* size);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_HEADLESS_DISP_H*/
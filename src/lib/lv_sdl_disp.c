@@ -1,3 +1,7 @@
+#include "lvgl/lvgl.h"
+
+#if LV_USE_SDL
+
 #include <assert.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -7,12 +11,10 @@
 #include <errno.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_syswm.h>
-#include <xf86drm.h>
-#include <xf86drmMode.h>
-#include <drm/drm_mode.h>
 
 #include "lv_sdl_disp.h"
-#include "lvgl/lvgl.h"
+#include "color_convert.h"
+#include "indev_idle.h"
 #include "../ui/ui.h"
 #include "../lib/logger.h"
 #include "../lib/mem_debug.h"
@@ -39,21 +41,28 @@ typedef struct
  *  STATIC VARIABLES
  **********************/
 static void *        fb1, *fb2;
+static uint8_t*      fb_dither = NULL; // RGB565 staging buffer for dithered output
 SDL_Window*          window   = NULL;
 SDL_Renderer*        renderer = NULL;
 SDL_Texture*         texture  = NULL;
 static lv_display_t* display  = NULL;
 static int           DISPLAY_WIDTH;
 static int           DISPLAY_HEIGHT;
-static touch_data_t  touch_data = {0};
+static uint32_t      render_px_size  = 4; // Bytes per pixel LVGL renders
+static uint32_t      texture_px_size = 4; // Bytes per pixel of the SDL texture
+static touch_data_t  touch_data      = {0};
+static lv_indev_t*   mouse_indev     = NULL;
+static lv_indev_t*   touch_indev     = NULL;
+
+// Flush statistics, accumulated until read with lv_port_disp_get_stats()
+static lv_port_disp_stats_t flush_stats         = {0};
+static uint32_t             frame_flush_count   = 0;
+static uint64_t             present_time_sum_us = 0;
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 static void     disp_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
-static int      get_sdl_drm_fd(SDL_Window* window);
-static uint32_t find_dpms_property_id(int drm_fd, drmModeConnector* conn);
-static int      drm_set_dpms(int drm_fd, drmModeConnector* conn, int off);
 static void     sdl_mouse_read(lv_indev_t* indev, lv_indev_data_t* data);
 static void     sdl_touch_read(lv_indev_t* indev, lv_indev_data_t* data);
 static void     printWMInfo(SDL_Window* window);
@@ -64,6 +73,15 @@ static void     printWMInfo(SDL_Window* window);
 
 /**
  * Display flush callback for LVGL
+ *
+ * The display runs in direct mode: fb1 and fb2 are full-frame front and back
+ * buffers and px_map points to the start of the buffer LVGL rendered into.
+ * Only the dirty area is uploaded to the streaming texture, so the upload
+ * bandwidth is proportional to what changed. The texture is copied to the
+ * renderer and presented once per frame, on the last flush of the refresh.
+ *
+ * With dithering enabled LVGL renders XRGB8888 and the dirty area is
+ * converted to the RGB565 texture format with an ordered dither first.
  */
 static void disp_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map)
 {
@@ -73,25 +91,96 @@ static void disp_flush(lv_display_t* disp, const lv_area_t* area, uint8_t* px_ma
     r.w = area->x2 - area->x1 + 1;
     r.h = area->y2 - area->y1 + 1;
 
-    lv_color_t* color_p = (lv_color_t*)px_map;
+    uint32_t stride = DISPLAY_WIDTH * render_px_size;
+
+    if(fb_dither)
+    {
+        uint32_t dither_stride = DISPLAY_WIDTH * texture_px_size;
+
+        color_convert_xrgb8888_to_rgb565_dither(px_map, stride, fb_dither, dither_stride, r.x,
+                                                r.y, r.w, r.h);
+        SDL_UpdateTexture(texture, &r, fb_dither + r.y * dither_stride + r.x * texture_px_size,
+                          dither_stride);
+    }
+    else
+    {
+        SDL_UpdateTexture(texture, &r, px_map + r.y * stride + r.x * render_px_size, stride);
+    }
+
+    frame_flush_count++;
+    flush_stats.uploaded_bytes += (uint64_t)r.w * r.h * texture_px_size;
+
+    if(lv_display_flush_is_last(disp))
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        SDL_RenderPresent(renderer);
+
+        uint32_t present_us = (uint32_t)((SDL_GetPerformanceCounter() - start) * 1000000 /
+                                         SDL_GetPerformanceFrequency());
+
+        // Update the per-frame statistics
+        flush_stats.frames++;
+        flush_stats.flushes += frame_flush_count;
+        if(frame_flush_count > flush_stats.max_flushes_per_frame)
+        {
+            flush_stats.max_flushes_per_frame = frame_flush_count;
+        }
+        present_time_sum_us += present_us;
+        if(present_us > flush_stats.max_present_us)
+        {
+            flush_stats.max_present_us = present_us;
+        }
+        frame_flush_count = 0;
+    }
 
-    SDL_UpdateTexture(texture, &r, color_p, r.w * ((LV_COLOR_DEPTH + 7) / 8));
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_RenderPresent(renderer);
     lv_display_flush_ready(disp);
 }
 
+/**
+ * Get the flush statistics collected since the last reset
+ * @param stats output structure
+ * @param reset true to start a new measurement interval
+ */
+void lv_port_disp_get_stats(lv_port_disp_stats_t* stats, bool reset)
+{
+    *stats = flush_stats;
+
+    if(flush_stats.frames > 0)
+    {
+        stats->avg_flushes_per_frame = (float)flush_stats.flushes / flush_stats.frames;
+        stats->avg_present_us        = (float)present_time_sum_us / flush_stats.frames;
+        stats->avg_upload_bytes      = (float)flush_stats.uploaded_bytes / flush_stats.frames;
+    }
+
+    if(reset)
+    {
+        memset(&flush_stats, 0, sizeof(flush_stats));
+        present_time_sum_us = 0;
+    }
+}
+
 /**
  * Initialize the SDL display
  * @param width display width in pixels
  * @param height display height in pixels
+ * @param color_format output format, LV_COLOR_FORMAT_ARGB8888 or LV_COLOR_FORMAT_RGB565
+ * @param dither render XRGB8888 and dither it down to RGB565 (RGB565 output only)
  */
-void lv_port_disp_init(int width, int height)
+void lv_port_disp_init(int width, int height, lv_color_format_t color_format, bool dither)
 {
-    assert(LV_COLOR_DEPTH == 16 || LV_COLOR_DEPTH == 32);
+    assert(color_format == LV_COLOR_FORMAT_ARGB8888 || color_format == LV_COLOR_FORMAT_RGB565);
     DISPLAY_WIDTH  = width;
     DISPLAY_HEIGHT = height;
 
+    bool is_rgb565 = (color_format == LV_COLOR_FORMAT_RGB565);
+    dither         = dither && is_rgb565;
+
+    lv_color_format_t render_format = dither ? LV_COLOR_FORMAT_XRGB8888 : color_format;
+    render_px_size                  = lv_color_format_get_size(render_format);
+    texture_px_size                 = lv_color_format_get_size(color_format);
+
     if(SDL_InitSubSystem(SDL_INIT_VIDEO) != 0)
     {
         fprintf(stderr, "SDL_InitSubSystem failed: %s\n", SDL_GetError());
@@ -111,7 +200,7 @@ void lv_port_disp_init(int width, int height)
     }
 
     texture = SDL_CreateTexture(
-        renderer, (LV_COLOR_DEPTH == 32) ? (SDL_PIXELFORMAT_ARGB8888) : (SDL_PIXELFORMAT_RGB565),
+        renderer, is_rgb565 ? (SDL_PIXELFORMAT_RGB565) : (SDL_PIXELFORMAT_ARGB8888),
         SDL_TEXTUREACCESS_STREAMING, DISPLAY_WIDTH, DISPLAY_HEIGHT);
     if(!texture)
     {
@@ -119,8 +208,8 @@ void lv_port_disp_init(int width, int height)
         exit(1);
     }
 
-    // Calculate the buffer size in bytes
-    size_t buf_size = DISPLAY_WIDTH * DISPLAY_HEIGHT * ((LV_COLOR_DEPTH + 7) / 8);
+    // Calculate the buffer size in bytes, RGB565 halves it
+    size_t buf_size = DISPLAY_WIDTH * DISPLAY_HEIGHT * render_px_size;
 
     // Allocate the frame buffers using memory wrappers
     fb1 = mem_malloc(buf_size);
@@ -132,6 +221,16 @@ void lv_port_disp_init(int width, int height)
         exit(1);
     }
 
+    if(dither)
+    {
+        fb_dither = mem_malloc(DISPLAY_WIDTH * DISPLAY_HEIGHT * texture_px_size);
+        if(!fb_dither)
+        {
+            fprintf(stderr, "Failed to allocate dither buffer\n");
+            exit(1);
+        }
+    }
+
     // Create a display
     display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
     if(!display)
@@ -140,21 +239,18 @@ void lv_port_disp_init(int width, int height)
         exit(1);
     }
 
-    // Set up buffers for the display
-    lv_display_set_buffers(display, fb1, fb2, buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    // Set up fb1 and fb2 as front and back buffers. In direct mode with two buffers LVGL
+    // copies the areas invalidated in the last frame to the other buffer after each swap.
+    lv_display_set_buffers(display, fb1, fb2, buf_size, LV_DISPLAY_RENDER_MODE_DIRECT);
 
     // Set the flush callback
     lv_display_set_flush_cb(display, disp_flush);
 
     // Set color format
-    if(LV_COLOR_DEPTH == 32)
-    {
-        lv_display_set_color_format(display, LV_COLOR_FORMAT_ARGB8888);
-    }
-    else
-    {
-        lv_display_set_color_format(display, LV_COLOR_FORMAT_RGB565);
-    }
+    lv_display_set_color_format(display, render_format);
+
+    log_info("SDL display: %dx%d, %s%s, %u bytes per frame buffer", DISPLAY_WIDTH, DISPLAY_HEIGHT,
+             is_rgb565 ? "RGB565" : "ARGB8888", dither ? " (dithered)" : "", (unsigned)buf_size);
 }
 
 /**
@@ -174,6 +270,12 @@ void lv_port_disp_deinit(void)
         fb2 = NULL;
     }
 
+    if(fb_dither)
+    {
+        mem_free(fb_dither);
+        fb_dither = NULL;
+    }
+
     if(texture)
     {
         SDL_DestroyTexture(texture);
@@ -244,15 +346,15 @@ static void printWMInfo(SDL_Window* window)
 }
 
 /**
- * Get the KMS/DRM file descriptor from SDL's window
+ * Get the KMS/DRM file descriptor SDL uses for its window
  * Must be called after SDL_CreateWindow(...).
  */
-static int get_sdl_drm_fd(SDL_Window* window)
+int lv_sdl_get_drm_fd(void)
 {
     SDL_SysWMinfo wmInfo;
     SDL_VERSION(&wmInfo.version);
 
-    if(!SDL_GetWindowWMInfo(window, &wmInfo))
+    if(!window || !SDL_GetWindowWMInfo(window, &wmInfo))
     {
         log_error("SDL_GetWindowWMInfo failed: %s", SDL_GetError());
         return -1;
@@ -260,7 +362,7 @@ static int get_sdl_drm_fd(SDL_Window* window)
 
     if(wmInfo.subsystem != SDL_SYSWM_KMSDRM)
     {
-        log_error("SDL is not using KMSDRM backend.");
+        log_info("SDL is not using the KMSDRM backend, display power control disabled");
         return -1;
     }
 
@@ -268,112 +370,6 @@ static int get_sdl_drm_fd(SDL_Window* window)
     return wmInfo.info.kmsdrm.drm_fd;
 }
 
-/**
- * Find the DPMS property ID for a given connector
- */
-static uint32_t find_dpms_property_id(int drm_fd, drmModeConnector* conn)
-{
-    drmModeObjectProperties* props =
-        drmModeObjectGetProperties(drm_fd, conn->connector_id, DRM_MODE_OBJECT_CONNECTOR);
-    if(!props)
-    {
-        log_error("drmModeObjectGetProperties failed: %s", strerror(errno));
-        return 0;
-    }
-
-    // Search properties for "DPMS"
-    uint32_t dpms_prop_id = 0;
-    for(uint32_t i = 0; i < props->count_props; i++)
-    {
-        drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
-        if(prop)
-        {
-            if(strcmp(prop->name, "DPMS") == 0)
-            {
-                dpms_prop_id = prop->prop_id;
-                drmModeFreeProperty(prop);
-                break;
-            }
-            drmModeFreeProperty(prop);
-        }
-    }
-
-    drmModeFreeObjectProperties(props);
-    return dpms_prop_id;
-}
-
-/**
- * Blank/unblank the connector by setting DPMS
- * drm_fd : already-open DRM file descriptor (from SDL)
- * off    : 1 to blank, 0 to unblank
- * returns 0 on success, -1 on failure
- */
-static int drm_set_dpms(int drm_fd, drmModeConnector* conn, int off)
-{
-    uint32_t dpms_prop_id = find_dpms_property_id(drm_fd, conn);
-    if(dpms_prop_id == 0)
-    {
-        log_error("DPMS property not found on connector %u", conn->connector_id);
-        return -1;
-    }
-
-    // DRM_MODE_DPMS_OFF == 3, DRM_MODE_DPMS_ON == 0
-    uint64_t dpms_val = off ? 3 : 0;
-    int      ret = drmModeConnectorSetProperty(drm_fd, conn->connector_id, dpms_prop_id, dpms_val);
-    if(ret != 0)
-    {
-        log_error("Failed to set DPMS property to %s on connector %u: %s (err=%d)",
-                  off ? "OFF" : "ON", conn->connector_id, strerror(errno), ret);
-        return -1;
-    }
-    return 0;
-}
-
-/**
- * Blank the display using the same DRM file descriptor SDL is using.
- * @param window SDL window to get DRM fd from
- * @param blank 1 to blank (turn off), 0 to unblank (turn on)
- * @return 0 on success, -1 on failure
- */
-int drm_blank_display(SDL_Window* window, int blank)
-{
-    int drm_fd = get_sdl_drm_fd(window);
-    if(drm_fd < 0)
-    {
-        return -1;
-    }
-
-    drmModeRes* res = drmModeGetResources(drm_fd);
-    if(!res)
-    {
-        log_error("drmModeGetResources failed: %s", strerror(errno));
-        return -1;
-    }
-
-    int i;
-    int rv = -1;
-    // Try all connectors
-    for(i = 0; i < res->count_connectors; i++)
-    {
-        drmModeConnector* conn = drmModeGetConnector(drm_fd, res->connectors[i]);
-        if(!conn)
-            continue;
-
-        if(conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0)
-        {
-            // Found an active connector, set DPMS
-            if(drm_set_dpms(drm_fd, conn, blank) == 0)
-            {
-                rv = 0;
-            }
-        }
-        drmModeFreeConnector(conn);
-    }
-
-    drmModeFreeResources(res);
-    return rv;
-}
-
 /**********************
  *   INPUT FUNCTIONS
  **********************/
@@ -389,6 +385,8 @@ static void sdl_mouse_read(lv_indev_t* indev, lv_indev_data_t* data)
     data->point.x = x;
     data->point.y = y;
     data->state   = (buttons & SDL_BUTTON(1)) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    indev_idle_update(indev, data);
 }
 
 /**
@@ -397,7 +395,7 @@ static void sdl_mouse_read(lv_indev_t* indev, lv_indev_data_t* data)
  */
 lv_indev_t* lv_sdl_mouse_create(void)
 {
-    lv_indev_t* mouse_indev = lv_indev_create();
+    mouse_indev = lv_indev_create();
     if(mouse_indev == NULL)
         return NULL;
 
@@ -415,6 +413,8 @@ static void sdl_touch_read(lv_indev_t* indev, lv_indev_data_t* data)
     data->point.x = touch_data.last_x;
     data->point.y = touch_data.last_y;
     data->state   = touch_data.touched ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    indev_idle_update(indev, data);
 }
 
 /**
@@ -426,7 +426,7 @@ lv_indev_t* lv_sdl_touch_create(void)
     // Initialize SDL touch subsystem if needed
     SDL_InitSubSystem(SDL_INIT_EVENTS);
 
-    lv_indev_t* touch_indev = lv_indev_create();
+    touch_indev = lv_indev_create();
     if(touch_indev == NULL)
         return NULL;
 
@@ -441,6 +441,9 @@ lv_indev_t* lv_sdl_touch_create(void)
  */
 void lv_sdl_handle_events(void)
 {
+    bool mouse_event = false;
+    bool touch_event = false;
+
     SDL_Event event;
     while(SDL_PollEvent(&event))
     {
@@ -452,15 +455,24 @@ void lv_sdl_handle_events(void)
                 touch_data.touched = true;
                 touch_data.last_x  = event.tfinger.x * DISPLAY_WIDTH;
                 touch_data.last_y  = event.tfinger.y * DISPLAY_HEIGHT;
+                touch_event        = true;
                 break;
 
-            case SDL_FINGERUP: touch_data.touched = false; break;
+            case SDL_FINGERUP:
+                touch_data.touched = false;
+                touch_event        = true;
+                break;
 
             case SDL_FINGERMOTION:
                 touch_data.last_x = event.tfinger.x * DISPLAY_WIDTH;
                 touch_data.last_y = event.tfinger.y * DISPLAY_HEIGHT;
+                touch_event       = true;
                 break;
 
+            case SDL_MOUSEMOTION:
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP: mouse_event = true; break;
+
             default: break;
         }
 
@@ -485,4 +497,34 @@ void lv_sdl_handle_events(void)
             }
         }
     }
-}
\ No newline at end of file
+
+    // Input devices are not polled while idle, pass new input on right away
+    if(mouse_event)
+    {
+        indev_idle_wake(mouse_indev);
+    }
+    if(touch_event)
+    {
+        indev_idle_wake(touch_indev);
+    }
+}
+
+/**
+ * Wait until an SDL event is pending or the timeout expires
+ */
+void lv_sdl_wait_events(uint32_t timeout_ms)
+{
+    // Passing NULL leaves the event in the queue for lv_sdl_handle_events()
+    SDL_WaitEventTimeout(NULL, (int)timeout_ms);
+}
+
+/**
+ * Wake up lv_sdl_wait_events() from another thread
+ */
+void lv_sdl_wakeup(void)
+{
+    SDL_Event event = {.type = SDL_USEREVENT};
+    SDL_PushEvent(&event);
+}
+
+#endif /*LV_USE_SDL*/
@@ -4,6 +4,9 @@
 #define LV_SDL_DISP_H
 
 #include "lvgl/lvgl.h"
+
+#if LV_USE_SDL
+
 #include <SDL2/SDL.h>
 
 #ifdef __cplusplus
@@ -11,6 +14,21 @@ extern "C"
 {
 #endif
 
+    /**
+     * Flush statistics of the SDL display
+     */
+    typedef struct
+    {
+        uint32_t frames;                // Number of presented frames
+        uint32_t flushes;               // Number of flushed areas
+        uint32_t max_flushes_per_frame; // Highest number of areas flushed in one frame
+        float    avg_flushes_per_frame; // Average number of areas flushed per frame
+        float    avg_present_us;        // Average time spent copying and presenting a frame
+        uint32_t max_present_us;        // Longest time spent copying and presenting a frame
+        uint64_t uploaded_bytes;        // Bytes uploaded to the texture
+        float    avg_upload_bytes;      // Average bytes uploaded to the texture per frame
+    } lv_port_disp_stats_t;
+
     extern SDL_Window*   window;
     extern SDL_Renderer* renderer;
     extern SDL_Texture*  texture;
@@ -19,11 +37,24 @@ extern "C"
      * Initialize the SDL display
      * @param width display width in pixels
      * @param height display height in pixels
+     * @param color_format output format, LV_COLOR_FORMAT_ARGB8888 or LV_COLOR_FORMAT_RGB565
+     * @param dither render XRGB8888 and dither it down to RGB565 (RGB565 output only)
      */
-    void lv_port_disp_init(int width, int height);
+    void lv_port_disp_init(int width, int height, lv_color_format_t color_format, bool dither);
     void lv_port_disp_deinit(void);
 
-    int drm_blank_display(SDL_Window* window, int blank);
+    /**
+     * Get the flush statistics collected since the last reset
+     * @param stats output structure
+     * @param reset true to start a new measurement interval
+     */
+    void lv_port_disp_get_stats(lv_port_disp_stats_t* stats, bool reset);
+
+    /**
+     * Get the DRM file descriptor SDL uses under the KMS/DRM video driver
+     * @return file descriptor, or -1 if SDL runs on another video driver
+     */
+    int lv_sdl_get_drm_fd(void);
 
     /**
      * Create an SDL mouse input device
@@ -44,8 +75,21 @@ extern "C"
      */
     void lv_sdl_handle_events(void);
 
+    /**
+     * Wait until an SDL event is pending or the timeout expires
+     * @param timeout_ms maximum time to wait in milliseconds
+     */
+    void lv_sdl_wait_events(uint32_t timeout_ms);
+
+    /**
+     * Wake up lv_sdl_wait_events() from another thread
+     */
+    void lv_sdl_wakeup(void);
+
 #ifdef __cplusplus
 } /*extern "C"*/
 #endif
 
+#endif /*LV_USE_SDL*/
+
 #endif /*LV_SDL_DISP_H*/
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*******************************************************************
+ *
+ * proc_stats.c - Process resource statistics from /proc
+ *
+ ******************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "proc_stats.h"
+#include "logger.h"
+
+/**
+ * Get the time since the process was started by the kernel
+ * This includes loading and relocating shared libraries, which
+ * is not visible from main().
+ */
+static uint32_t read_ms_since_exec(void)
+{
+    double uptime_s = 0;
+    FILE*  fp       = fopen("/proc/uptime", "r");
+    if(!fp)
+        return 0;
+
+    if(fscanf(fp, "%lf", &uptime_s) != 1)
+    {
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+
+    fp = fopen("/proc/self/stat", "r");
+    if(!fp)
+        return 0;
+
+    char line[1024];
+    if(!fgets(line, sizeof(line), fp))
+    {
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+
+    // The command name may contain spaces, fields are counted from the closing parenthesis
+    char* p = strrchr(line, ')');
+    if(!p)
+        return 0;
+
+    // starttime is field 22, the field after ')' is field 3
+    unsigned long long start_ticks = 0;
+    int                field       = 3;
+    for(p = strtok(p + 1, " "); p; p = strtok(NULL, " "), field++)
+    {
+        if(field == 22)
+        {
+            sscanf(p, "%llu", &start_ticks);
+            break;
+        }
+    }
+
+    double start_s = (double)start_ticks / sysconf(_SC_CLK_TCK);
+    return (uptime_s > start_s) ? (uint32_t)((uptime_s - start_s) * 1000.0) : 0;
+}
+
+/**
+ * Sum the voluntary context switches of all threads
+ * /proc/self/status only counts the main thread, helper threads waking up
+ * periodically are only visible per task.
+ */
+static uint32_t read_process_ctxt(void)
+{
+    DIR* dir = opendir("/proc/self/task");
+    if(!dir)
+        return 0;
+
+    uint32_t       total = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL)
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%s/status", entry->d_name);
+
+        FILE* fp = fopen(path, "r");
+        if(!fp)
+            continue;
+
+        char     line[128];
+        uint32_t ctxt;
+        while(fgets(line, sizeof(line), fp))
+        {
+            if(sscanf(line, "voluntary_ctxt_switches: %u", &ctxt) == 1)
+            {
+                total += ctxt;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    closedir(dir);
+
+    return total;
+}
+
+/**
+ * Read resource usage of the running process
+ */
+int proc_stats_read(proc_stats_t* stats)
+{
+    memset(stats, 0, sizeof(proc_stats_t));
+
+    FILE* fp = fopen("/proc/self/status", "r");
+    if(!fp)
+    {
+        log_error("Failed to open /proc/self/status");
+        return -1;
+    }
+
+    char line[128];
+    while(fgets(line, sizeof(line), fp))
+    {
+        if(sscanf(line, "VmRSS: %u", &stats->rss_kb) == 1)
+            continue;
+        if(sscanf(line, "VmHWM: %u", &stats->rss_peak_kb) == 1)
+            continue;
+        if(sscanf(line, "voluntary_ctxt_switches: %u", &stats->voluntary_ctxt) == 1)
+            continue;
+        sscanf(line, "nonvoluntary_ctxt_switches: %u", &stats->nonvoluntary_ctxt);
+    }
+    fclose(fp);
+
+    stats->ms_since_exec = read_ms_since_exec();
+    stats->process_ctxt  = read_process_ctxt();
+    return 0;
+}
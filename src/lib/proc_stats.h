@@ -0,0 +1,31 @@
+/*******************************************************************
+ *
+ * proc_stats.h - Process resource statistics from /proc
+ *
+ ******************************************************************/
+#ifndef PROC_STATS_H
+#define PROC_STATS_H
+
+#include <stdint.h>
+
+/**
+ * Resource usage of the running process
+ */
+typedef struct
+{
+    uint32_t rss_kb;            // Current resident set size
+    uint32_t rss_peak_kb;       // Peak resident set size
+    uint32_t voluntary_ctxt;    // Voluntary context switches (sleeps/wakeups)
+    uint32_t nonvoluntary_ctxt; // Involuntary context switches (preemptions)
+    uint32_t process_ctxt;      // Voluntary context switches summed over all threads
+    uint32_t ms_since_exec;     // Time since the process was started by the kernel
+} proc_stats_t;
+
+/**
+ * Read resource usage of the running process
+ * @param stats output structure
+ * @return 0 on success, -1 on failure
+ */
+int proc_stats_read(proc_stats_t* stats);
+
+#endif /* PROC_STATS_H */
@@ -0,0 +1,531 @@
+/*******************************************************************
+ *
+ * render_stats.c - Render loop instrumentation
+ *
+ * Frame, render and flush times and the dirty area per frame are
+ * measured from LVGL's display events, so every backend is covered
+ * without touching the flush callbacks. Timer callbacks created with
+ * render_stats_timer_create() run through a trampoline that records
+ * their run time under a name.
+ *
+ * The exported histograms count since startup. The overlay and the
+ * summary log each get a window of the same histograms that is
+ * cleared when they report, so they show the current behaviour.
+ *
+ ******************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "render_stats.h"
+#include "logger.h"
+#include "../main.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MAX_TIMERS 16     /* Maximum number of instrumented timer callbacks */
+#define MAX_HISTOGRAMS 48 /* Maximum number of histograms registered by other modules */
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    lv_timer_cb_t      cb;
+    render_histogram_t time_us;
+} timer_entry_t;
+
+typedef struct
+{
+    render_histogram_t* hist;
+    const char*         label;
+} histogram_entry_t;
+
+/**
+ * Statistics since a consumer last reported
+ */
+typedef struct
+{
+    render_histogram_t frame;
+    render_histogram_t render;
+    render_histogram_t flush;
+    render_histogram_t dirty;
+    render_histogram_t timers[MAX_TIMERS]; // Same order as timer_entries
+} render_window_t;
+
+typedef enum
+{
+    WINDOW_OVERLAY = 0,
+    WINDOW_SUMMARY,
+    WINDOW_COUNT
+} render_window_id_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+// Microseconds, from well below a frame up to several missed frames
+static const uint32_t time_bounds_us[RENDER_STATS_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2000, 4000, 8000, 16000, 33000, 66000, 133000};
+
+// Per mille of the screen area
+static const uint32_t dirty_bounds_pm[RENDER_STATS_BUCKETS - 1] = {
+    5, 10, 20, 50, 100, 200, 300, 500, 700, 900, 1000};
+
+static render_histogram_t frame_hist  = {.name = "frame_time_us", .bounds = time_bounds_us};
+static render_histogram_t render_hist = {.name = "render_time_us", .bounds = time_bounds_us};
+static render_histogram_t flush_hist  = {.name = "flush_time_us", .bounds = time_bounds_us};
+static render_histogram_t dirty_hist  = {.name = "dirty_area_permille", .bounds = dirty_bounds_pm};
+
+static timer_entry_t timer_entries[MAX_TIMERS];
+static uint32_t      timer_entry_count = 0;
+
+static histogram_entry_t histogram_entries[MAX_HISTOGRAMS];
+static uint32_t          histogram_entry_count = 0;
+
+static render_window_t windows[WINDOW_COUNT];
+
+static lv_display_t* display     = NULL;
+static const char*   export_file = NULL;
+
+// State of the frame being refreshed
+static bool     frame_rendered;
+static uint64_t frame_start_ns;
+static uint64_t render_start_ns;
+static uint64_t flush_start_ns;
+static uint64_t frame_flush_ns;
+static uint64_t frame_dirty_px;
+
+// Overlay
+static lv_obj_t*   overlay_label = NULL;
+static lv_timer_t* overlay_timer = NULL;
+
+/**
+ * Get the current CLOCK_MONOTONIC time in nanoseconds
+ */
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Add a sample to a histogram
+ */
+void render_stats_histogram_add(render_histogram_t* hist, uint32_t value)
+{
+    uint32_t i = 0;
+    while(i < RENDER_STATS_BUCKETS - 1 && value > hist->bounds[i])
+    {
+        i++;
+    }
+
+    hist->counts[i]++;
+    hist->samples++;
+    hist->sum += value;
+    if(value > hist->max)
+    {
+        hist->max = value;
+    }
+}
+
+/**
+ * Add a sample to a cumulative histogram and to its counterpart in every window
+ * @param offset offset of the counterpart in render_window_t
+ */
+static void record(render_histogram_t* total, size_t offset, uint32_t value)
+{
+    render_stats_histogram_add(total, value);
+    for(int w = 0; w < WINDOW_COUNT; w++)
+    {
+        render_stats_histogram_add((render_histogram_t*)((char*)&windows[w] + offset), value);
+    }
+}
+
+/**
+ * Get the average of a histogram
+ */
+static float histogram_avg(const render_histogram_t* hist)
+{
+    return hist->samples ? (float)hist->sum / hist->samples : 0.0f;
+}
+
+/**
+ * Estimate a percentile as the upper bound of the bucket it falls in
+ */
+static uint32_t histogram_percentile(const render_histogram_t* hist, uint32_t percent)
+{
+    uint64_t target = ((uint64_t)hist->samples * percent + 99) / 100;
+    uint64_t count  = 0;
+
+    for(uint32_t i = 0; i < RENDER_STATS_BUCKETS - 1; i++)
+    {
+        count += hist->counts[i];
+        if(count >= target && count > 0)
+            return LV_MIN(hist->bounds[i], hist->max);
+    }
+    return hist->max;
+}
+
+/**
+ * Write one histogram with an optional label in Prometheus text format
+ */
+static void histogram_write(FILE* fp, const render_histogram_t* hist, const char* label)
+{
+    const char* sep        = label ? "," : "";
+    uint64_t    cumulative = 0;
+
+    label = label ? label : "";
+
+    for(uint32_t i = 0; i < RENDER_STATS_BUCKETS - 1; i++)
+    {
+        cumulative += hist->counts[i];
+        fprintf(fp, "camper_%s_bucket{%s%sle=\"%u\"} %llu\n", hist->name, label, sep,
+                hist->bounds[i], (unsigned long long)cumulative);
+    }
+    fprintf(fp, "camper_%s_bucket{%s%sle=\"+Inf\"} %u\n", hist->name, label, sep, hist->samples);
+
+    fprintf(fp, "camper_%s_sum{%s} %llu\n", hist->name, label, (unsigned long long)hist->sum);
+    fprintf(fp, "camper_%s_count{%s} %u\n", hist->name, label, hist->samples);
+}
+
+/**
+ * Display event callback, follows each refresh through render and flush
+ */
+static void display_event_cb(lv_event_t* e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    uint64_t        now  = monotonic_ns();
+
+    switch(code)
+    {
+        case LV_EVENT_REFR_START:
+            frame_start_ns = now;
+            frame_rendered = false;
+            frame_flush_ns = 0;
+            frame_dirty_px = 0;
+            break;
+
+        case LV_EVENT_RENDER_START:
+            render_start_ns = now;
+            frame_rendered  = true;
+            break;
+
+        case LV_EVENT_FLUSH_START:
+        {
+            flush_start_ns        = now;
+            const lv_area_t* area = lv_event_get_param(e);
+            if(area)
+            {
+                frame_dirty_px += lv_area_get_size(area);
+            }
+            break;
+        }
+
+        case LV_EVENT_FLUSH_FINISH: frame_flush_ns += now - flush_start_ns; break;
+
+        case LV_EVENT_RENDER_READY:
+        {
+            // Render time excludes the flushes that happen in between
+            uint64_t render_ns = now - render_start_ns;
+            render_ns          = render_ns > frame_flush_ns ? render_ns - frame_flush_ns : 0;
+            record(&render_hist, offsetof(render_window_t, render), (uint32_t)(render_ns / 1000));
+            break;
+        }
+
+        case LV_EVENT_REFR_READY:
+        {
+            // Refreshes without invalid areas are not frames
+            if(!frame_rendered)
+                break;
+
+            uint64_t screen_px = (uint64_t)lv_display_get_horizontal_resolution(display) *
+                                 lv_display_get_vertical_resolution(display);
+
+            record(&frame_hist, offsetof(render_window_t, frame),
+                   (uint32_t)((now - frame_start_ns) / 1000));
+            record(&flush_hist, offsetof(render_window_t, flush),
+                   (uint32_t)(frame_flush_ns / 1000));
+            record(&dirty_hist, offsetof(render_window_t, dirty),
+                   (uint32_t)(frame_dirty_px * 1000 / screen_px));
+            break;
+        }
+
+        default: break;
+    }
+}
+
+/**
+ * Timer trampoline, runs the instrumented callback and records its run time
+ */
+static void timer_trampoline(lv_timer_t* timer)
+{
+    timer_entry_t* entry = lv_timer_get_user_data(timer);
+    uint64_t       start = monotonic_ns();
+
+    entry->cb(timer);
+
+    size_t offset = offsetof(render_window_t, timers) +
+                    (size_t)(entry - timer_entries) * sizeof(render_histogram_t);
+    record(&entry->time_us, offset, (uint32_t)((monotonic_ns() - start) / 1000));
+}
+
+/**
+ * Create an LVGL timer whose callback run time is recorded per name
+ */
+lv_timer_t* render_stats_timer_create(lv_timer_cb_t cb, uint32_t period, const char* name)
+{
+    timer_entry_t* entry = NULL;
+
+    // Recreated timers continue with their previous statistics
+    for(uint32_t i = 0; i < timer_entry_count; i++)
+    {
+        if(timer_entries[i].cb == cb)
+        {
+            entry = &timer_entries[i];
+            break;
+        }
+    }
+
+    if(!entry)
+    {
+        if(timer_entry_count >= MAX_TIMERS)
+        {
+            log_warning("Too many instrumented timers, %s is not measured", name);
+            return lv_timer_create(cb, period, NULL);
+        }
+
+        entry                 = &timer_entries[timer_entry_count];
+        entry->cb             = cb;
+        entry->time_us.name   = name;
+        entry->time_us.bounds = time_bounds_us;
+
+        for(int w = 0; w < WINDOW_COUNT; w++)
+        {
+            windows[w].timers[timer_entry_count] = entry->time_us;
+        }
+        timer_entry_count++;
+    }
+
+    return lv_timer_create(timer_trampoline, period, entry);
+}
+
+/**
+ * Include a histogram of another module in the export
+ */
+void render_stats_register_histogram(render_histogram_t* hist, const char* label)
+{
+    if(histogram_entry_count >= MAX_HISTOGRAMS)
+    {
+        log_warning("Too many registered histograms, %s {%s} is not exported", hist->name,
+                    label ? label : "");
+        return;
+    }
+
+    histogram_entries[histogram_entry_count].hist  = hist;
+    histogram_entries[histogram_entry_count].label = label;
+    histogram_entry_count++;
+}
+
+/**
+ * Clear a histogram, keeping its name and bounds
+ */
+static void histogram_clear(render_histogram_t* hist)
+{
+    memset(hist->counts, 0, sizeof(hist->counts));
+    hist->samples = 0;
+    hist->sum     = 0;
+    hist->max     = 0;
+}
+
+/**
+ * Start a new interval of a window
+ */
+static void window_clear(render_window_t* window)
+{
+    histogram_clear(&window->frame);
+    histogram_clear(&window->render);
+    histogram_clear(&window->flush);
+    histogram_clear(&window->dirty);
+
+    for(uint32_t i = 0; i < timer_entry_count; i++)
+    {
+        histogram_clear(&window->timers[i]);
+    }
+}
+
+/**
+ * Find the timer with the highest total run time in a window
+ */
+static const render_histogram_t* busiest_timer(const render_window_t* window)
+{
+    const render_histogram_t* busiest = NULL;
+
+    for(uint32_t i = 0; i < timer_entry_count; i++)
+    {
+        if(!busiest || window->timers[i].sum > busiest->sum)
+        {
+            busiest = &window->timers[i];
+        }
+    }
+    return busiest;
+}
+
+/**
+ * Overlay timer callback, shows the statistics of the last interval
+ */
+static void overlay_timer_cb(lv_timer_t* timer)
+{
+    (void)timer;
+
+    render_window_t*          window  = &windows[WINDOW_OVERLAY];
+    const render_histogram_t* busiest = busiest_timer(window);
+
+    lv_label_set_text_fmt(overlay_label,
+                          "%u fps  frame %.1f/%.1f ms\n"
+                          "render %.1f  flush %.1f ms  dirty %.1f%%\n"
+                          "timer %s %.1f ms",
+                          window->frame.samples * 1000 / RENDER_STATS_OVERLAY_INTERVAL_MS,
+                          histogram_avg(&window->frame) / 1000.0f,
+                          histogram_percentile(&window->frame, 95) / 1000.0f,
+                          histogram_avg(&window->render) / 1000.0f,
+                          histogram_avg(&window->flush) / 1000.0f,
+                          histogram_avg(&window->dirty) / 10.0f, busiest ? busiest->name : "-",
+                          busiest ? histogram_avg(busiest) / 1000.0f : 0.0f);
+    window_clear(window);
+}
+
+/**
+ * Show or hide the on-screen statistics overlay
+ */
+void render_stats_overlay_show(bool show)
+{
+    if(show && !overlay_label)
+    {
+        overlay_label = lv_label_create(lv_layer_top());
+        lv_obj_set_style_text_font(overlay_label, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_color(overlay_label, lv_color_white(), 0);
+        lv_obj_set_style_bg_color(overlay_label, lv_color_black(), 0);
+        lv_obj_set_style_bg_opa(overlay_label, LV_OPA_70, 0);
+        lv_obj_set_style_pad_all(overlay_label, 4, 0);
+        lv_obj_align(overlay_label, LV_ALIGN_BOTTOM_RIGHT, 0, 0);
+        lv_label_set_text(overlay_label, "");
+
+        window_clear(&windows[WINDOW_OVERLAY]);
+        overlay_timer = lv_timer_create(overlay_timer_cb, RENDER_STATS_OVERLAY_INTERVAL_MS, NULL);
+    }
+    else if(!show && overlay_label)
+    {
+        lv_timer_delete(overlay_timer);
+        lv_obj_delete(overlay_label);
+        overlay_timer = NULL;
+        overlay_label = NULL;
+    }
+}
+
+/**
+ * Log a one-line summary of the statistics since the last summary
+ */
+void render_stats_log_summary(void)
+{
+    render_window_t*          window  = &windows[WINDOW_SUMMARY];
+    const render_histogram_t* busiest = busiest_timer(window);
+
+    log_info("Render: %u frames, frame %.1f ms (p95 %.1f, max %.1f), render %.1f ms, "
+             "flush %.1f ms, dirty %.1f%%, busiest timer %s %.1f ms (max %.1f)",
+             window->frame.samples, histogram_avg(&window->frame) / 1000.0f,
+             histogram_percentile(&window->frame, 95) / 1000.0f, window->frame.max / 1000.0f,
+             histogram_avg(&window->render) / 1000.0f, histogram_avg(&window->flush) / 1000.0f,
+             histogram_avg(&window->dirty) / 10.0f, busiest ? busiest->name : "-",
+             busiest ? histogram_avg(busiest) / 1000.0f : 0.0f,
+             busiest ? busiest->max / 1000.0f : 0.0f);
+    window_clear(window);
+}
+
+/**
+ * Write all histograms in Prometheus text format
+ */
+int render_stats_export(const char* path)
+{
+    char tmp_path[256];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE* fp = fopen(tmp_path, "w");
+    if(!fp)
+    {
+        log_error("Failed to open %s: %s", tmp_path, strerror(errno));
+        return -1;
+    }
+
+    histogram_write(fp, &frame_hist, NULL);
+    histogram_write(fp, &render_hist, NULL);
+    histogram_write(fp, &flush_hist, NULL);
+    histogram_write(fp, &dirty_hist, NULL);
+
+    for(uint32_t i = 0; i < timer_entry_count; i++)
+    {
+        render_histogram_t timer_hist = timer_entries[i].time_us;
+        char               label[48];
+
+        snprintf(label, sizeof(label), "timer=\"%s\"", timer_hist.name);
+        timer_hist.name = "timer_time_us";
+        histogram_write(fp, &timer_hist, label);
+    }
+
+    for(uint32_t i = 0; i < histogram_entry_count; i++)
+    {
+        histogram_write(fp, histogram_entries[i].hist, histogram_entries[i].label);
+    }
+
+    if(fclose(fp) != 0 || rename(tmp_path, path) != 0)
+    {
+        log_error("Failed to write %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Periodic report timer callback
+ */
+static void report_timer_cb(lv_timer_t* timer)
+{
+    (void)timer;
+
+    render_stats_log_summary();
+
+    if(export_file)
+    {
+        render_stats_export(export_file);
+    }
+}
+
+/**
+ * Start collecting frame, render, flush and dirty area statistics for a display
+ */
+void render_stats_init(lv_display_t* disp, const char* export_path)
+{
+    display     = disp;
+    export_file = export_path;
+
+    for(int w = 0; w < WINDOW_COUNT; w++)
+    {
+        windows[w].frame  = frame_hist;
+        windows[w].render = render_hist;
+        windows[w].flush  = flush_hist;
+        windows[w].dirty  = dirty_hist;
+    }
+
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_READY, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_REFR_READY, NULL);
+
+    lv_timer_create(report_timer_cb, RENDER_STATS_REPORT_INTERVAL_MS, NULL);
+}
@@ -0,0 +1,89 @@
+/*******************************************************************
+ *
+ * render_stats.h - Render loop instrumentation
+ *
+ ******************************************************************/
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define RENDER_STATS_BUCKETS 12 /* Histogram buckets, the last one is unbounded */
+
+    /**
+     * Histogram of a measured quantity
+     */
+    typedef struct
+    {
+        const char*     name;   // Metric name used in the export
+        const uint32_t* bounds; // Upper bounds of the first RENDER_STATS_BUCKETS - 1 buckets
+        uint32_t        counts[RENDER_STATS_BUCKETS];
+        uint32_t        samples;
+        uint64_t        sum;
+        uint32_t        max;
+    } render_histogram_t;
+
+    /**
+     * Start collecting frame, render, flush and dirty area statistics for a display
+     * Statistics are always collected, the overhead is a few clock reads per frame.
+     * @param disp display to instrument
+     * @param export_path file to write the histograms to periodically, NULL to only log a
+     * summary
+     */
+    void render_stats_init(lv_display_t* disp, const char* export_path);
+
+    /**
+     * Add a sample to a histogram
+     * @param hist histogram, not thread safe, only add from the UI thread
+     * @param value sample in the unit of the histogram bounds
+     */
+    void render_stats_histogram_add(render_histogram_t* hist, uint32_t value);
+
+    /**
+     * Include a histogram of another module in the export
+     * Histograms sharing a name are told apart by their label.
+     * @param hist histogram, must stay valid
+     * @param label Prometheus label pairs such as "sensor=\"camper\"", NULL for none
+     */
+    void render_stats_register_histogram(render_histogram_t* hist, const char* label);
+
+    /**
+     * Create an LVGL timer whose callback run time is recorded per name
+     * Drop-in replacement for lv_timer_create() for timers without user data.
+     * @param cb timer callback
+     * @param period timer period in milliseconds
+     * @param name name used in the statistics
+     * @return the created timer
+     */
+    lv_timer_t* render_stats_timer_create(lv_timer_cb_t cb, uint32_t period, const char* name);
+
+    /**
+     * Show or hide the on-screen statistics overlay
+     * @param show true to show the overlay on the top layer
+     */
+    void render_stats_overlay_show(bool show);
+
+    /**
+     * Log a one-line summary of the statistics since the last summary
+     */
+    void render_stats_log_summary(void);
+
+    /**
+     * Write all histograms in Prometheus text format
+     * @param path output file, replaced atomically
+     * @return 0 on success, -1 on failure
+     */
+    int render_stats_export(const char* path);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* RENDER_STATS_H */
@@ -1,208 +1,497 @@
-#include "wifi.h"
+/*******************************************************************
+ *
+ * wifi.c - Wi-Fi status monitoring for Camper GUI on Raspberry Pi
+ *
+ * A monitor thread keeps a cached status up to date without starting
+ * any process: the wireless interfaces and their signal level come
+ * from /proc/net/wireless, the SSID from an nl80211 query and the IPv4
+ * address from getifaddrs(). An rtnetlink socket wakes the thread on
+ * link and address changes, the signal level is refreshed every
+ * WIFI_SIGNAL_POLL_MS. Reading the status only copies the cache.
+ * While paused the thread only drains link events until it is resumed.
+ *
+ ******************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
 #include <unistd.h>
-#include <ctype.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/genetlink.h>
+#include <linux/nl80211.h>
+
+#include "wifi.h"
 #include "logger.h"
+#include "../main.h"
 
-static wifi_status_t current_status;
-static bool          initialized = false;
+/**********************
+ *      DEFINES
+ **********************/
+#define WIRELESS_PROC_FILE "/proc/net/wireless"
+#define NETLINK_BUFFER_SIZE 8192
+#define MONITOR_CMD_WAKE 'w' // Written to the wake pipe to re-read monitor_paused
+#define MONITOR_CMD_STOP 's' // Written to the wake pipe to stop the monitor thread
 
-// Initialize Wi-Fi monitoring
-void wifi_init(void)
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static wifi_status_t   current_status;
+static uint32_t        status_generation = 0; // Bumped when the cached status changed
+static pthread_mutex_t status_mutex      = PTHREAD_MUTEX_INITIALIZER;
+static bool            initialized       = false;
+static bool            monitor_paused    = false; // Protected by status_mutex
+
+static pthread_t monitor_thread;
+static bool      thread_started = false;
+static int       wake_pipe[2]   = {-1, -1}; // MONITOR_CMD_* to the monitor thread
+
+// Monitor thread only, after wifi_init()
+static int      link_fd        = -1; // rtnetlink link and address events
+static int      genl_fd        = -1; // nl80211 queries
+static uint16_t nl80211_family = 0;  // 0 when cfg80211 is not available
+static uint32_t genl_seq       = 0;
+
+/**
+ * Convert a signal level in dBm to a percentage
+ * -50 dBm or greater is ~100%, -100 dBm or less is ~0%
+ */
+static int signal_percentage(int dbm)
 {
-    memset(&current_status, 0, sizeof(wifi_status_t));
-    current_status.wifi_connected = false;
-    strcpy(current_status.wifi_ssid, "");
-    current_status.wifi_signal_strength = 0;
-    strcpy(current_status.wifi_ip_address, "");
+    if(dbm >= -50)
+        return 100;
+    if(dbm <= -100)
+        return 0;
+    return 2 * (dbm + 100); // Linear mapping from -100..-50 to 0..100
+}
 
-    // Perform initial update
-    wifi_update();
+/**
+ * Add an attribute to a netlink message, the buffer must have room for it
+ */
+static void add_attr(struct nlmsghdr* nlh, uint16_t type, const void* data, uint16_t len)
+{
+    struct nlattr* attr = (struct nlattr*)((char*)nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+    attr->nla_type      = type;
+    attr->nla_len       = NLA_HDRLEN + len;
+    memcpy((char*)attr + NLA_HDRLEN, data, len);
+    nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + NLA_ALIGN(attr->nla_len);
+}
 
-    initialized = true;
+/**
+ * Find an attribute in the reply to a generic netlink request
+ * @return attribute, NULL if the reply does not have it
+ */
+static const struct nlattr* find_attr(const struct nlmsghdr* nlh, uint16_t type)
+{
+    const char*          data = (const char*)NLMSG_DATA(nlh) + GENL_HDRLEN;
+    const struct nlattr* attr = (const struct nlattr*)data;
+    int                  rem  = (int)nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+
+    while(rem >= NLA_HDRLEN && attr->nla_len >= NLA_HDRLEN && attr->nla_len <= rem)
+    {
+        if((attr->nla_type & NLA_TYPE_MASK) == type)
+            return attr;
+
+        rem -= NLA_ALIGN(attr->nla_len);
+        attr = (const struct nlattr*)((const char*)attr + NLA_ALIGN(attr->nla_len));
+    }
+    return NULL;
 }
 
-// Parse signal strength from iwconfig output (value in dBm)
-static int parse_signal_strength(const char* output)
+/**
+ * Send a generic netlink request with one attribute and receive the reply
+ * @return reply message in buffer, NULL on error
+ */
+static const struct nlmsghdr* genl_request(uint16_t family, uint8_t cmd, uint16_t attr_type,
+                                           const void* data, uint16_t len, char* buffer,
+                                           size_t buffer_size)
 {
-    char* signal_level = strstr(output, "Signal level=");
-    if(signal_level)
+    struct
     {
-        int dbm = 0;
-        if(sscanf(signal_level + 13, "%d", &dbm) == 1)
-        {
-            // Convert dBm to percentage (approximation)
-            // -50 dBm or greater is ~100%, -100 dBm or less is ~0%
-            if(dbm >= -50)
-                return 100;
-            if(dbm <= -100)
-                return 0;
-            return 2 * (dbm + 100); // Linear mapping from -100..-50 to 0..100
-        }
+        struct nlmsghdr   nlh;
+        struct genlmsghdr genl;
+        char              attrs[64];
+    } request;
+
+    memset(&request, 0, sizeof(request));
+    request.nlh.nlmsg_len   = NLMSG_LENGTH(GENL_HDRLEN);
+    request.nlh.nlmsg_type  = family;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST;
+    request.nlh.nlmsg_seq   = ++genl_seq;
+    request.genl.cmd        = cmd;
+    request.genl.version    = 1;
+    add_attr(&request.nlh, attr_type, data, len);
+
+    if(send(genl_fd, &request, request.nlh.nlmsg_len, 0) < 0)
+        return NULL;
+
+    // Skip replies to earlier requests that timed out
+    while(true)
+    {
+        ssize_t received = recv(genl_fd, buffer, buffer_size, 0);
+        if(received < (ssize_t)NLMSG_HDRLEN)
+            return NULL;
+
+        const struct nlmsghdr* nlh = (const struct nlmsghdr*)buffer;
+        if(!NLMSG_OK(nlh, received))
+            return NULL;
+        if(nlh->nlmsg_seq != genl_seq)
+            continue;
+        if(nlh->nlmsg_type == NLMSG_ERROR)
+            return NULL;
+        return nlh;
     }
-    return 0;
 }
 
-// Parse IP address from ip addr output
-static void parse_ip_address(const char* interface, char* ip_addr, size_t max_len)
+/**
+ * Open the nl80211 socket and resolve the nl80211 family
+ */
+static void nl80211_init(void)
 {
-    if(!interface || strlen(interface) == 0)
+    genl_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if(genl_fd < 0)
     {
-        strncpy(ip_addr, "", max_len);
+        log_warning("Failed to open generic netlink socket: %s", strerror(errno));
         return;
     }
 
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd),
-             "ip addr show dev %s | grep -w inet | awk '{print $2}' | cut -d/ -f1", interface);
+    // Replies come right away, never let a lost one block the monitor thread
+    struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+    setsockopt(genl_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
 
-    FILE* fp = popen(cmd, "r");
-    if(fp)
+    char                   buffer[NETLINK_BUFFER_SIZE];
+    const struct nlmsghdr* reply =
+        genl_request(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, CTRL_ATTR_FAMILY_NAME, NL80211_GENL_NAME,
+                     sizeof(NL80211_GENL_NAME), buffer, sizeof(buffer));
+    const struct nlattr* attr = reply ? find_attr(reply, CTRL_ATTR_FAMILY_ID) : NULL;
+    if(attr == NULL)
     {
-        char buffer[32] = {0};
-        if(fgets(buffer, sizeof(buffer) - 1, fp) != NULL)
-        {
-            // Remove trailing newline if present
-            size_t len = strlen(buffer);
-            if(len > 0 && buffer[len - 1] == '\n')
-            {
-                buffer[len - 1] = '\0';
-            }
-            strncpy(ip_addr, buffer, max_len - 1);
-        }
-        else
+        log_info("nl80211 not available, no Wi-Fi status");
+        return;
+    }
+
+    memcpy(&nl80211_family, (const char*)attr + NLA_HDRLEN, sizeof(nl80211_family));
+}
+
+/**
+ * Get the SSID of the network an interface is connected to
+ * @return false if the interface is not connected
+ */
+static bool read_ssid(const char* interface, char* ssid, size_t ssid_size)
+{
+    uint32_t ifindex = if_nametoindex(interface);
+    if(nl80211_family == 0 || ifindex == 0)
+        return false;
+
+    char                   buffer[NETLINK_BUFFER_SIZE];
+    const struct nlmsghdr* reply =
+        genl_request(nl80211_family, NL80211_CMD_GET_INTERFACE, NL80211_ATTR_IFINDEX, &ifindex,
+                     sizeof(ifindex), buffer, sizeof(buffer));
+    const struct nlattr* attr = reply ? find_attr(reply, NL80211_ATTR_SSID) : NULL;
+    if(attr == NULL)
+        return false;
+
+    // The SSID is not NUL terminated
+    size_t len = attr->nla_len - NLA_HDRLEN;
+    if(len == 0)
+        return false;
+    if(len >= ssid_size)
+        len = ssid_size - 1;
+    memcpy(ssid, (const char*)attr + NLA_HDRLEN, len);
+    ssid[len] = '\0';
+    return true;
+}
+
+/**
+ * Get the IPv4 address of an interface
+ */
+static void read_ip_address(const char* interface, char* ip_addr, size_t max_len)
+{
+    ip_addr[0] = '\0';
+
+    struct ifaddrs* addrs;
+    if(getifaddrs(&addrs) != 0)
+        return;
+
+    for(struct ifaddrs* ifa = addrs; ifa != NULL; ifa = ifa->ifa_next)
+    {
+        if(ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET &&
+           strcmp(ifa->ifa_name, interface) == 0)
         {
-            strncpy(ip_addr, "", max_len);
+            inet_ntop(AF_INET, &((struct sockaddr_in*)ifa->ifa_addr)->sin_addr, ip_addr, max_len);
+            break;
         }
-        pclose(fp);
     }
-    else
+    freeifaddrs(addrs);
+}
+
+/**
+ * Read the status of the first connected wireless interface
+ */
+static void read_status(wifi_status_t* status)
+{
+    memset(status, 0, sizeof(*status));
+
+    FILE* fp = fopen(WIRELESS_PROC_FILE, "r");
+    if(!fp)
+        return;
+
+    // Two header lines, then one line per wireless interface:
+    // " wlan0: 0000   70.  -40.  -256   0   0   0   0   0   0"
+    char line[256];
+    int  line_number = 0;
+    while(fgets(line, sizeof(line), fp) != NULL)
     {
-        strncpy(ip_addr, "", max_len);
+        if(++line_number <= 2)
+            continue;
+
+        char  interface[IF_NAMESIZE];
+        float level;
+        if(sscanf(line, " %15[^:]: %*x %*f %f", interface, &level) != 2)
+            continue;
+
+        if(!read_ssid(interface, status->wifi_ssid, sizeof(status->wifi_ssid)))
+            continue;
+
+        // Older drivers report the level as an unsigned byte
+        int dbm = (int)level;
+        if(dbm > 0)
+            dbm -= 256;
+
+        status->wifi_connected       = true;
+        status->wifi_signal_strength = signal_percentage(dbm);
+        read_ip_address(interface, status->wifi_ip_address, sizeof(status->wifi_ip_address));
+        break;
     }
+    fclose(fp);
 }
 
-// Get the current Wi-Fi status
-wifi_status_t wifi_get_status(void)
+/**
+ * Read the status and publish it to the cache
+ */
+static void refresh_status(void)
 {
-    if(!initialized)
+    wifi_status_t status;
+    read_status(&status);
+
+    pthread_mutex_lock(&status_mutex);
+    bool changed = status.wifi_connected != current_status.wifi_connected ||
+                   strcmp(status.wifi_ssid, current_status.wifi_ssid) != 0 ||
+                   strcmp(status.wifi_ip_address, current_status.wifi_ip_address) != 0;
+    if(changed || status.wifi_signal_strength != current_status.wifi_signal_strength)
     {
-        wifi_init();
+        status_generation++;
+    }
+    current_status = status;
+    pthread_mutex_unlock(&status_mutex);
+
+    if(changed)
+    {
+        if(status.wifi_connected)
+            log_info("Wi-Fi connected to %s, address %s", status.wifi_ssid,
+                     status.wifi_ip_address[0] ? status.wifi_ip_address : "none");
+        else
+            log_info("Wi-Fi not connected");
+    }
+}
+
+/**
+ * Open the rtnetlink socket that reports link and IPv4 address changes
+ */
+static void link_events_init(void)
+{
+    link_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if(link_fd < 0)
+    {
+        log_warning("Failed to open rtnetlink socket: %s", strerror(errno));
+        return;
+    }
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+    if(bind(link_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        log_warning("Failed to subscribe to link events: %s", strerror(errno));
+        close(link_fd);
+        link_fd = -1;
     }
-    return current_status;
 }
 
-// Update Wi-Fi status
-void wifi_update(void)
+/**
+ * Read all pending link events, they only trigger a refresh
+ */
+static void drain_link_events(void)
 {
-    FILE* fp;
-    char  output[2048]; // Larger buffer to hold multiple interfaces
-    bool  connected             = false;
-    char  ssid[64]              = "";
-    int   signal_strength       = 0;
-    char  current_interface[32] = "";
+    char buffer[NETLINK_BUFFER_SIZE];
+    while(recv(link_fd, buffer, sizeof(buffer), 0) > 0)
+        ; // The events are not parsed, they only trigger a refresh
+}
 
-    // Run iwconfig without specifying adapter to get all wireless interfaces
-    fp = popen("iwconfig 2>/dev/null", "r");
-    if(fp)
+/**
+ * Check if the monitor is paused
+ */
+static bool is_paused(void)
+{
+    pthread_mutex_lock(&status_mutex);
+    bool paused = monitor_paused;
+    pthread_mutex_unlock(&status_mutex);
+    return paused;
+}
+
+/**
+ * Send a command to the monitor thread
+ */
+static void send_command(char cmd)
+{
+    if(write(wake_pipe[1], &cmd, 1) != 1)
     {
-        char*  buffer    = output;
-        size_t remaining = sizeof(output) - 1;
-        size_t bytes_read;
+        log_error("Failed to wake Wi-Fi monitor thread");
+    }
+}
 
-        // Read all output from iwconfig command
-        while((bytes_read = fread(buffer, 1, remaining, fp)) > 0)
-        {
-            buffer += bytes_read;
-            remaining -= bytes_read;
+/**
+ * Monitor thread, refreshes on link events and every WIFI_SIGNAL_POLL_MS
+ */
+static void* monitor_thread_cb(void* arg)
+{
+    (void)arg;
 
-            if(remaining <= 0)
-                break;
-        }
-        *buffer = '\0'; // Null terminate the string
-        pclose(fp);
+    // The nl80211 lookup blocks for up to a second, so it stays off the UI thread
+    nl80211_init();
+    if(!is_paused())
+        refresh_status();
 
-        // Split output by interface (blank lines typically separate interfaces)
-        char* interface_entry    = strtok(output, "\n");
-        char  interface_name[32] = "";
+    struct pollfd fds[2] = {
+        {.fd = wake_pipe[0], .events = POLLIN},
+        {.fd = link_fd, .events = POLLIN}, // Ignored by poll() when -1
+    };
 
-        while(interface_entry && !connected)
+    while(true)
+    {
+        // While paused only link events and commands wake the thread
+        int rc = poll(fds, 2, is_paused() ? -1 : WIFI_SIGNAL_POLL_MS);
+        if(rc < 0 && errno != EINTR)
         {
-            // A new interface entry typically starts with the interface name
-            if(isalpha(interface_entry[0]) && strchr(interface_entry, ' '))
-            {
-                // Extract interface name (first word before space)
-                sscanf(interface_entry, "%31s", interface_name);
-            }
-
-            // Check if this line contains ESSID information
-            if(strstr(interface_entry, "ESSID:\""))
-            {
-                char* essid = strstr(interface_entry, "ESSID:\"");
-                if(essid && strcmp(essid + 7, "off/any\"") != 0 && strlen(interface_name) > 0)
-                {
-                    // Found a connected interface
-                    connected = true;
-                    strncpy(current_interface, interface_name, sizeof(current_interface) - 1);
-
-                    // Extract SSID
-                    essid += 7; // Skip "ESSID:\""
-                    char* end = strchr(essid, '"');
-                    if(end)
-                    {
-                        *end = '\0';
-                        strncpy(ssid, essid, sizeof(ssid) - 1);
-                    }
-                }
-            }
-
-            // Check for signal level on the same interface we found ESSID for
-            if(connected && strstr(interface_entry, "Signal level=") &&
-               (strlen(interface_name) == 0 || strcmp(interface_name, current_interface) == 0))
-            {
-                signal_strength = parse_signal_strength(interface_entry);
-            }
-
-            interface_entry = strtok(NULL, "\n");
+            log_error("Wi-Fi monitor poll failed: %s", strerror(errno));
+            break;
         }
 
-        // If we found a connected interface but no signal strength yet, get it separately
-        if(connected && signal_strength == 0 && strlen(current_interface) > 0)
+        if(fds[0].revents & POLLIN)
         {
-            char cmd[128];
-            snprintf(cmd, sizeof(cmd), "iwconfig %s 2>/dev/null | grep 'Signal level'",
-                     current_interface);
-
-            FILE* fp2 = popen(cmd, "r");
-            if(fp2)
-            {
-                if(fgets(output, sizeof(output), fp2) != NULL)
-                {
-                    signal_strength = parse_signal_strength(output);
-                }
-                pclose(fp2);
-            }
+            char cmd;
+            if(read(wake_pipe[0], &cmd, 1) != 1 || cmd == MONITOR_CMD_STOP)
+                break;
         }
+
+        if(fds[1].revents & POLLIN)
+            drain_link_events();
+
+        // Resuming refreshes right away, link changes while paused are picked up then
+        if(!is_paused())
+            refresh_status();
     }
 
-    // Update the current status
-    current_status.wifi_connected = connected;
-    if(connected)
+    return NULL;
+}
+
+// Initialize Wi-Fi monitoring
+void wifi_init(void)
+{
+    if(initialized)
+        return;
+
+    memset(&current_status, 0, sizeof(wifi_status_t));
+    initialized = true;
+
+    // The monitor thread reads the first status, the generation counter publishes it
+    link_events_init();
+
+    if(pipe(wake_pipe) != 0)
     {
-        strncpy(current_status.wifi_ssid, ssid, sizeof(current_status.wifi_ssid) - 1);
-        current_status.wifi_signal_strength = signal_strength;
+        log_error("Failed to create Wi-Fi monitor pipe: %s", strerror(errno));
+        return;
+    }
+
+    int rc = pthread_create(&monitor_thread, NULL, monitor_thread_cb, NULL);
+    if(rc != 0)
+    {
+        log_error("Failed to create Wi-Fi monitor thread: %s", strerror(rc));
+        return;
+    }
+    thread_started = true;
+}
+
+// Stop the monitor thread and close its sockets
+void wifi_deinit(void)
+{
+    if(!initialized)
+        return;
+
+    if(thread_started)
+    {
+        send_command(MONITOR_CMD_STOP);
+        pthread_join(monitor_thread, NULL);
+        thread_started = false;
+    }
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(wake_pipe[i] >= 0)
+            close(wake_pipe[i]);
+        wake_pipe[i] = -1;
+    }
+    if(link_fd >= 0)
+        close(link_fd);
+    if(genl_fd >= 0)
+        close(genl_fd);
+    link_fd        = -1;
+    genl_fd        = -1;
+    nl80211_family = 0;
+    initialized    = false;
+}
+
+// Pause or resume the monitor thread
+void wifi_set_paused(bool paused)
+{
+    pthread_mutex_lock(&status_mutex);
+    bool changed   = monitor_paused != paused;
+    monitor_paused = paused;
+    pthread_mutex_unlock(&status_mutex);
 
-        // Get IP address for the connected interface
-        parse_ip_address(current_interface, current_status.wifi_ip_address,
-                         sizeof(current_status.wifi_ip_address));
+    if(changed && thread_started)
+    {
+        send_command(MONITOR_CMD_WAKE);
     }
-    else
+}
+
+// Get the current Wi-Fi status
+wifi_status_t wifi_get_status(void)
+{
+    if(!initialized)
     {
-        strcpy(current_status.wifi_ssid, "");
-        current_status.wifi_signal_strength = 0;
-        strcpy(current_status.wifi_ip_address, "");
+        wifi_init();
     }
-}
\ No newline at end of file
+
+    pthread_mutex_lock(&status_mutex);
+    wifi_status_t status = current_status;
+    pthread_mutex_unlock(&status_mutex);
+    return status;
+}
+
+// Get a counter that changes whenever the status changed
+uint32_t wifi_get_generation(void)
+{
+    pthread_mutex_lock(&status_mutex);
+    uint32_t generation = status_generation;
+    pthread_mutex_unlock(&status_mutex);
+    return generation;
+}
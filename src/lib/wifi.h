@@ -7,6 +7,7 @@
 #define WIFI_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * Structure containing the Wi-Fi connection status information
@@ -21,20 +22,35 @@ typedef struct
 
 /**
  * Initialize Wi-Fi monitoring
+ * Starts the monitor thread that reads the status and keeps it up to date, the status
+ * reads as not connected until its first read completes. Never blocks.
  * Must be called before any other Wi-Fi functions
  */
 void wifi_init(void);
 
 /**
- * Update Wi-Fi status information
- * Should be called periodically to refresh connection data
+ * Stop the monitor thread
  */
-void wifi_update(void);
+void wifi_deinit(void);
+
+/**
+ * Pause or resume the monitor thread, e.g. while the status is not shown
+ * A resumed monitor refreshes the status right away.
+ * @param paused true to stop refreshing the status
+ */
+void wifi_set_paused(bool paused);
 
 /**
  * Get the current Wi-Fi connection status
+ * Copies the status cached by the monitor thread, never blocks on the system.
  * @return Current Wi-Fi status information
  */
 wifi_status_t wifi_get_status(void);
 
+/**
+ * Get a counter that changes whenever the Wi-Fi status changed
+ * @return status generation
+ */
+uint32_t wifi_get_generation(void);
+
 #endif /* WIFI_H */
\ No newline at end of file
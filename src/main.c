@@ -2,11 +2,11 @@
  *
  * main.c - LVGL Camper GUI for GNU/Linux
  *
- * Integrated SDL backend directly in this file
+ * The display backend (SDL, DRM or fbdev) is selected at runtime,
+ * see lib/display_backend.c
  *
  ******************************************************************/
 #include <unistd.h>
-#include <pthread.h>
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,27 +17,68 @@
 #include "lvgl/lvgl.h"
 #include "lvgl/demos/lv_demos.h"
 #include "lib/lv_sdl_disp.h"
+#include "lib/display_backend.h"
+#include "lib/proc_stats.h"
+#include "lib/evdev_touch.h"
+#include "lib/render_stats.h"
 #include "ui/ui.h"
+#include "ui/ui_store.h"
+#include "ui/latency_trace.h"
+#include "bench/bench.h"
 #include "lib/logger.h"
 #include "lib/http_client.h"
 #include "data/data_manager.h"
 #include "lib/mem_debug.h"
 #include "main.h"
 
+#if LV_USE_SDL
+#define DEFAULT_DISPLAY_BACKEND DISPLAY_BACKEND_SDL
+#else
+#define DEFAULT_DISPLAY_BACKEND DISPLAY_BACKEND_DRM
+#endif
+
+#if LV_COLOR_DEPTH == 16
+#define DEFAULT_COLOR_PROFILE DISPLAY_COLOR_RGB565
+#else
+#define DEFAULT_COLOR_PROFILE DISPLAY_COLOR_32BPP
+#endif
+
 /* Simulator settings */
 typedef struct
 {
-    int window_width;
-    int window_height;
+    int                     window_width;
+    int                     window_height;
+    display_backend_type_t  backend;
+    display_color_profile_t color_profile;
+    const char*             display_device;
+    const char*             input_device;
+    bool                    measure_startup;
+    const char*             stats_file;
+    bool                    stats_overlay;
+    const char*             bench;
+    const char*             snapshot_dir;
 } simulator_settings_t;
 
-simulator_settings_t settings = {.window_width = 1024, .window_height = 600};
+simulator_settings_t settings = {.window_width    = 1024,
+                                 .window_height   = 600,
+                                 .backend         = DEFAULT_DISPLAY_BACKEND,
+                                 .color_profile   = DEFAULT_COLOR_PROFILE,
+                                 .display_device  = NULL,
+                                 .input_device    = TOUCH_INPUT_DEVICE,
+                                 .measure_startup = false,
+                                 .stats_file      = NULL,
+                                 .stats_overlay   = false,
+                                 .bench           = NULL,
+                                 .snapshot_dir    = BENCH_SNAPSHOT_DIR};
+
+/* Startup measurement */
+static struct timespec main_start_time;
+static bool            first_frame_reported = false;
 
 /* Internal functions */
 static void configure(int argc, char** argv);
 static void print_lvgl_version(void);
 static void print_usage(void);
-static void tick_thread_init(void);
 
 /**
  * @brief Print LVGL version
@@ -53,10 +94,24 @@ static void print_lvgl_version(void)
  */
 static void print_usage(void)
 {
-    fprintf(stdout, "\ncamper-gui [-V] [-W width] [-H height]\n\n");
+    fprintf(stdout, "\ncamper-gui [-V] [-W width] [-H height] [-b backend] [-d device] "
+                    "[-i device] [-c profile] [-m] [-s file] [-o] [-B bench] [-S dir]\n\n");
     fprintf(stdout, "-V      Print Camper GUI version\n");
     fprintf(stdout, "-W      Set window width\n");
     fprintf(stdout, "-H      Set window height\n");
+    fprintf(stdout, "-b      Display backend: sdl, drm, fbdev or headless (default %s)\n",
+            display_backend_name(DEFAULT_DISPLAY_BACKEND));
+    fprintf(stdout, "-d      Display device (default %s for drm, %s for fbdev)\n",
+            DISPLAY_DRM_DEVICE, DISPLAY_FBDEV_DEVICE);
+    fprintf(stdout, "-i      Touch input device for drm and fbdev (default %s)\n",
+            TOUCH_INPUT_DEVICE);
+    fprintf(stdout, "-c      Color profile: 32, 16 (RGB565) or 16d (RGB565 dithered)\n");
+    fprintf(stdout, "-m      Print startup time and memory usage after the first frame and exit\n");
+    fprintf(stdout, "-s      Export render statistics histograms to this file every minute\n");
+    fprintf(stdout, "-o      Show the render statistics overlay\n");
+    fprintf(stdout, "-B      Run a benchmark on the headless backend and exit, 'list' for all\n");
+    fprintf(stdout, "-S      Data snapshot directory for benchmarks (default %s)\n",
+            BENCH_SNAPSHOT_DIR);
 }
 
 /**
@@ -81,10 +136,39 @@ static void configure(int argc, char** argv)
     /* Default values already set in global settings */
 
     /* Parse the command-line options. */
-    while((opt = getopt(argc, argv, "W:H:Vh")) != -1)
+    while((opt = getopt(argc, argv, "W:H:b:d:i:c:ms:oB:S:Vh")) != -1)
     {
         switch(opt)
         {
+            case 'W': settings.window_width = atoi(optarg); break;
+            case 'H': settings.window_height = atoi(optarg); break;
+            case 'b':
+                if(!display_backend_from_name(optarg, &settings.backend))
+                {
+                    print_usage();
+                    die("Unknown display backend '%s'.\n", optarg);
+                }
+                break;
+            case 'd': settings.display_device = optarg; break;
+            case 'i': settings.input_device = optarg; break;
+            case 'm': settings.measure_startup = true; break;
+            case 's': settings.stats_file = optarg; break;
+            case 'o': settings.stats_overlay = true; break;
+            case 'B': settings.bench = optarg; break;
+            case 'S': settings.snapshot_dir = optarg; break;
+            case 'c':
+                if(strcmp(optarg, "32") == 0)
+                    settings.color_profile = DISPLAY_COLOR_32BPP;
+                else if(strcmp(optarg, "16") == 0)
+                    settings.color_profile = DISPLAY_COLOR_RGB565;
+                else if(strcmp(optarg, "16d") == 0)
+                    settings.color_profile = DISPLAY_COLOR_RGB565_DITHER;
+                else
+                {
+                    print_usage();
+                    die("Unknown color profile '%s'.\n", optarg);
+                }
+                break;
             case 'h':
                 print_usage();
                 exit(EXIT_SUCCESS);
@@ -103,34 +187,28 @@ static void configure(int argc, char** argv)
 }
 
 /**
- * @brief LVGL tick thread function
+ * @brief LVGL tick source, milliseconds from the monotonic clock
+ * Reading the clock on demand keeps LVGL time exact without a thread waking
+ * up every few milliseconds to advance it.
  */
-static void* tick_thread_cb(void* data)
+static uint32_t tick_get_cb(void)
 {
-    (void)data;
-
-    while(1)
-    {
-        usleep(5000);   /* Sleep for 5 milliseconds */
-        lv_tick_inc(5); /* Tell LVGL that 5 milliseconds has elapsed */
-    }
-
-    return NULL;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 }
 
+#ifdef LV_CAMPER_DEBUG
 /**
- * @brief Initialize the tick thread for LVGL timing
+ * @brief Microseconds from the monotonic clock, for the wakeup statistics
  */
-static void tick_thread_init(void)
+static uint64_t monotonic_us(void)
 {
-    pthread_t thread;
-    int       ret = pthread_create(&thread, NULL, tick_thread_cb, NULL);
-    if(ret != 0)
-    {
-        die("Failed to create tick thread: %s\n", strerror(ret));
-    }
-    pthread_detach(thread);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
 }
+#endif
 
 /**
  * @brief Initialize LVGL
@@ -140,14 +218,52 @@ static void lvgl_init(void)
     /* Initialize LVGL library */
     lv_init();
 
-    /* Initialize tick thread for LVGL timing */
-    tick_thread_init();
+    /* Take LVGL time from the monotonic clock */
+    lv_tick_set_cb(tick_get_cb);
 
     log_debug("LVGL initialized");
 }
 
+/**
+ * @brief Report startup time and memory usage once the first frame is rendered
+ *
+ * The time since exec includes loading the shared libraries, which is where
+ * most of the difference between the SDL and the fbdev/DRM backends shows up.
+ */
+static void first_frame_cb(lv_event_t* e)
+{
+    (void)e;
+
+    if(first_frame_reported)
+        return;
+    first_frame_reported = true;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint32_t main_ms = (now.tv_sec - main_start_time.tv_sec) * 1000 +
+                       (now.tv_nsec - main_start_time.tv_nsec) / 1000000;
+
+    proc_stats_t stats;
+    if(proc_stats_read(&stats) != 0)
+        return;
+
+    log_info("Startup (%s): first frame %u ms after exec, %u ms after main, RSS %u kB (peak %u kB)",
+             display_backend_name(settings.backend), stats.ms_since_exec, main_ms, stats.rss_kb,
+             stats.rss_peak_kb);
+
+    if(settings.measure_startup)
+    {
+        fprintf(stdout,
+                "backend=%s exec_to_frame_ms=%u main_to_frame_ms=%u rss_kb=%u rss_peak_kb=%u\n",
+                display_backend_name(settings.backend), stats.ms_since_exec, main_ms, stats.rss_kb,
+                stats.rss_peak_kb);
+    }
+}
+
 int main(int argc, char** argv)
 {
+    clock_gettime(CLOCK_MONOTONIC, &main_start_time);
+
     /* Parse command line arguments */
     configure(argc, argv);
 
@@ -156,44 +272,71 @@ int main(int argc, char** argv)
     // Initialize memory debugging
     mem_debug_init();
 
-    static uint32_t frame_count   = 0;
+    static uint32_t wakeup_count  = 0;
     static uint32_t refresh_count = 0;
     static uint32_t last_time     = 0;
+    static uint64_t last_us       = 0;
+    static uint32_t last_ctxt     = 0;
+    static uint32_t timeout_count = 0; // Waits that ran to their timeout
+    static uint64_t late_sum_us   = 0; // Time slept beyond the requested waits
+    static uint32_t late_max_us   = 0;
 
 #endif
     /* Initialize logger */
     logger_init();
     log_info("Application starting v%s", APP_VERSION_STRING);
 
+    /* Benchmarks replace the application and bring their own display and data */
+    if(settings.bench)
+    {
+        bench_options_t bench_options = {
+            .snapshot_dir  = settings.snapshot_dir,
+            .width         = settings.window_width,
+            .height        = settings.window_height,
+            .color_profile = settings.color_profile,
+            .frames        = BENCH_FRAMES,
+        };
+        return bench_run(settings.bench, &bench_options);
+    }
+
     http_client_init();
 
     if(init_background_fetcher() != 0)
     {
         log_error("Failed to initialize background data fetcher");
     }
+    set_background_notify_cb(display_backend_wakeup);
 
     /* Initialize LVGL first */
     lvgl_init();
 
-    /* Initialize the SDL display with the configured size */
-    lv_port_disp_init(settings.window_width, settings.window_height);
-
-    /* Create an SDL mouse input device */
-    lv_indev_t* mouse_indev = lv_sdl_mouse_create();
-    if(!mouse_indev)
+    /* Initialize the selected display backend and its input devices */
+    display_config_t display_config = {
+        .type           = settings.backend,
+        .width          = settings.window_width,
+        .height         = settings.window_height,
+        .color_profile  = settings.color_profile,
+        .display_device = settings.display_device,
+        .input_device   = settings.input_device,
+    };
+
+    if(display_backend_init(&display_config) != 0)
     {
-        log_error("Failed to create mouse input device.");
+        die("Failed to initialize %s display backend\n", display_backend_name(settings.backend));
     }
 
-    lv_indev_t* touch_indev = lv_sdl_touch_create();
-    if(!touch_indev)
-    {
-        log_error("Warning: Failed to create touch input device.");
-    }
+    lv_display_add_event_cb(lv_display_get_default(), first_frame_cb, LV_EVENT_REFR_READY, NULL);
+    render_stats_init(lv_display_get_default(), settings.stats_file);
+    latency_trace_init(lv_display_get_default());
 
     /* Create a Demo */
     create_ui();
 
+    if(settings.stats_overlay)
+    {
+        render_stats_overlay_show(true);
+    }
+
 #ifdef LV_CAMPER_DEBUG
 
     ui_print_memory_usage();
@@ -202,19 +345,25 @@ int main(int argc, char** argv)
 #endif
 
     /* Main loop */
-    while(1)
+    while(!(settings.measure_startup && first_frame_reported))
     {
-        /* Handle SDL events */
-        lv_sdl_handle_events();
+        /* Handle display backend events, they feed input to LVGL outside lv_timer_handler()
+         * and need the LVGL lock when LVGL runs with an OS layer (CAMPER_DRAW_UNITS > 1) */
+        lv_lock();
+        display_backend_handle_events();
+
+        /* Push fetched data into the UI subjects, only the bound widgets that changed redraw */
+        ui_store_update();
+        lv_unlock();
 
-        /* Let LVGL do its work */
-        lv_task_handler();
+        /* Let LVGL do its work, it returns the time until its next timer is due */
+        uint32_t idle_ms = lv_timer_handler();
 
 #ifdef LV_CAMPER_DEBUG
 
         refresh_count++;
-        frame_count++;
-        uint32_t current_time = SDL_GetTicks();
+        wakeup_count++;
+        uint32_t current_time = lv_tick_get();
 
         if(refresh_count % 1000 == 0)
         {
@@ -229,27 +378,90 @@ int main(int argc, char** argv)
 
         if(current_time - last_time > 5000)
         {
-            float fps = frame_count / ((current_time - last_time) / 1000.0f);
-            log_info("UI performance: %.2f fps", fps);
-            frame_count = 0;
-            last_time   = current_time;
-        }
+            float wakeups = wakeup_count / ((current_time - last_time) / 1000.0f);
+            log_info("Main loop: %.2f wakeups/s", wakeups);
 
+            // How late the timed waits woke up, the timers run late by as much
+            if(timeout_count > 0)
+            {
+                log_info("Wait: %u timeouts, woke up %.2f ms late on average (max %.2f ms)",
+                         timeout_count, late_sum_us / 1000.0f / timeout_count,
+                         late_max_us / 1000.0f);
+            }
+            timeout_count = 0;
+            late_sum_us   = 0;
+            late_max_us   = 0;
+
+            // Count the wakeups of all threads
+            uint64_t     now_us = monotonic_us();
+            proc_stats_t proc;
+            if(proc_stats_read(&proc) == 0)
+            {
+                if(last_us != 0)
+                {
+                    float elapsed_s = (now_us - last_us) / 1e6f;
+                    log_info("Process: %.1f wakeups/s",
+                             (proc.process_ctxt - last_ctxt) / elapsed_s);
+                }
+                last_ctxt = proc.process_ctxt;
+                last_us   = now_us;
+            }
+
+#if LV_USE_SDL
+            if(settings.backend == DISPLAY_BACKEND_SDL)
+            {
+                lv_port_disp_stats_t disp_stats;
+                lv_port_disp_get_stats(&disp_stats, true);
+                log_info("Display: %u frames, %.1f flushes/frame (max %u), present %.0f us "
+                         "(max %u us), %.0f kB uploaded/frame",
+                         disp_stats.frames, disp_stats.avg_flushes_per_frame,
+                         disp_stats.max_flushes_per_frame, disp_stats.avg_present_us,
+                         disp_stats.max_present_us, disp_stats.avg_upload_bytes / 1024.0f);
+            }
 #endif
+            evdev_touch_stats_t touch_stats;
+            evdev_touch_get_stats(&touch_stats, true);
+            if(touch_stats.samples > 0)
+            {
+                log_info("Touch: %u samples, latency %.0f us (max %u us)", touch_stats.samples,
+                         touch_stats.avg_latency_us, touch_stats.max_latency_us);
+            }
 
-        /* Sleep more when display is off to reduce CPU usage */
-        if(ui_is_sleeping())
-        {
-            SDL_Delay(200);
+            wakeup_count = 0;
+            last_time    = current_time;
         }
-        else
+
+#endif
+
+        /* Block until the next timer is due, input arrives or the worker has results */
+        uint32_t max_wait_ms =
+            ui_is_sleeping() ? MAIN_LOOP_SLEEP_MAX_WAIT_MS : MAIN_LOOP_MAX_WAIT_MS;
+        uint32_t wait_ms = LV_MIN(idle_ms, max_wait_ms);
+
+#ifdef LV_CAMPER_DEBUG
+
+        uint64_t wait_start_us = monotonic_us();
+        display_backend_wait_events(wait_ms);
+
+        // An event ends the wait early, only a wait that ran to its timeout can be late
+        uint64_t slept_us = monotonic_us() - wait_start_us;
+        if(slept_us >= (uint64_t)wait_ms * 1000)
         {
-            SDL_Delay(20);
+            uint32_t late_us = (uint32_t)(slept_us - (uint64_t)wait_ms * 1000);
+            late_sum_us += late_us;
+            late_max_us = LV_MAX(late_max_us, late_us);
+            timeout_count++;
         }
+
+#else
+
+        display_backend_wait_events(wait_ms);
+
+#endif
     }
 
-    /* Clean up resources (never reached in normal execution) */
-    lv_port_disp_deinit();
+    /* Clean up resources (only reached when measuring startup) */
+    display_backend_deinit();
 
 #ifdef LV_CAMPER_DEBUG
 
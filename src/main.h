@@ -47,8 +47,35 @@ extern "C"
  * Display Constants
  ****************************************************************************/
 
+/* Display backends */
+#define DISPLAY_DRM_DEVICE "/dev/dri/card0"    /* DRM device for the drm backend */
+#define DISPLAY_FBDEV_DEVICE "/dev/fb0"        /* Framebuffer device for the fbdev backend */
+#define TOUCH_INPUT_DEVICE "/dev/input/event0" /* evdev touch device for non-SDL backends */
+
 /* Display power management */
-#define DISPLAY_INACTIVITY_TIMEOUT_MS 120017 /* Time until screen blanks in ms */
+#define DISPLAY_INACTIVITY_TIMEOUT_MS 120017         /* Time until screen blanks in ms */
+#define DISPLAY_BACKLIGHT_DIR "/sys/class/backlight" /* First device found is faded */
+#define DISPLAY_BACKLIGHT_FADE_MS 300                /* Backlight fade duration in ms */
+#define DISPLAY_BACKLIGHT_FADE_STEPS 10              /* Brightness steps per fade */
+
+/* Main loop */
+#define MAIN_LOOP_MAX_WAIT_MS 1000        /* Upper bound on blocking when no LVGL timer is due */
+#define MAIN_LOOP_SLEEP_MAX_WAIT_MS 60000 /* Same while the display is blanked and suspended */
+
+/* Tabs */
+#define UI_TAB_TEARDOWN_MS 300000 /* Delete hidden tab content after this, 0 to keep it */
+
+/* Render statistics */
+#define RENDER_STATS_REPORT_INTERVAL_MS 60000 /* Summary log and histogram export interval */
+#define RENDER_STATS_OVERLAY_INTERVAL_MS 1000 /* On-screen overlay update interval */
+
+/* Latency tracing */
+#define TRACE_DISPLAY_TIMEOUT_MS 1000 /* Readings not flushed within this are not traced further */
+
+/* Benchmarks */
+#define BENCH_SNAPSHOT_DIR "bench/snapshots" /* Recorded API responses for benchmarks */
+#define BENCH_FRAMES 300                     /* Frames rendered per benchmark scenario */
+#define BENCH_FRAME_PERIOD_MS 33             /* Synthetic time between benchmark frames */
 
 /****************************************************************************
  * Network Constants
@@ -61,6 +88,9 @@ extern "C"
 /* Network timeouts */
 #define HTTP_TIMEOUT_SECONDS 8 /* HTTP request timeout in seconds */
 
+/* Wi-Fi */
+#define WIFI_SIGNAL_POLL_MS 5000 /* Signal level refresh, link and address changes are events */
+
     /****************************************************************************
      * Data Update Intervals
      ****************************************************************************/
@@ -69,11 +99,20 @@ extern "C"
 #define DATA_OTHER_UPDATE_INTERVAL_MS 8935  /* Data other refresh interval in ms */
 #define DATA_CHART_UPDATE_INTERVAL_MS 6002  /* Chart refresh interval */
 #define LOG_REFRESH_INTERVAL_MS 2999        /* Log display refresh interval in ms */
-#define BACKGROUND_FETCH_SLEEP_US 199999    /* Background fetcher sleep time in microseconds */
+#define DATA_CAMPER_STALE_MS 30000          /* Grey out camper values older than this */
+#define DATA_OTHER_STALE_MS 180000          /* Same for the sensors fetched once a minute */
 
 #define MAX_LOG_ENTRIES 100              /* Maximum number of log entries to keep */
 #define INITIAL_LOG_LEVEL LOG_LEVEL_INFO /* Initial log level for displaying logs */
 
+/* Analytics */
+#define ANALYTICS_PERIOD "5m"                 /* Finest history period, level 0 of the pyramid */
+#define ANALYTICS_PERIOD_S 300                /* Same period in seconds, must divide a day */
+#define ANALYTICS_DAYS 30                     /* Longest range that can be shown */
+#define ANALYTICS_MAX_POINTS 800              /* Upper bound on the points drawn per series */
+#define ANALYTICS_POLL_INTERVAL_MS 500        /* Check for new data while the tab is shown */
+#define ANALYTICS_REQUEST_INTERVAL_MS 5000    /* Minimum time between history requests */
+
 /****************************************************************************
  * Other Application Constants
  ****************************************************************************/
@@ -1,67 +1,454 @@
+#include <stdio.h>
+#include <time.h>
+
 #include "analytics_tab.h"
+#include "static_layer.h"
 #include "../lib/logger.h"
+#include "../data/data_manager.h"
+#include "../data/history_lod.h"
+#include "../main.h"
 #include "lvgl/lvgl.h"
 
+/**
+ * History that can be shown
+ */
+typedef struct
+{
+    const char*  sensor_name;
+    const char*  entity_name;
+    const char*  label_fmt; // printf format of the min/max values
+    lv_palette_t palette;
+} analytics_series_t;
+
+static const analytics_series_t series_options[] = {
+    {"inside", "temperature", "%.1f°C", LV_PALETTE_GREEN},
+    {"outside", "temperature", "%.1f°C", LV_PALETTE_BLUE},
+    {"SmartShunt", "soc", "%.1f%%", LV_PALETTE_ORANGE},
+    {"SmartSolar", "yield_today", "%.2f kWh", LV_PALETTE_PURPLE},
+    {"SmartShunt", "consumed_ah", "%.1f Ah", LV_PALETTE_RED},
+};
+
+// Dropdown entries in the order of series_options
+static const char* series_names = "Inside temperature\n"
+                                  "Outside temperature\n"
+                                  "Battery charge\n"
+                                  "Solar yield\n"
+                                  "Consumed Ah";
+
+#define SERIES_OPTION_COUNT (sizeof(series_options) / sizeof(series_options[0]))
+
+static const char*   range_names[]   = {"24 h", "7 d", "30 d"};
+static const int64_t range_spans_s[] = {86400, 7 * 86400, ANALYTICS_DAYS * 86400};
+
+#define RANGE_COUNT (sizeof(range_spans_s) / sizeof(range_spans_s[0]))
+
+// Shortest span a pinch can zoom in to
+#define MIN_SPAN_S (2 * 3600)
+
+static lv_obj_t*          chart            = NULL;
+static lv_chart_series_t* max_series       = NULL;
+static lv_chart_series_t* min_series       = NULL;
+static lv_obj_t*          range_buttons[RANGE_COUNT];
+static lv_obj_t*          left_time_label  = NULL;
+static lv_obj_t*          right_time_label = NULL;
+static lv_obj_t*          info_label       = NULL;
+static lv_timer_t*        poll_timer       = NULL;
+
+// Points of the view, drawn by the chart without copying
+static int32_t max_points[ANALYTICS_MAX_POINTS];
+static int32_t min_points[ANALYTICS_MAX_POINTS];
+
+static uint32_t selected_series = 0;
+static int64_t  view_span_s     = 86400;
+static int64_t  view_end_s      = 0;    // Right edge while panned away from now
+static bool     follow_now      = true; // Right edge is the current time
+static int64_t  drag_start_end_s;
+static int32_t  drag_dx;
+static uint32_t shown_generation;
+static int64_t  shown_bucket;
+static uint32_t last_request_tick;
+static bool     request_sent    = false;
+static bool     tab_active      = true;
+static bool     tab_suspended   = false;
+
+static int64_t oldest_time(int64_t now)
+{
+    return now - (int64_t)ANALYTICS_DAYS * 86400;
+}
+
+// Right edge of the view
+static int64_t view_end(int64_t now)
+{
+    return follow_now ? now : view_end_s;
+}
+
+// Move the right edge, clamped to the stored days, now resumes following the time
+static void set_view_end(int64_t end, int64_t now)
+{
+    if(end < oldest_time(now) + view_span_s)
+        end = oldest_time(now) + view_span_s;
+
+    follow_now = (end >= now);
+    view_end_s = follow_now ? now : end;
+}
+
+static void format_time(int64_t epoch_s, char* output, size_t output_size)
+{
+    time_t    t = (time_t)epoch_s;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(output, output_size, "%d-%m %H:%M", &tm);
+}
+
+/**
+ * Request the samples the view is missing, at most once per ANALYTICS_REQUEST_INTERVAL_MS
+ */
+static void request_missing(int64_t start, int64_t now)
+{
+    if(request_sent && lv_tick_elaps(last_request_tick) < ANALYTICS_REQUEST_INTERVAL_MS)
+        return;
+
+    int samples = history_lod_missing_samples(start, now);
+    if(samples <= 0)
+        return;
+
+    const analytics_series_t* opt = &series_options[selected_series];
+    if(request_history_lod(opt->sensor_name, opt->entity_name, samples))
+    {
+        request_sent      = true;
+        last_request_tick = lv_tick_get();
+        log_debug("Requested %d samples of %s.%s", samples, opt->sensor_name, opt->entity_name);
+    }
+}
+
+/**
+ * Query the pyramid for the current view and update the chart and labels
+ */
+static void refresh_view(void)
+{
+    if(chart == NULL)
+        return;
+
+    int64_t now   = time(NULL);
+    int64_t end   = view_end(now);
+    int64_t start = end - view_span_s;
+
+    // At most one point per pixel
+    int32_t width      = lv_obj_get_content_width(chart);
+    int32_t point_room = LV_CLAMP(2, width, ANALYTICS_MAX_POINTS);
+
+    history_lod_view_t view;
+    shown_generation = history_lod_generation();
+    shown_bucket     = now / ANALYTICS_PERIOD_S;
+    history_lod_query(start, end, point_room, min_points, max_points, &view);
+
+    lv_chart_set_point_count(chart, view.count > 0 ? view.count : 1);
+    if(view.count == 0)
+    {
+        max_points[0] = HISTORY_POINT_NONE;
+        min_points[0] = HISTORY_POINT_NONE;
+    }
+
+    const analytics_series_t* opt = &series_options[selected_series];
+    if(view.has_data)
+    {
+        // 10% padding so the data does not touch the edges
+        int32_t padding = LV_MAX((view.max - view.min) / 10, HISTORY_LOD_SCALE / 2);
+        lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, view.min - padding,
+                           view.max + padding);
+
+        char min_text[24];
+        char max_text[24];
+        snprintf(min_text, sizeof(min_text), opt->label_fmt, (float)view.min / HISTORY_LOD_SCALE);
+        snprintf(max_text, sizeof(max_text), opt->label_fmt, (float)view.max / HISTORY_LOD_SCALE);
+        lv_label_set_text_fmt(info_label, "Min %s   Max %s   %u min per point", min_text, max_text,
+                              (unsigned)((ANALYTICS_PERIOD_S << view.level) / 60));
+    }
+    else
+    {
+        lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, 100 * HISTORY_LOD_SCALE);
+        lv_label_set_text(info_label, "Loading...");
+    }
+
+    char time_text[16];
+    format_time(start, time_text, sizeof(time_text));
+    lv_label_set_text(left_time_label, time_text);
+    format_time(end, time_text, sizeof(time_text));
+    lv_label_set_text(right_time_label, time_text);
+
+    lv_chart_refresh(chart);
+
+    request_missing(start, now);
+}
+
+static void poll_timer_cb(lv_timer_t* timer)
+{
+    // Redraw when new tiles arrived or, while following now, a new bucket started
+    int64_t now = time(NULL);
+    if(history_lod_generation() != shown_generation ||
+       (follow_now && now / ANALYTICS_PERIOD_S != shown_bucket))
+    {
+        refresh_view();
+    }
+    else
+    {
+        request_missing(view_end(now) - view_span_s, now);
+    }
+}
+
+static void update_range_buttons(void)
+{
+    for(uint32_t i = 0; i < RANGE_COUNT; i++)
+    {
+        if(range_spans_s[i] == view_span_s)
+            lv_obj_add_state(range_buttons[i], LV_STATE_CHECKED);
+        else
+            lv_obj_clear_state(range_buttons[i], LV_STATE_CHECKED);
+    }
+}
+
+// Change the span around the center of the view
+static void set_view_span(int64_t span)
+{
+    int64_t now    = time(NULL);
+    int64_t center = view_end(now) - view_span_s / 2;
+
+    view_span_s = LV_CLAMP(MIN_SPAN_S, span, (int64_t)ANALYTICS_DAYS * 86400);
+    set_view_end(center + view_span_s / 2, now);
+    update_range_buttons();
+    refresh_view();
+}
+
+static void range_button_event_cb(lv_event_t* e)
+{
+    uint32_t range = (uint32_t)(uintptr_t)lv_event_get_user_data(e);
+
+    // The ranges end at the current time
+    view_span_s = range_spans_s[range];
+    follow_now  = true;
+    update_range_buttons();
+    refresh_view();
+}
+
+static void series_dropdown_event_cb(lv_event_t* e)
+{
+    lv_obj_t* dropdown = lv_event_get_target(e);
+    selected_series    = lv_dropdown_get_selected(dropdown);
+
+    const analytics_series_t* opt = &series_options[selected_series];
+    history_lod_select(opt->sensor_name, opt->entity_name);
+    lv_chart_set_series_color(chart, max_series, lv_palette_main(opt->palette));
+    lv_chart_set_series_color(chart, min_series, lv_palette_lighten(opt->palette, 2));
+
+    request_sent = false;
+    refresh_view();
+}
+
+/**
+ * Drag to pan through time
+ */
+static void chart_drag_event_cb(lv_event_t* e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    int64_t         now  = time(NULL);
+
+    if(code == LV_EVENT_PRESSED)
+    {
+        drag_start_end_s = view_end(now);
+        drag_dx          = 0;
+    }
+    else if(code == LV_EVENT_PRESSING)
+    {
+        lv_point_t vect;
+        lv_indev_get_vect(lv_indev_active(), &vect);
+        if(vect.x == 0)
+            return;
+
+        drag_dx += vect.x;
+        int32_t width = LV_MAX(lv_obj_get_content_width(chart), 1);
+
+        // Dragging to the right shows older data
+        set_view_end(drag_start_end_s - (int64_t)drag_dx * view_span_s / width, now);
+        refresh_view();
+    }
+}
+
+#if LV_USE_GESTURE_RECOGNITION
+/**
+ * Pinch to zoom, on touch screens that report two fingers
+ */
+static void chart_gesture_event_cb(lv_event_t* e)
+{
+    static int64_t pinch_start_span_s = 0;
+
+    if(lv_event_get_gesture_type(e) != LV_INDEV_GESTURE_PINCH)
+        return;
+
+    lv_indev_gesture_state_t state = lv_event_get_gesture_state(e, LV_INDEV_GESTURE_PINCH);
+    if(state == LV_INDEV_GESTURE_STATE_ENDED || state == LV_INDEV_GESTURE_STATE_CANCELED)
+    {
+        pinch_start_span_s = 0;
+        return;
+    }
+
+    if(pinch_start_span_s == 0)
+        pinch_start_span_s = view_span_s;
+
+    float scale = lv_event_get_pinch_scale(e);
+    if(scale > 0.0f)
+    {
+        set_view_span((int64_t)(pinch_start_span_s / scale));
+    }
+}
+#endif
+
+static lv_obj_t* create_time_label(lv_obj_t* parent, lv_align_t align, int32_t x_offset)
+{
+    lv_obj_t* label = lv_label_create(parent);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_color(label, lv_palette_main(LV_PALETTE_GREY), 0);
+    lv_obj_align(label, align, x_offset, 0);
+    lv_label_set_text(label, "");
+    return label;
+}
+
+// Run the poll timer only while the tab is shown and the display is on
+static void update_poll_timer(void)
+{
+    if(poll_timer == NULL)
+        return;
+
+    if(tab_suspended || !tab_active)
+    {
+        lv_timer_pause(poll_timer);
+    }
+    else
+    {
+        lv_timer_resume(poll_timer);
+        lv_timer_ready(poll_timer);
+    }
+}
+
 /**
  * @brief Create Analytics tab content
- * @param tab_analytics Parent tab object
+ * @param parent Parent tab object
  */
 void create_analytics_tab(lv_obj_t* parent)
 {
-    // Add content to Analytics tab
-    lv_obj_t* analytics_label = lv_label_create(parent);
-    lv_label_set_text(analytics_label, "Energy & Resource Analytics");
-    lv_obj_align(analytics_label, LV_ALIGN_TOP_MID, 0, 20);
+    lv_obj_set_style_pad_all(parent, 5, 0);
+
+    // Series selection and range buttons
+    lv_obj_t* controls = lv_obj_create(parent);
+    lv_obj_remove_flag(controls, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(controls, lv_pct(100), 50);
+    lv_obj_align(controls, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_flex_flow(controls, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(controls, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_bg_opa(controls, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(controls, 0, 0);
+    lv_obj_set_style_pad_all(controls, 0, 0);
+    lv_obj_set_style_pad_column(controls, 10, 0);
+
+    lv_obj_t* dropdown = lv_dropdown_create(controls);
+    lv_dropdown_set_options_static(dropdown, series_names);
+    lv_dropdown_set_selected(dropdown, selected_series);
+    lv_obj_set_width(dropdown, 220);
+    lv_obj_add_event_cb(dropdown, series_dropdown_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+
+    for(uint32_t i = 0; i < RANGE_COUNT; i++)
+    {
+        lv_obj_t* btn    = lv_btn_create(controls);
+        range_buttons[i] = btn;
+        lv_obj_set_size(btn, 70, 40);
+        lv_obj_add_flag(btn, LV_OBJ_FLAG_CHECKABLE);
+        lv_obj_set_style_bg_color(btn, lv_palette_darken(LV_PALETTE_BLUE, 2),
+                                  LV_PART_MAIN | LV_STATE_CHECKED);
+
+        lv_obj_t* label = lv_label_create(btn);
+        lv_label_set_text(label, range_names[i]);
+        lv_obj_center(label);
+
+        lv_obj_add_event_cb(btn, range_button_event_cb, LV_EVENT_CLICKED, (void*)(uintptr_t)i);
+    }
+
+    info_label = lv_label_create(controls);
+    lv_obj_set_style_text_font(info_label, &lv_font_montserrat_12, 0);
+    lv_label_set_text(info_label, "");
 
-    // Create a chart
-    lv_obj_t* chart = lv_chart_create(parent);
-    lv_obj_set_size(chart, lv_pct(90), lv_pct(60));
-    lv_obj_align(chart, LV_ALIGN_CENTER, 0, 0);
+    // Chart area with the time labels below
+    lv_obj_t* chart_container = lv_obj_create(parent);
+    lv_obj_remove_flag(chart_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_size(chart_container, lv_pct(100), lv_pct(80));
+    lv_obj_align(chart_container, LV_ALIGN_BOTTOM_MID, 0, 0);
+    lv_obj_set_style_border_width(chart_container, 0, 0);
+    lv_obj_set_style_pad_all(chart_container, 5, 0);
+
+    chart = lv_chart_create(chart_container);
+    lv_obj_set_size(chart, lv_pct(100), lv_pct(90));
+    lv_obj_align(chart, LV_ALIGN_TOP_MID, 0, 0);
     lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
-    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, 100);
-    lv_chart_set_point_count(chart, 12);
-    lv_chart_set_div_line_count(chart, 5, 5);
-
-    // Add series to the chart
-    lv_chart_series_t* ser1 =
-        lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_series_t* ser2 =
-        lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
-
-    // Set sample data
-    for(int i = 0; i < 12; i++)
+    static_layer_create_chart_grid(chart, 5, 7);
+    lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR); // No point markers
+    lv_obj_remove_flag(chart, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_remove_flag(chart, LV_OBJ_FLAG_SCROLL_CHAIN); // Drags pan, not switch tabs
+    lv_chart_set_point_count(chart, 1);
+
+    const analytics_series_t* opt = &series_options[selected_series];
+    max_series =
+        lv_chart_add_series(chart, lv_palette_main(opt->palette), LV_CHART_AXIS_PRIMARY_Y);
+    min_series =
+        lv_chart_add_series(chart, lv_palette_lighten(opt->palette, 2), LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_ext_y_array(chart, max_series, max_points);
+    lv_chart_set_ext_y_array(chart, min_series, min_points);
+
+    lv_obj_add_event_cb(chart, chart_drag_event_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(chart, chart_drag_event_cb, LV_EVENT_PRESSING, NULL);
+#if LV_USE_GESTURE_RECOGNITION
+    lv_obj_add_event_cb(chart, chart_gesture_event_cb, LV_EVENT_GESTURE, NULL);
+#endif
+
+    left_time_label  = create_time_label(chart_container, LV_ALIGN_BOTTOM_LEFT, 5);
+    right_time_label = create_time_label(chart_container, LV_ALIGN_BOTTOM_RIGHT, -5);
+
+    update_range_buttons();
+    history_lod_select(opt->sensor_name, opt->entity_name);
+    request_sent = false;
+
+    poll_timer = lv_timer_create(poll_timer_cb, ANALYTICS_POLL_INTERVAL_MS, NULL);
+    update_poll_timer();
+
+    // The chart has its size after the next layout update
+    lv_obj_update_layout(chart);
+    refresh_view();
+}
+
+void analytics_tab_set_active(bool active)
+{
+    tab_active = active;
+    update_poll_timer();
+}
+
+void analytics_tab_set_suspended(bool suspended)
+{
+    tab_suspended = suspended;
+    update_poll_timer();
+}
+
+void analytics_tab_destroy(void)
+{
+    // The widgets are deleted with the tab page
+    if(poll_timer != NULL)
     {
-        lv_chart_set_next_value(chart, ser1, lv_rand(10, 90));
-        lv_chart_set_next_value(chart, ser2, lv_rand(10, 90));
+        lv_timer_delete(poll_timer);
+        poll_timer = NULL;
     }
+    chart            = NULL;
+    max_series       = NULL;
+    min_series       = NULL;
+    left_time_label  = NULL;
+    right_time_label = NULL;
+    info_label       = NULL;
 
-    // Add legend
-    lv_obj_t* legend_container = lv_obj_create(parent);
-    lv_obj_set_size(legend_container, lv_pct(90), 40);
-    lv_obj_align(legend_container, LV_ALIGN_BOTTOM_MID, 0, -20);
-    lv_obj_set_flex_flow(legend_container, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(legend_container, LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER,
-                          LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_pad_all(legend_container, 5, 0);
-
-    // Legend items
-    lv_obj_t* legend_item1 = lv_obj_create(legend_container);
-    lv_obj_set_size(legend_item1, 120, 30);
-    lv_obj_t* legend_color1 = lv_obj_create(legend_item1);
-    lv_obj_set_size(legend_color1, 15, 15);
-    lv_obj_set_style_bg_color(legend_color1, lv_palette_main(LV_PALETTE_RED), 0);
-    lv_obj_align(legend_color1, LV_ALIGN_LEFT_MID, 5, 0);
-    lv_obj_t* legend_text1 = lv_label_create(legend_item1);
-    lv_label_set_text(legend_text1, "Battery");
-    lv_obj_align(legend_text1, LV_ALIGN_LEFT_MID, 30, 0);
-
-    lv_obj_t* legend_item2 = lv_obj_create(legend_container);
-    lv_obj_set_size(legend_item2, 120, 30);
-    lv_obj_t* legend_color2 = lv_obj_create(legend_item2);
-    lv_obj_set_size(legend_color2, 15, 15);
-    lv_obj_set_style_bg_color(legend_color2, lv_palette_main(LV_PALETTE_BLUE), 0);
-    lv_obj_align(legend_color2, LV_ALIGN_LEFT_MID, 5, 0);
-    lv_obj_t* legend_text2 = lv_label_create(legend_item2);
-    lv_label_set_text(legend_text2, "Solar");
-    lv_obj_align(legend_text2, LV_ALIGN_LEFT_MID, 30, 0);
+    history_lod_release();
 }
@@ -6,6 +6,7 @@
 #ifndef ANALYTICS_TAB_H
 #define ANALYTICS_TAB_H
 
+#include <stdbool.h>
 #include "lvgl/lvgl.h"
 
 #ifdef __cplusplus
@@ -15,6 +16,23 @@ extern "C"
 
     void create_analytics_tab(lv_obj_t* parent);
 
+    /**
+     * Pause the history polling while the display is off
+     * @param suspended true to pause, false to resume
+     */
+    void analytics_tab_set_suspended(bool suspended);
+
+    /**
+     * Pause the history polling while the tab is not shown
+     * @param active true while the tab is the active tab
+     */
+    void analytics_tab_set_active(bool active);
+
+    /**
+     * Delete the poll timer and free the history pyramid before the tab content is deleted
+     */
+    void analytics_tab_destroy(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,13 +3,13 @@
 
 #include <stdbool.h>
 #include "lvgl/lvgl.h"
-#include "../../data/data_manager.h"
+#include "../../data/sensor_types.h"
 
 // Initialize the battery consumption chart
 void initialize_energy_chart(lv_obj_t* chart_container);
 
 // Update functions
-bool update_energy_chart_with_history(entity_history_t* history_data);
+bool update_energy_chart_with_history(const history_series_t* history);
 
 // Cleanup function
 void battery_chart_cleanup(void);
@@ -0,0 +1,297 @@
+// history_chart.c - Time series chart shared by the temperature, battery and solar charts
+//
+// The chart, its series, the min/max markers and the timestamp labels are created once.
+// The series draw straight from the view models the data layer prepares off the UI thread,
+// with their range and marker texts, so an update only combines the ranges, moves and
+// relabels the existing markers and invalidates the chart. It copies no values, formats no
+// numbers and creates no objects.
+#include "history_chart.h"
+#include "../static_layer.h"
+#include "../../lib/logger.h"
+
+#if HISTORY_POINT_NONE != LV_CHART_POINT_NONE
+#error "History gaps must be drawn as LV_CHART_POINT_NONE"
+#endif
+
+typedef struct
+{
+    lv_obj_t*          line;
+    lv_obj_t*          label;
+    lv_point_precise_t points[2];
+} history_marker_t;
+
+typedef struct
+{
+    lv_chart_series_t*      ser;
+    const history_series_t* data; // Bound view model, NULL when cleared
+    history_marker_t        max_marker;
+    history_marker_t        min_marker;
+} history_chart_series_t;
+
+struct history_chart
+{
+    history_chart_desc_t   desc;
+    lv_obj_t*              chart;
+    lv_obj_t*              left_time_label;
+    lv_obj_t*              right_time_label;
+    history_chart_series_t series[HISTORY_CHART_MAX_SERIES];
+};
+
+// Drawn while a series has no history, never written after initialization
+static int32_t no_data[HISTORY_SERIES_POINTS];
+
+static lv_obj_t* create_time_label(lv_obj_t* container, lv_align_t align, int32_t x_offset)
+{
+    lv_obj_t* label = lv_label_create(container);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_color(label, lv_palette_main(LV_PALETTE_GREY), 0);
+    lv_obj_align(label, align, x_offset, 0);
+    lv_label_set_text(label, "");
+    return label;
+}
+
+// Create a hidden dashed line with its value label
+static void create_marker(lv_obj_t* chart, history_marker_t* marker, lv_color_t color,
+                          lv_align_t align, int32_t x_offset, int32_t y_offset)
+{
+    marker->line = lv_line_create(chart);
+    lv_line_set_points(marker->line, marker->points, 2);
+    lv_obj_set_style_line_width(marker->line, 1, 0);
+    lv_obj_set_style_line_color(marker->line, color, 0);
+    lv_obj_set_style_line_dash_width(marker->line, 3, 0);
+    lv_obj_set_style_line_dash_gap(marker->line, 3, 0);
+    lv_obj_add_flag(marker->line, LV_OBJ_FLAG_HIDDEN);
+
+    marker->label = lv_label_create(chart);
+    lv_obj_set_style_text_font(marker->label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_color(marker->label, color, 0);
+    lv_obj_align(marker->label, align, x_offset, y_offset);
+    lv_obj_add_flag(marker->label, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void hide_marker(history_marker_t* marker)
+{
+    lv_obj_add_flag(marker->line, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(marker->label, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Move a marker to a value on the current Y axis
+static void place_marker(history_chart_t* hc, history_marker_t* marker, const char* text,
+                         int32_t value, int32_t y_min, int32_t y_max)
+{
+    int32_t chart_w = lv_obj_get_content_width(hc->chart);
+    int32_t chart_h = lv_obj_get_content_height(hc->chart);
+
+    float ratio = (float)(value - y_min) / (y_max - y_min);
+    float y_pos = chart_h - (ratio * chart_h);
+
+    marker->points[0].x = 1;
+    marker->points[0].y = y_pos;
+    marker->points[1].x = chart_w - 1;
+    marker->points[1].y = y_pos;
+    lv_line_set_points(marker->line, marker->points, 2);
+
+    lv_label_set_text(marker->label, text);
+
+    lv_obj_remove_flag(marker->line, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_flag(marker->label, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void chart_delete_cb(lv_event_t* e)
+{
+    lv_free(lv_event_get_user_data(e));
+}
+
+history_chart_t* history_chart_create(lv_obj_t* container, const history_chart_desc_t* desc)
+{
+    if(desc->series_count == 0 || desc->series_count > HISTORY_CHART_MAX_SERIES)
+    {
+        log_error("Invalid history chart description");
+        return NULL;
+    }
+
+    history_chart_t* hc = lv_malloc_zeroed(sizeof(history_chart_t));
+    if(hc == NULL)
+    {
+        log_error("Failed to allocate history chart");
+        return NULL;
+    }
+    hc->desc = *desc;
+
+    for(uint32_t i = 0; i < HISTORY_SERIES_POINTS; i++)
+    {
+        no_data[i] = LV_CHART_POINT_NONE;
+    }
+
+    hc->chart = lv_chart_create(container);
+    lv_obj_set_size(hc->chart, LV_PCT(95), LV_PCT(80));
+    lv_obj_center(hc->chart);
+    lv_chart_set_type(hc->chart, desc->type);
+    static_layer_create_chart_grid(hc->chart, desc->hdiv, desc->vdiv); // Cached grid image
+    lv_chart_set_point_count(hc->chart, HISTORY_SERIES_POINTS);
+    lv_obj_clear_flag(hc->chart, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_scrollbar_mode(hc->chart, LV_SCROLLBAR_MODE_OFF);
+
+    if(desc->type == LV_CHART_TYPE_BAR)
+    {
+        lv_obj_set_style_pad_column(hc->chart, 2, 0);
+    }
+    else
+    {
+        lv_obj_set_style_size(hc->chart, 4, 4, LV_PART_INDICATOR); // Points on the line
+    }
+
+    lv_obj_add_event_cb(hc->chart, chart_delete_cb, LV_EVENT_DELETE, hc);
+
+    if(desc->title != NULL)
+    {
+        lv_obj_t* title = lv_label_create(container);
+        lv_label_set_text(title, desc->title);
+        lv_obj_set_style_pad_all(title, -5, 0);
+        lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 0);
+    }
+
+    // The first series labels its markers on the left, the second on the right
+    for(uint8_t i = 0; i < desc->series_count; i++)
+    {
+        history_chart_series_t*      s     = &hc->series[i];
+        const history_series_desc_t* sd    = &desc->series[i];
+        bool                         left  = (i == 0);
+        int32_t                      x_ofs = left ? 5 : -5;
+
+        s->ser = lv_chart_add_series(hc->chart, sd->color, LV_CHART_AXIS_PRIMARY_Y);
+
+        create_marker(hc->chart, &s->max_marker, sd->color,
+                      left ? LV_ALIGN_TOP_LEFT : LV_ALIGN_TOP_RIGHT, x_ofs, -8);
+        create_marker(hc->chart, &s->min_marker, sd->color,
+                      left ? LV_ALIGN_BOTTOM_LEFT : LV_ALIGN_BOTTOM_RIGHT, x_ofs, 10);
+    }
+
+    hc->left_time_label  = create_time_label(container, LV_ALIGN_BOTTOM_LEFT, 5);
+    hc->right_time_label = create_time_label(container, LV_ALIGN_BOTTOM_RIGHT, -5);
+
+    history_chart_reset(hc);
+    return hc;
+}
+
+void history_chart_bind_series(history_chart_t* hc, uint8_t series, const history_series_t* data)
+{
+    if(hc == NULL || series >= hc->desc.series_count)
+        return;
+
+    if(data == NULL || !data->valid)
+    {
+        history_chart_clear_series(hc, series);
+        return;
+    }
+
+    // LVGL only reads an external array, values are never set through the chart API
+    history_chart_series_t* s = &hc->series[series];
+    lv_chart_set_ext_y_array(hc->chart, s->ser, (int32_t*)data->values);
+    s->data = data;
+}
+
+void history_chart_clear_series(history_chart_t* hc, uint8_t series)
+{
+    if(hc == NULL || series >= hc->desc.series_count)
+        return;
+
+    history_chart_series_t* s = &hc->series[series];
+    lv_chart_set_ext_y_array(hc->chart, s->ser, no_data);
+    s->data = NULL;
+}
+
+void history_chart_set_timestamps(history_chart_t* hc, const char* left, const char* right)
+{
+    if(hc == NULL)
+        return;
+
+    lv_label_set_text(hc->left_time_label, left);
+    lv_label_set_text(hc->right_time_label, right);
+}
+
+void history_chart_refresh(history_chart_t* hc)
+{
+    if(hc == NULL)
+        return;
+
+    const history_chart_desc_t* desc     = &hc->desc;
+    bool                        valid    = false;
+    bool                        has_data = false;
+    int32_t                     y_min    = desc->default_min;
+    int32_t                     y_max    = desc->default_max;
+
+    // The axis fits every series that has data
+    for(uint8_t i = 0; i < desc->series_count; i++)
+    {
+        const history_series_t* data = hc->series[i].data;
+        if(data == NULL)
+            continue;
+
+        valid = true;
+        if(!data->has_data)
+            continue;
+
+        if(!has_data || data->y_min < y_min)
+            y_min = data->y_min;
+        if(!has_data || data->y_max > y_max)
+            y_max = data->y_max;
+        has_data = true;
+    }
+
+    if(!valid)
+    {
+        history_chart_reset(hc);
+        return;
+    }
+
+    lv_chart_set_range(hc->chart, LV_CHART_AXIS_PRIMARY_Y, y_min, y_max);
+
+    for(uint8_t i = 0; i < desc->series_count; i++)
+    {
+        history_chart_series_t*      s    = &hc->series[i];
+        const history_series_desc_t* sd   = &desc->series[i];
+        const history_series_t*      data = s->data;
+
+        if(data != NULL && data->has_data)
+        {
+            place_marker(hc, &s->max_marker, data->max_label, data->max, y_min, y_max);
+        }
+        else
+        {
+            hide_marker(&s->max_marker);
+        }
+
+        if(data != NULL && data->has_data && sd->show_min)
+        {
+            place_marker(hc, &s->min_marker, data->min_label, data->min, y_min, y_max);
+        }
+        else
+        {
+            hide_marker(&s->min_marker);
+        }
+    }
+
+    lv_chart_refresh(hc->chart);
+
+    log_debug("History chart updated (range: %.1f-%.1f)", (float)y_min / HISTORY_SERIES_SCALE,
+              (float)y_max / HISTORY_SERIES_SCALE);
+}
+
+void history_chart_reset(history_chart_t* hc)
+{
+    if(hc == NULL)
+        return;
+
+    for(uint8_t i = 0; i < hc->desc.series_count; i++)
+    {
+        history_chart_clear_series(hc, i);
+        hide_marker(&hc->series[i].max_marker);
+        hide_marker(&hc->series[i].min_marker);
+    }
+
+    lv_label_set_text(hc->left_time_label, "");
+    lv_label_set_text(hc->right_time_label, "");
+
+    lv_chart_refresh(hc->chart);
+}
@@ -0,0 +1,57 @@
+#ifndef HISTORY_CHART_H
+#define HISTORY_CHART_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+#include "../../data/sensor_types.h"
+
+#define HISTORY_CHART_MAX_SERIES 2
+
+// One series of a history chart
+typedef struct
+{
+    lv_color_t color;
+    bool       show_min; // Also mark the minimum, the maximum is always marked
+} history_series_desc_t;
+
+// Chart layout and Y axis behaviour
+typedef struct
+{
+    lv_chart_type_t       type;
+    uint8_t               hdiv;        // Horizontal division lines
+    uint8_t               vdiv;        // Vertical division lines
+    const char*           title;       // Title above the chart, NULL if the panel adds one
+    int32_t               default_min; // Y axis without data (fixed point)
+    int32_t               default_max;
+    uint8_t               series_count;
+    history_series_desc_t series[HISTORY_CHART_MAX_SERIES];
+} history_chart_desc_t;
+
+typedef struct history_chart history_chart_t;
+
+// Create a chart with its min/max markers and timestamp labels in a container
+// The chart shows HISTORY_SERIES_POINTS points. The state is freed when the chart is deleted
+// with its container.
+history_chart_t* history_chart_create(lv_obj_t* container, const history_chart_desc_t* desc);
+
+// Draw a series straight from a history view model, without copying or converting it
+// The view model must stay unchanged until the next bind or clear of the series.
+// An invalid history clears the series.
+void history_chart_bind_series(history_chart_t* hc, uint8_t series, const history_series_t* data);
+
+// Mark a series as having no data
+void history_chart_clear_series(history_chart_t* hc, uint8_t series);
+
+// Set the time labels shown below the left and right edge
+void history_chart_set_timestamps(history_chart_t* hc, const char* left, const char* right);
+
+// Apply the bound view models to the chart: Y range and markers
+// Resets the chart when no series has data.
+void history_chart_refresh(history_chart_t* hc);
+
+// Clear all series, markers and timestamps
+void history_chart_reset(history_chart_t* hc);
+
+
+#endif /* HISTORY_CHART_H */
@@ -3,13 +3,13 @@
 
 #include <stdbool.h>
 #include "lvgl/lvgl.h"
-#include "../../data/data_manager.h"
+#include "../../data/sensor_types.h"
 
 // Initialize the solar chart
 void initialize_solar_chart(lv_obj_t* chart_container);
 
 // Chart update functions
-bool update_solar_chart_with_history(entity_history_t* history_data);
+bool update_solar_chart_with_history(const history_series_t* history);
 
 // Cleanup function
 void solar_chart_cleanup(void);
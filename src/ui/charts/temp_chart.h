@@ -3,13 +3,13 @@
 
 #include <stdbool.h>
 #include "lvgl/lvgl.h"
-#include "../../data/data_manager.h"
+#include "../../data/sensor_types.h"
 
 // Initialize the temperature chart
 void initialize_temperature_chart(lv_obj_t* chart_container);
 
 // Update functions
-void update_climate_chart_with_history(entity_history_t* history_data, bool is_internal);
+void update_climate_chart_with_history(const history_series_t* history, bool is_internal);
 void refresh_climate_chart(void);
 void reset_climate_chart(void);
 
@@ -5,8 +5,11 @@
 #include "lvgl/lvgl.h"
 #include "energy_temp_panel.h"
 #include "../lib/logger.h"
+#include "../lib/render_stats.h"
 #include "../data/data_manager.h"
+#include "../data/history_series.h"
 #include "ui.h"
+#include "ui_store.h"
 #include "../main.h"
 #include "lv_awesome_16.h"
 #include "charts/temp_chart.h"
@@ -17,17 +20,14 @@
 static void update_timer_cb(lv_timer_t* timer);
 static void update_long_timer_cb(lv_timer_t* timer);
 
-// Static variables for UI elements
-static lv_obj_t*   internal_temp_label  = NULL;
-static lv_obj_t*   external_temp_label  = NULL;
-static lv_obj_t*   humidity_label       = NULL;
-static lv_obj_t*   power_label          = NULL;
-static lv_obj_t*   battery_status_label = NULL;
-static lv_obj_t*   solar_power_label    = NULL;
-static lv_obj_t*   solar_state_icon     = NULL;
-static lv_obj_t*   charging_icon        = NULL;
-static lv_timer_t* update_timer         = NULL;
-static lv_timer_t* update_long_timer    = NULL;
+// Static variables for the timers, the value labels are bound to the store
+static lv_timer_t* update_timer      = NULL;
+static lv_timer_t* update_long_timer = NULL;
+
+static const store_value_format_t temperature_format = {"%.1f °C", "--- °C"};
+static const store_value_format_t power_format       = {"%.1f W", "--- W"};
+static const store_value_format_t soc_format         = {"%.1f%%", "--- %"};
+static const store_value_format_t solar_format       = {"%.0f W", "--- W"};
 
 typedef enum
 {
@@ -38,7 +38,7 @@ typedef enum
 } history_state_t;
 
 /**
- * Timer callback to update energy and temperature data
+ * Timer callback to request the energy and temperature data, the labels follow the store
  */
 static void update_camper_timer_cb(lv_timer_t* timer)
 {
@@ -79,148 +79,72 @@ static void update_camper_timer_cb(lv_timer_t* timer)
             log_warning("Failed to request smart_shunt data fetch");
         }
     }
+}
 
-    if(ui_is_sleeping())
+/**
+ * Show the battery state of charge while the solar charger reports a state
+ */
+static void solar_state_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t*   icon         = lv_observer_get_target_obj(observer);
+    const char* charge_state = lv_subject_get_string(lv_subject_get_group_element(subject, 0));
+    int32_t     soc          = lv_subject_get_int(lv_subject_get_group_element(subject, 1));
+
+    if(charge_state[0] == '\0' || soc == STORE_NO_VALUE)
     {
-        return;
+        lv_label_set_text(icon, "");
     }
-
-    climate_sensor_t* inside_climate  = get_inside_climate_data();
-    climate_sensor_t* outside_climate = get_outside_climate_data();
-
-    if(internal_temp_label != NULL)
+    else if(soc > 80 * STORE_SCALE)
     {
-        if(inside_climate->valid)
-        {
-            lv_label_set_text_fmt(internal_temp_label, "%.1f °C", inside_climate->temperature);
-        }
-        else
-        {
-            lv_label_set_text(internal_temp_label, "--- °C");
-        }
+        lv_label_set_text(icon, LV_SYMBOL_BATTERY_FULL);
     }
-
-    if(external_temp_label != NULL)
+    else if(soc > 60 * STORE_SCALE)
     {
-        if(outside_climate->valid)
-        {
-            lv_label_set_text_fmt(external_temp_label, "%.1f °C", outside_climate->temperature);
-        }
-        else
-        {
-            lv_label_set_text(external_temp_label, "--- °C");
-        }
+        lv_label_set_text(icon, LV_SYMBOL_BATTERY_THREE_QUARTERS);
     }
-
-    smart_shunt_t* shunt_data = get_smart_shunt_data();
-
-    // Update battery energy label
-    if(power_label != NULL)
+    else if(soc > 40 * STORE_SCALE)
     {
-        if(shunt_data->valid)
-        {
-            lv_label_set_text_fmt(power_label, "%.1f W", shunt_data->current * shunt_data->voltage);
-        }
-        else
-        {
-            lv_label_set_text(power_label, "--- W");
-        }
+        lv_label_set_text(icon, LV_SYMBOL_BATTERY_HALF);
     }
-
-    if(battery_status_label != NULL)
+    else if(soc > 20 * STORE_SCALE)
     {
-        if(shunt_data->valid)
-        {
-            lv_label_set_text_fmt(battery_status_label, "%.1f%%", shunt_data->soc);
-        }
-        else
-        {
-            lv_label_set_text(battery_status_label, "--- %");
-        }
+        lv_label_set_text(icon, LV_SYMBOL_BATTERY_QUARTER);
     }
+    else
+    {
+        lv_label_set_text(icon, LV_SYMBOL_BATTERY_EMPTY);
+    }
+}
 
-    smart_solar_t* solar_data = get_smart_solar_data();
+/**
+ * Show the charge state of the solar charger as arrows of different sizes
+ */
+static void charging_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t*   icon         = lv_observer_get_target_obj(observer);
+    const char* charge_state = lv_subject_get_string(subject);
 
-    // Update solar power label
-    if(solar_power_label != NULL)
+    if(strcmp(charge_state, "bulk") == 0)
     {
-        if(solar_data->valid)
-        {
-            lv_label_set_text_fmt(solar_power_label, "%.0f W", solar_data->solar_power);
-        }
-        else
-        {
-            lv_label_set_text(solar_power_label, "--- W");
-        }
+        // Strongest charging - use regular arrow up
+        lv_label_set_text(icon, LV_SYMBOL_ARROW_UP);
+        lv_obj_set_style_text_color(icon, lv_color_hex(0xFF0000), 0); // Red for bulk charging
     }
-
-    // Update the solar state icons based on charge state
-    if(solar_state_icon != NULL && charging_icon != NULL)
+    else if(strcmp(charge_state, "absorption") == 0)
     {
-        if(solar_data->valid)
-        {
-            // Set battery icon based on state of charge (example logic)
-            if(shunt_data->valid)
-            {
-                float soc = shunt_data->soc;
-                if(soc > 80.0f)
-                {
-                    lv_label_set_text(solar_state_icon, LV_SYMBOL_BATTERY_FULL);
-                }
-                else if(soc > 60.0f)
-                {
-                    lv_label_set_text(solar_state_icon, LV_SYMBOL_BATTERY_THREE_QUARTERS);
-                }
-                else if(soc > 40.0f)
-                {
-                    lv_label_set_text(solar_state_icon, LV_SYMBOL_BATTERY_HALF);
-                }
-                else if(soc > 20.0f)
-                {
-                    lv_label_set_text(solar_state_icon, LV_SYMBOL_BATTERY_QUARTER);
-                }
-                else
-                {
-                    lv_label_set_text(solar_state_icon, LV_SYMBOL_BATTERY_EMPTY);
-                }
-            }
-            else
-            {
-                lv_label_set_text(solar_state_icon, "");
-            }
-
-            // Set charging icon based on charge state - using different arrow sizes
-            if(strcmp(solar_data->charge_state, "bulk") == 0)
-            {
-                // Strongest charging - use regular arrow up
-                lv_label_set_text(charging_icon, LV_SYMBOL_ARROW_UP);
-                lv_obj_set_style_text_color(charging_icon, lv_color_hex(0xFF0000),
-                                            0); // Red for bulk charging
-            }
-            else if(strcmp(solar_data->charge_state, "absorption") == 0)
-            {
-                // Medium charging - use square arrow
-                lv_label_set_text(charging_icon, LV_SYMBOL_ARROW_UP_SQUARE);
-                lv_obj_set_style_text_color(charging_icon, lv_color_hex(0xFFCC00),
-                                            0); // Yellow for absorption
-            }
-            else if(strcmp(solar_data->charge_state, "float") == 0)
-            {
-                // Light charging - use thin arrow
-                lv_label_set_text(charging_icon, LV_SYMBOL_ARROW_UP_THIN);
-                lv_obj_set_style_text_color(charging_icon, lv_color_hex(0x00CC00),
-                                            0); // Green for float charging
-            }
-            else // Off or other state
-            {
-                lv_label_set_text(charging_icon, "");
-            }
-        }
-        else
-        {
-            lv_label_set_text(solar_state_icon, "");
-            lv_label_set_text(charging_icon, "");
-        }
+        // Medium charging - use square arrow
+        lv_label_set_text(icon, LV_SYMBOL_ARROW_UP_SQUARE);
+        lv_obj_set_style_text_color(icon, lv_color_hex(0xFFCC00), 0); // Yellow for absorption
+    }
+    else if(strcmp(charge_state, "float") == 0)
+    {
+        // Light charging - use thin arrow
+        lv_label_set_text(icon, LV_SYMBOL_ARROW_UP_THIN);
+        lv_obj_set_style_text_color(icon, lv_color_hex(0x00CC00), 0); // Green for float charging
+    }
+    else // Off, other state or no data
+    {
+        lv_label_set_text(icon, "");
     }
 }
 
@@ -237,14 +161,15 @@ static void update_long_timer_cb(lv_timer_t* timer)
     }
     else
     {
+        // Temperatures in quarter hours, reduced to the chart points keeping the peaks
         if(fetch_state == HISTORY_TEMP_INSIDE)
         {
-            if(request_entity_history("inside", "temperature", "1h", 48))
+            if(request_entity_history("inside", "temperature", "15m", 192))
                 fetch_state = HISTORY_TEMP_OUTSIDE;
         }
         else if(fetch_state == HISTORY_TEMP_OUTSIDE)
         {
-            if(request_entity_history("outside", "temperature", "1h", 48))
+            if(request_entity_history("outside", "temperature", "15m", 192))
                 fetch_state = HISTORY_TEMP_SOLAR;
         }
         else if(fetch_state == HISTORY_TEMP_SOLAR)
@@ -265,37 +190,23 @@ static void update_long_timer_cb(lv_timer_t* timer)
         }
     }
 
-    // Check if historical data is available
-    entity_history_t* history_data = get_entity_history_data();
-
-    if(history_data != NULL)
+    // Bind the histories converted since the last update, the charts draw from them directly
+    const history_series_t* history;
+    if((history = history_series_acquire(HISTORY_INSIDE_TEMPERATURE)) != NULL)
     {
-        if(history_data->valid)
-        {
-            if(strcmp(history_data->sensor_name, "inside") == 0)
-            {
-                update_climate_chart_with_history(history_data, true);
-            }
-            else if(strcmp(history_data->sensor_name, "outside") == 0)
-            {
-                update_climate_chart_with_history(history_data, false);
-            }
-            else if(strcmp(history_data->sensor_name, "SmartSolar") == 0)
-            {
-                update_solar_chart_with_history(history_data);
-            }
-            else if(strcmp(history_data->sensor_name, "SmartShunt") == 0)
-            {
-                update_energy_chart_with_history(history_data);
-            }
-            else
-            {
-                log_warning("Unknown sensor name in history data: %s", history_data->sensor_name);
-            }
-        }
-
-        // Always free the history data when we're done with it
-        free_entity_history_data(history_data);
+        update_climate_chart_with_history(history, true);
+    }
+    if((history = history_series_acquire(HISTORY_OUTSIDE_TEMPERATURE)) != NULL)
+    {
+        update_climate_chart_with_history(history, false);
+    }
+    if((history = history_series_acquire(HISTORY_SOLAR_YIELD)) != NULL)
+    {
+        update_solar_chart_with_history(history);
+    }
+    if((history = history_series_acquire(HISTORY_BATTERY_CONSUMED)) != NULL)
+    {
+        update_energy_chart_with_history(history);
     }
 }
 
@@ -333,11 +244,13 @@ void create_temperature_container(lv_obj_t* right_column)
     lv_obj_set_style_text_color(internal_caption, lv_palette_main(LV_PALETTE_GREEN), 0);
 
     // Internal temperature value with larger font
-    internal_temp_label = lv_label_create(labels_column);
+    lv_obj_t* internal_temp_label = lv_label_create(labels_column);
     lv_label_set_text(internal_temp_label, "--- °C");
     lv_obj_set_style_text_font(internal_temp_label, &lv_font_montserrat_20, 0);
     lv_obj_set_style_text_align(internal_temp_label, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_set_width(internal_temp_label, LV_PCT(100));
+    ui_store_bind_value(internal_temp_label, STORE_INSIDE_TEMPERATURE, &temperature_format);
+    ui_store_bind_stale(internal_temp_label, SENSOR_CLIMATE_INSIDE);
 
     // Spacer
     lv_obj_t* spacer = lv_obj_create(labels_column);
@@ -353,11 +266,13 @@ void create_temperature_container(lv_obj_t* right_column)
     lv_obj_set_style_text_color(external_caption, lv_palette_main(LV_PALETTE_BLUE), 0);
 
     // External temperature value with larger font
-    external_temp_label = lv_label_create(labels_column);
+    lv_obj_t* external_temp_label = lv_label_create(labels_column);
     lv_label_set_text(external_temp_label, "--- °C");
     lv_obj_set_style_text_font(external_temp_label, &lv_font_montserrat_20, 0);
     lv_obj_set_style_text_align(external_temp_label, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_set_width(external_temp_label, LV_PCT(100));
+    ui_store_bind_value(external_temp_label, STORE_OUTSIDE_TEMPERATURE, &temperature_format);
+    ui_store_bind_stale(external_temp_label, SENSOR_CLIMATE_OUTSIDE);
 
     // Right column for chart
     lv_obj_t* chart_container = lv_obj_create(temp_container);
@@ -415,9 +330,11 @@ void create_energy_container(lv_obj_t* right_column)
     lv_obj_set_style_text_color(power_caption, lv_palette_main(LV_PALETTE_ORANGE), 0);
 
     // Battery power value label
-    power_label = lv_label_create(power_column);
+    lv_obj_t* power_label = lv_label_create(power_column);
     lv_label_set_text(power_label, "--- W");
     lv_obj_set_style_text_font(power_label, &lv_font_montserrat_20, 0);
+    ui_store_bind_value(power_label, STORE_BATTERY_POWER, &power_format);
+    ui_store_bind_stale(power_label, SENSOR_SMART_SHUNT);
 
     // Spacer
     lv_obj_t* spacer = lv_obj_create(power_column);
@@ -433,9 +350,11 @@ void create_energy_container(lv_obj_t* right_column)
     lv_obj_set_style_text_color(status_caption, lv_palette_main(LV_PALETTE_ORANGE), 0);
 
     // Battery status value label
-    battery_status_label = lv_label_create(power_column);
+    lv_obj_t* battery_status_label = lv_label_create(power_column);
     lv_label_set_text(battery_status_label, "-- %");
     lv_obj_set_style_text_font(battery_status_label, &lv_font_montserrat_20, 0);
+    ui_store_bind_value(battery_status_label, STORE_BATTERY_SOC, &soc_format);
+    ui_store_bind_stale(battery_status_label, SENSOR_SMART_SHUNT);
 
     // Right column for hourly energy chart
     lv_obj_t* hourly_chart_container = lv_obj_create(energy_container);
@@ -487,9 +406,11 @@ void create_solar_container(lv_obj_t* right_column)
     lv_obj_set_style_text_color(power_caption, lv_palette_main(LV_PALETTE_PURPLE), 0);
 
     // Battery power value label
-    solar_power_label = lv_label_create(power_column);
+    lv_obj_t* solar_power_label = lv_label_create(power_column);
     lv_label_set_text(solar_power_label, "--- W");
     lv_obj_set_style_text_font(solar_power_label, &lv_font_montserrat_20, 0);
+    ui_store_bind_value(solar_power_label, STORE_SOLAR_POWER, &solar_format);
+    ui_store_bind_stale(solar_power_label, SENSOR_SMART_SOLAR);
 
     // Spacer
     lv_obj_t* spacer = lv_obj_create(power_column);
@@ -514,17 +435,22 @@ void create_solar_container(lv_obj_t* right_column)
                           LV_FLEX_ALIGN_CENTER);
     lv_obj_set_scrollbar_mode(icon_container, LV_SCROLLBAR_MODE_OFF);
     lv_obj_clear_flag(icon_container, LV_OBJ_FLAG_SCROLLABLE);
+    ui_store_bind_stale(icon_container, SENSOR_SMART_SOLAR);
 
     // Battery state icon
-    solar_state_icon = lv_label_create(icon_container);
+    lv_obj_t* solar_state_icon = lv_label_create(icon_container);
     lv_label_set_text(solar_state_icon, "");
     lv_obj_set_style_text_font(solar_state_icon, &lv_awesome_16, 0);
     lv_obj_set_style_text_font(solar_state_icon, &lv_awesome_16, 0);
+    lv_subject_add_observer_obj(ui_store_subject(STORE_SOLAR_STATUS), solar_state_observer_cb,
+                                solar_state_icon, NULL);
 
     // Charging icon
-    charging_icon = lv_label_create(icon_container);
+    lv_obj_t* charging_icon = lv_label_create(icon_container);
     lv_label_set_text(charging_icon, "");
     lv_obj_set_style_text_font(charging_icon, &lv_awesome_16, 0);
+    lv_subject_add_observer_obj(ui_store_subject(STORE_CHARGE_STATE), charging_observer_cb,
+                                charging_icon, NULL);
 
     // Right column for hourly energy chart
     lv_obj_t* hourly_chart_container = lv_obj_create(solar_container);
@@ -556,8 +482,34 @@ void create_energy_temp_panel(lv_obj_t* right_column)
     create_solar_container(right_column);
 
     // Create a timer to update the values periodically
-    update_timer = lv_timer_create(update_camper_timer_cb, DATA_OTHER_UPDATE_INTERVAL_MS, NULL);
-    update_long_timer = lv_timer_create(update_long_timer_cb, DATA_CHART_UPDATE_INTERVAL_MS, NULL);
+    update_timer = render_stats_timer_create(update_camper_timer_cb,
+                                             DATA_OTHER_UPDATE_INTERVAL_MS, "update_camper");
+    update_long_timer = render_stats_timer_create(update_long_timer_cb,
+                                                  DATA_CHART_UPDATE_INTERVAL_MS, "update_long");
+}
+
+/**
+ * Suspend or resume the periodic data and chart updates
+ */
+void energy_temp_panel_set_suspended(bool suspended)
+{
+    lv_timer_t* timers[] = {update_timer, update_long_timer};
+
+    for(size_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
+    {
+        if(timers[i] == NULL)
+            continue;
+
+        if(suspended)
+        {
+            lv_timer_pause(timers[i]);
+        }
+        else
+        {
+            lv_timer_resume(timers[i]);
+            lv_timer_ready(timers[i]);
+        }
+    }
 }
 
 /**
@@ -577,15 +529,6 @@ void energy_temp_panel_cleanup(void)
         update_long_timer = NULL;
     }
 
-    // Reset all static UI element pointers
-    internal_temp_label  = NULL;
-    external_temp_label  = NULL;
-    power_label          = NULL;
-    battery_status_label = NULL;
-    solar_power_label    = NULL;
-    solar_state_icon     = NULL;
-    charging_icon        = NULL;
-
     temp_chart_cleanup();
     battery_chart_cleanup();
     solar_chart_cleanup();
@@ -19,4 +19,11 @@ void update_energy_temp_data(void);
  */
 void energy_temp_panel_cleanup(void);
 
+/**
+ * Suspend or resume the periodic data and chart updates
+ * On resume the updates run at the next timer handler call.
+ * @param suspended true while the display is blanked
+ */
+void energy_temp_panel_set_suspended(bool suspended);
+
 #endif // ENERGY_TEMP_PANEL_H
@@ -0,0 +1,171 @@
+/*******************************************************************
+ *
+ * latency_trace.c - Sensor-to-pixel latency histograms
+ *
+ * Ends the traces started by the fetch requests. The UI store applies
+ * a reading and the trace then waits for the refresh that flushes it,
+ * seen through LVGL's display events like the render statistics, so
+ * every backend is covered. Each stage is recorded per sensor as the
+ * time since the previous stage, plus the total from the request to
+ * the flush. A reading that is not drawn within
+ * TRACE_DISPLAY_TIMEOUT_MS, for instance on a hidden tab, only counts
+ * up to the UI.
+ *
+ ******************************************************************/
+#include <stdio.h>
+
+#include "latency_trace.h"
+#include "../data/sensor_trace.h"
+#include "../lib/render_stats.h"
+#include "../lib/logger.h"
+#include "../main.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    // Time since the previous stage, the TRACE_ENQUEUED slot holds the total
+    render_histogram_t latency_us[TRACE_STAGE_COUNT];
+    char               labels[TRACE_STAGE_COUNT][48];
+    sensor_trace_t     applied; // Applied and waiting for a flush
+    bool               waiting;
+} sensor_latency_t;
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+// Microseconds, from a queue hand-over up to an HTTP timeout
+static const uint32_t latency_bounds_us[RENDER_STATS_BUCKETS - 1] = {
+    100, 1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 5000000};
+
+static const char* sensor_names[SENSOR_COUNT] = {"camper", "inside", "outside", "solar", "shunt"};
+
+static const char* stage_names[TRACE_STAGE_COUNT] = {
+    "total", "dequeued", "http_start", "first_byte", "parsed", "published", "applied", "displayed"};
+
+static sensor_latency_t sensors[SENSOR_COUNT];
+static bool             frame_flushed = false;
+
+/**
+ * Record the stages from..to as the time since their previous stage
+ */
+static void record_stages(sensor_latency_t* sensor, const sensor_trace_t* trace,
+                          trace_stage_t from, trace_stage_t to)
+{
+    for(int stage = from; stage <= (int)to; stage++)
+    {
+        const uint64_t* stamps = trace->stamp_ns;
+        if(stamps[stage - 1] == 0 || stamps[stage] < stamps[stage - 1])
+            continue;
+
+        render_stats_histogram_add(&sensor->latency_us[stage],
+                                   (uint32_t)((stamps[stage] - stamps[stage - 1]) / 1000));
+    }
+}
+
+/**
+ * End a trace at its TRACE_DISPLAYED stamp
+ */
+static void finish_trace(sensor_id_t id, const sensor_trace_t* trace)
+{
+    sensor_latency_t* sensor = &sensors[id];
+
+    record_stages(sensor, trace, TRACE_DISPLAYED, TRACE_DISPLAYED);
+    render_stats_histogram_add(
+        &sensor->latency_us[TRACE_ENQUEUED],
+        (uint32_t)((trace->stamp_ns[TRACE_DISPLAYED] - trace->stamp_ns[TRACE_ENQUEUED]) / 1000));
+
+    log_debug("Latency %s: queue %.1f, server %.1f, parse %.1f, ui %.1f, display %.1f, "
+              "total %.1f ms",
+              sensor_names[id], sensor_trace_interval_ms(trace, TRACE_ENQUEUED, TRACE_DEQUEUED),
+              sensor_trace_interval_ms(trace, TRACE_HTTP_START, TRACE_FIRST_BYTE),
+              sensor_trace_interval_ms(trace, TRACE_FIRST_BYTE, TRACE_PARSED),
+              sensor_trace_interval_ms(trace, TRACE_PUBLISHED, TRACE_APPLIED),
+              sensor_trace_interval_ms(trace, TRACE_APPLIED, TRACE_DISPLAYED),
+              sensor_trace_interval_ms(trace, TRACE_ENQUEUED, TRACE_DISPLAYED));
+}
+
+/**
+ * Display event callback, ends the waiting traces at the refresh that flushed them
+ */
+static void display_event_cb(lv_event_t* e)
+{
+    if(lv_event_get_code(e) == LV_EVENT_FLUSH_FINISH)
+    {
+        frame_flushed = true;
+        return;
+    }
+
+    // LV_EVENT_REFR_READY, refreshes without invalid areas draw nothing
+    if(!frame_flushed)
+        return;
+    frame_flushed = false;
+
+    uint64_t now = sensor_trace_now_ns();
+    for(int id = 0; id < SENSOR_COUNT; id++)
+    {
+        sensor_latency_t* sensor = &sensors[id];
+        if(!sensor->waiting)
+            continue;
+
+        sensor->waiting = false;
+        if(now - sensor->applied.stamp_ns[TRACE_APPLIED] >
+           (uint64_t)TRACE_DISPLAY_TIMEOUT_MS * 1000000ULL)
+            continue;
+
+        sensor->applied.stamp_ns[TRACE_DISPLAYED] = now;
+        finish_trace(id, &sensor->applied);
+    }
+}
+
+/**
+ * Stamp the reading of a sensor as applied to the UI subjects
+ */
+void latency_trace_apply(sensor_id_t id, bool changed)
+{
+    sensor_latency_t* sensor = &sensors[id];
+    sensor_trace_t    trace;
+
+    if(!sensor_trace_take(id, &trace))
+        return;
+
+    sensor_trace_stamp(&trace, TRACE_APPLIED);
+    record_stages(sensor, &trace, TRACE_DEQUEUED, TRACE_APPLIED);
+
+    if(changed)
+    {
+        // A reading still waiting is replaced, it was never drawn
+        sensor->applied = trace;
+        sensor->waiting = true;
+    }
+    else
+    {
+        trace.stamp_ns[TRACE_DISPLAYED] = trace.stamp_ns[TRACE_APPLIED];
+        finish_trace(id, &trace);
+    }
+}
+
+/**
+ * Register the histograms and follow the refreshes of a display
+ */
+void latency_trace_init(lv_display_t* disp)
+{
+    for(int id = 0; id < SENSOR_COUNT; id++)
+    {
+        for(int stage = 0; stage < TRACE_STAGE_COUNT; stage++)
+        {
+            render_histogram_t* hist  = &sensors[id].latency_us[stage];
+            char*               label = sensors[id].labels[stage];
+
+            hist->name   = "sensor_latency_us";
+            hist->bounds = latency_bounds_us;
+            snprintf(label, sizeof(sensors[id].labels[stage]), "sensor=\"%s\",stage=\"%s\"",
+                     sensor_names[id], stage_names[stage]);
+            render_stats_register_histogram(hist, label);
+        }
+    }
+
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+    lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_REFR_READY, NULL);
+}
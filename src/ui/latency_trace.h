@@ -0,0 +1,38 @@
+/*******************************************************************
+ *
+ * latency_trace.h - Sensor-to-pixel latency histograms
+ *
+ ******************************************************************/
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdbool.h>
+#include "lvgl/lvgl.h"
+#include "../data/sensor_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Register the histograms and follow the refreshes of a display
+     * The histograms are exported with the render statistics.
+     * @param disp display the readings are shown on
+     */
+    void latency_trace_init(lv_display_t* disp);
+
+    /**
+     * Stamp the reading of a sensor as applied to the UI subjects (UI thread)
+     * Does nothing if no reading was published since the last call.
+     * @param sensor sensor whose data was just applied
+     * @param changed true if a shown value changed, the trace then ends at the next flush,
+     * otherwise the screen already showed the reading and the trace ends now
+     */
+    void latency_trace_apply(sensor_id_t sensor, bool changed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_TRACE_H */
@@ -1,5 +1,6 @@
 #include "logs_tab.h"
 #include "../lib/logger.h"
+#include "../lib/render_stats.h"
 #include "lvgl/lvgl.h"
 #include "../main.h"
 #include "ui.h"
@@ -7,6 +8,8 @@
 static lv_obj_t*   logs_container;
 static lv_timer_t* refresh_timer;
 static lv_obj_t*   level_buttons[5]; // Store button references to update their appearance
+static bool        tab_active    = true;
+static bool        tab_suspended = false;
 
 static void refresh_logs_cb(lv_timer_t* timer)
 {
@@ -53,6 +56,23 @@ static void clear_button_event_cb(lv_event_t* e)
     logger_update_ui(logs_container);
 }
 
+// Run the refresh timer only while the tab is shown and the display is on
+static void update_refresh_timer(void)
+{
+    if(refresh_timer == NULL)
+        return;
+
+    if(tab_suspended || !tab_active)
+    {
+        lv_timer_pause(refresh_timer);
+    }
+    else
+    {
+        lv_timer_resume(refresh_timer);
+        lv_timer_ready(refresh_timer);
+    }
+}
+
 void create_logs_tab(lv_obj_t* parent)
 {
     // Create a container for logs with scrolling
@@ -120,11 +140,36 @@ void create_logs_tab(lv_obj_t* parent)
     lv_obj_add_event_cb(clear_btn, clear_button_event_cb, LV_EVENT_CLICKED, NULL);
 
     // Create a timer to refresh the logs
-    refresh_timer = lv_timer_create(refresh_logs_cb, LOG_REFRESH_INTERVAL_MS, NULL);
+    refresh_timer =
+        render_stats_timer_create(refresh_logs_cb, LOG_REFRESH_INTERVAL_MS, "refresh_logs");
 
     // Set initial state - INFO is default in logger.c
     update_button_states(LOG_LEVEL_INFO);
 
     // Initial population of logs
     logger_update_ui(logs_container);
-}
\ No newline at end of file
+    update_refresh_timer();
+}
+
+void logs_tab_set_suspended(bool suspended)
+{
+    tab_suspended = suspended;
+    update_refresh_timer();
+}
+
+void logs_tab_set_active(bool active)
+{
+    tab_active = active;
+    update_refresh_timer();
+}
+
+void logs_tab_destroy(void)
+{
+    // The widgets are deleted with the tab page
+    if(refresh_timer != NULL)
+    {
+        lv_timer_delete(refresh_timer);
+        refresh_timer = NULL;
+    }
+    logs_container = NULL;
+}
@@ -15,6 +15,23 @@ extern "C"
 
     void create_logs_tab(lv_obj_t* parent);
 
+    /**
+     * Suspend or resume the periodic log refresh
+     * @param suspended true while the display is blanked
+     */
+    void logs_tab_set_suspended(bool suspended);
+
+    /**
+     * Pause the periodic log refresh while the tab is not shown
+     * @param active true while the tab is the active tab
+     */
+    void logs_tab_set_active(bool active);
+
+    /**
+     * Delete the refresh timer before the tab content is deleted
+     */
+    void logs_tab_destroy(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,223 @@
+/*******************************************************************
+ *
+ * static_layer.c - Cached pre-rendered backgrounds for widgets
+ *
+ * Scale ticks and labels, chart grids and backgrounds only change with
+ * the theme or the widget size, but LVGL re-rasterizes them every time
+ * a needle or series on top of them moves. A static layer renders them
+ * once into an ARGB8888 buffer with lv_snapshot and blends that buffer
+ * in at the start of the host's draw, so an update costs one image blit
+ * of the dirty area instead of redrawing arcs, lines and text.
+ *
+ ******************************************************************/
+#include "static_layer.h"
+#include "../lib/logger.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    lv_obj_t*      host;           // Widget drawing the dynamic content
+    lv_obj_t*      source;         // Hidden child with the static content
+    lv_draw_buf_t* buf;            // Snapshot of the source, NULL until rendered
+    int32_t        ext;            // Snapshot size beyond the host on each side
+    bool           render_pending; // Snapshot scheduled for the next timer handler call
+    bool           rendering;      // Ignore the events caused by taking the snapshot
+    void (*first_render_cb)(lv_obj_t* host); // Called once the first snapshot succeeded
+} static_layer_t;
+
+static void host_event_cb(lv_event_t* e);
+
+/**
+ * Find the static layer of a host
+ */
+static static_layer_t* get_static_layer(lv_obj_t* host)
+{
+    uint32_t count = lv_obj_get_event_count(host);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        lv_event_dsc_t* dsc = lv_obj_get_event_dsc(host, i);
+        if(lv_event_dsc_get_cb(dsc) == host_event_cb)
+        {
+            return lv_event_dsc_get_user_data(dsc);
+        }
+    }
+    return NULL;
+}
+
+static void release_buf(static_layer_t* layer)
+{
+    if(layer->buf)
+    {
+        lv_image_cache_drop(layer->buf);
+        lv_draw_buf_destroy(layer->buf);
+        layer->buf = NULL;
+    }
+}
+
+/**
+ * Snapshot the source at the size of the host
+ * Runs from the timer handler, a snapshot cannot be taken while a frame is being rendered.
+ */
+static void render_async_cb(void* user_data)
+{
+    static_layer_t* layer = user_data;
+    layer->render_pending = false;
+    layer->rendering      = true;
+
+    uint32_t start = lv_tick_get();
+
+    lv_obj_update_layout(layer->host);
+    lv_obj_set_size(layer->source, lv_obj_get_width(layer->host), lv_obj_get_height(layer->host));
+    lv_obj_remove_flag(layer->source, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_update_layout(layer->source);
+
+    lv_draw_buf_t* buf = lv_snapshot_take(layer->source, LV_COLOR_FORMAT_ARGB8888);
+    int32_t        ext = lv_obj_get_ext_draw_size(layer->source);
+
+    lv_obj_add_flag(layer->source, LV_OBJ_FLAG_HIDDEN);
+    layer->rendering = false;
+
+    if(buf == NULL)
+    {
+        log_warning("Failed to render static layer, %s",
+                    layer->buf ? "keeping the previous one" : "retrying on the next change");
+        return;
+    }
+
+    release_buf(layer);
+    layer->buf = buf;
+    layer->ext = ext;
+
+    // Only now the host can stop drawing what the layer replaces
+    if(layer->first_render_cb)
+    {
+        layer->first_render_cb(layer->host);
+        layer->first_render_cb = NULL;
+    }
+
+    lv_obj_refresh_ext_draw_size(layer->host);
+    lv_obj_invalidate(layer->host);
+
+    log_debug("Static layer %dx%d rendered in %u ms", (int)buf->header.w, (int)buf->header.h,
+              lv_tick_elaps(start));
+}
+
+static void schedule_render(static_layer_t* layer)
+{
+    if(layer->render_pending || layer->rendering)
+        return;
+
+    layer->render_pending = true;
+    lv_async_call(render_async_cb, layer);
+}
+
+/**
+ * Blend the cached image in before the host draws its own parts
+ */
+static void draw_static_layer(lv_event_t* e, static_layer_t* layer)
+{
+    if(layer->buf == NULL)
+        return;
+
+    lv_area_t area;
+    lv_obj_get_coords(layer->host, &area);
+    lv_area_increase(&area, layer->ext, layer->ext);
+
+    lv_draw_image_dsc_t dsc;
+    lv_draw_image_dsc_init(&dsc);
+    dsc.src = layer->buf;
+    dsc.opa = lv_obj_get_style_opa_recursive(layer->host, LV_PART_MAIN);
+    lv_draw_image(lv_event_get_layer(e), &dsc, &area);
+}
+
+static void host_event_cb(lv_event_t* e)
+{
+    static_layer_t* layer = lv_event_get_user_data(e);
+
+    switch(lv_event_get_code(e))
+    {
+        case LV_EVENT_DRAW_MAIN_BEGIN: draw_static_layer(e, layer); break;
+        case LV_EVENT_REFR_EXT_DRAW_SIZE: lv_event_set_ext_draw_size(e, layer->ext); break;
+        case LV_EVENT_SIZE_CHANGED: schedule_render(layer); break;
+        case LV_EVENT_DELETE:
+            lv_async_call_cancel(render_async_cb, layer);
+            release_buf(layer);
+            lv_free(layer);
+            break;
+        default: break;
+    }
+}
+
+static void source_event_cb(lv_event_t* e)
+{
+    schedule_render(lv_event_get_user_data(e));
+}
+
+int static_layer_attach(lv_obj_t* host, lv_obj_t* source)
+{
+    if(lv_obj_get_parent(source) != host || get_static_layer(host) != NULL)
+    {
+        log_error("Static layer source must be the only static layer child of its host");
+        return -1;
+    }
+
+    static_layer_t* layer = lv_malloc_zeroed(sizeof(static_layer_t));
+    if(layer == NULL)
+    {
+        log_error("Failed to allocate static layer");
+        return -1;
+    }
+
+    layer->host   = host;
+    layer->source = source;
+
+    // Never drawn or laid out in place, only through the snapshot
+    lv_obj_add_flag(source, LV_OBJ_FLAG_HIDDEN | LV_OBJ_FLAG_FLOATING);
+
+    lv_obj_add_event_cb(host, host_event_cb, LV_EVENT_ALL, layer);
+    lv_obj_add_event_cb(source, source_event_cb, LV_EVENT_STYLE_CHANGED, layer);
+
+    schedule_render(layer);
+    return 0;
+}
+
+void static_layer_invalidate(lv_obj_t* host)
+{
+    static_layer_t* layer = get_static_layer(host);
+    if(layer)
+    {
+        schedule_render(layer);
+    }
+}
+
+/**
+ * Hand the background, border and division lines of a chart over to its grid layer
+ */
+static void chart_grid_rendered_cb(lv_obj_t* chart)
+{
+    // The border keeps its width so the series stay aligned with the grid
+    lv_chart_set_div_line_count(chart, 0, 0);
+    lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_opa(chart, LV_OPA_TRANSP, 0);
+}
+
+lv_obj_t* static_layer_create_chart_grid(lv_obj_t* chart, uint8_t hdiv, uint8_t vdiv)
+{
+    lv_obj_t* grid = lv_chart_create(chart);
+    lv_chart_set_div_line_count(grid, hdiv, vdiv);
+
+    if(static_layer_attach(chart, grid) != 0)
+    {
+        lv_obj_delete(grid);
+        return NULL;
+    }
+
+    // The grid draws the background, border and division lines, the chart only its series.
+    // Until the first snapshot succeeds the chart keeps drawing them itself.
+    lv_chart_set_div_line_count(chart, hdiv, vdiv);
+    get_static_layer(chart)->first_render_cb = chart_grid_rendered_cb;
+
+    return grid;
+}
@@ -0,0 +1,49 @@
+/*******************************************************************
+ *
+ * static_layer.h - Cached pre-rendered backgrounds for widgets
+ *
+ ******************************************************************/
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Render the static part of a widget once and draw the cached image behind it
+     * The source is a hidden child of the host holding only the static content (ticks,
+     * labels, grid). It is snapshotted at the size of the host, and again when the host is
+     * resized or the style of the source changes. The host draws only its dynamic parts,
+     * so a value change redraws no more than the area of those parts.
+     * @param host widget with the dynamic content, the image is drawn at its position
+     * @param source child of the host with the static content, becomes hidden
+     * @return 0 on success, -1 on failure
+     */
+    int static_layer_attach(lv_obj_t* host, lv_obj_t* source);
+
+    /**
+     * Re-render the static layer of a host after a change that does not go through a
+     * style, such as new scale sections or division lines
+     * @param host widget passed to static_layer_attach()
+     */
+    void static_layer_invalidate(lv_obj_t* host);
+
+    /**
+     * Move the background and division lines of a chart to a static layer
+     * The chart keeps drawing them itself until the first snapshot succeeded.
+     * @param chart chart to draw only the series of
+     * @param hdiv number of horizontal division lines
+     * @param vdiv number of vertical division lines
+     * @return the grid chart holding the static content, NULL on failure
+     */
+    lv_obj_t* static_layer_create_chart_grid(lv_obj_t* chart, uint8_t hdiv, uint8_t vdiv);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /* STATIC_LAYER_H */
@@ -12,28 +12,48 @@
 #include "../lib/logger.h"
 #include "../lib/http_client.h"
 #include "../lib/wifi.h" // Add the Wi-Fi header
+#include "../lib/render_stats.h"
 #include "lvgl/lvgl.h"
 #include "../data/sensor_types.h"
 #include "../data/data_manager.h"
 #include "../main.h"
 #include "ui.h"
+#include "ui_store.h"
+#include "static_layer.h"
 
-static lv_obj_t*   ui_household_switch         = NULL;
-static lv_obj_t*   ui_pump_switch              = NULL;
-static lv_obj_t*   ui_mains_led                = NULL;
-static lv_obj_t*   ui_water_bar                = NULL;
-static lv_obj_t*   ui_waste_bar                = NULL;
-static lv_obj_t*   ui_starter_battery          = NULL;
-static lv_obj_t*   ui_starter_battery_needle   = NULL;
-static lv_obj_t*   ui_household_battery        = NULL;
-static lv_obj_t*   ui_household_battery_needle = NULL;
-static lv_obj_t*   ui_wifi_icon                = NULL; // Wi-Fi signal icon
-static lv_obj_t*   ui_wifi_label               = NULL; // Wi-Fi SSID label
-static lv_obj_t*   ui_wifi_ip_label            = NULL; // Wi-Fi IP address label
-static lv_obj_t*   ui_wifi_strength            = NULL; // Wi-Fi signal strength
-static lv_timer_t* update_timer                = NULL;
-
-void update_status_ui(camper_sensor_t* camper_data);
+/**
+ * Colors of a tank level bar
+ */
+typedef struct
+{
+    lv_palette_t palette;    // Normal indicator color
+    uint32_t     warn_color; // Indicator color beyond the threshold
+    int32_t      threshold;  // Level in %
+    bool         warn_above; // Warn above the threshold instead of below
+} level_bar_config_t;
+
+static const level_bar_config_t water_bar_config = {LV_PALETTE_BLUE, 0xFF8000,
+                                                    WATER_LOW_THRESHOLD, false};
+static const level_bar_config_t waste_bar_config = {LV_PALETTE_ORANGE, 0xFF0000,
+                                                    WASTE_HIGH_THRESHOLD, true};
+
+static lv_timer_t* update_timer = NULL;
+
+void status_column_set_suspended(bool suspended)
+{
+    if(update_timer == NULL)
+        return;
+
+    if(suspended)
+    {
+        lv_timer_pause(update_timer);
+    }
+    else
+    {
+        lv_timer_resume(update_timer);
+        lv_timer_ready(update_timer);
+    }
+}
 
 static void household_event_handler(lv_event_t* e)
 {
@@ -106,8 +126,113 @@ static void update_battery_gauge(lv_obj_t* scale_line, lv_obj_t* needle_line, fl
     }
 }
 
+static void battery_gauge_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    int32_t value = lv_subject_get_int(subject);
+
+    // No value shows as 0, which hides the needle
+    update_battery_gauge(lv_observer_get_target_obj(observer), lv_observer_get_user_data(observer),
+                         value == STORE_NO_VALUE ? 0.0f : (float)value / STORE_SCALE);
+}
+
+static void level_bar_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t*                 bar    = lv_observer_get_target_obj(observer);
+    const level_bar_config_t* config = lv_observer_get_user_data(observer);
+    int32_t                   level  = lv_subject_get_int(subject);
+
+    if(level == STORE_NO_VALUE)
+    {
+        // No data - empty bar in the normal color
+        lv_bar_set_value(bar, 0, LV_ANIM_OFF);
+        lv_obj_set_style_bg_color(bar, lv_palette_main(config->palette), LV_PART_INDICATOR);
+        return;
+    }
+
+    lv_bar_set_value(bar, level, LV_ANIM_ON);
+
+    // Warning indicator if the level is too low or too high
+    bool warn = config->warn_above ? level > config->threshold : level < config->threshold;
+    lv_obj_set_style_bg_color(bar,
+                              warn ? lv_color_hex(config->warn_color)
+                                   : lv_palette_main(config->palette),
+                              LV_PART_INDICATOR);
+}
+
+static void mains_led_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t* led = lv_observer_get_target_obj(observer);
+
+    if(lv_subject_get_int(subject))
+    {
+        lv_led_on(led);
+        lv_led_set_color(led, lv_color_hex(0x00FF00)); // Green when mains connected
+    }
+    else
+    {
+        lv_led_off(led);
+        lv_led_set_color(led, lv_color_hex(0x808080)); // Gray when disconnected or unknown
+    }
+}
+
+static void wifi_signal_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t* icon     = lv_observer_get_target_obj(observer);
+    lv_obj_t* strength = lv_observer_get_user_data(observer);
+    int32_t   signal   = lv_subject_get_int(subject);
+
+    if(signal == STORE_NO_VALUE)
+    {
+        // Not connected
+        lv_obj_set_style_text_color(icon, lv_color_hex(0x808080), 0); // Gray
+        lv_label_set_text(strength, "");
+        return;
+    }
+
+    // Set Wi-Fi icon color based on signal strength
+    if(signal > 70)
+    {
+        lv_obj_set_style_text_color(icon, lv_color_hex(0x00C853), 0); // Good - green
+    }
+    else if(signal > 30)
+    {
+        lv_obj_set_style_text_color(icon, lv_color_hex(0xFF8000), 0); // OK - orange
+    }
+    else
+    {
+        lv_obj_set_style_text_color(icon, lv_color_hex(0xFF0000), 0); // Poor - red
+    }
+
+    lv_label_set_text_fmt(strength, "%d%%", (int)signal);
+}
+
+static void wifi_ssid_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    const char* ssid = lv_subject_get_string(subject);
+
+    lv_label_set_text(lv_observer_get_target_obj(observer), ssid[0] ? ssid : "Not connected");
+}
+
+static void wifi_ip_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t*   label   = lv_observer_get_target_obj(observer);
+    const char* address = lv_subject_get_string(subject);
+
+    // Only show the IP address when there is one
+    if(address[0])
+    {
+        lv_label_set_text(label, address);
+        lv_obj_clear_flag(label, LV_OBJ_FLAG_HIDDEN);
+    }
+    else
+    {
+        lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
 /**
  * Timer callback for data updates
+ * Only requests the fetch, the widgets follow the store when the data arrives.
  */
 static void data_update_timer_cb(lv_timer_t* timer)
 {
@@ -119,17 +244,25 @@ static void data_update_timer_cb(lv_timer_t* timer)
         {
             log_warning("Failed to request data fetch");
         }
-
-        // Update Wi-Fi status
-        wifi_update();
-
-        // Update UI with latest data regardless of whether new data is being fetched
-        update_status_ui(get_camper_data());
     }
 }
 
-static lv_obj_t* create_battery_gauge(lv_obj_t* parent, const char* title, float voltage,
-                                      lv_obj_t** out_needle)
+/**
+ * Geometry shared by the needle scale and its static layer, the needle only lines up with
+ * the ticks when both match
+ */
+static void configure_gauge_scale(lv_obj_t* scale)
+{
+    lv_scale_set_mode(scale, LV_SCALE_MODE_ROUND_INNER);
+    lv_obj_set_style_bg_opa(scale, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(scale, 0, 0);
+    lv_scale_set_range(scale, 90, 140);
+    lv_scale_set_angle_range(scale, 270);
+    lv_scale_set_rotation(scale, 135);
+}
+
+static lv_obj_t* create_battery_gauge(lv_obj_t* parent, const char* title,
+                                      store_subject_id_t voltage_id)
 {
     // Create a container for everything
     lv_obj_t* gauge_container = lv_obj_create(parent);
@@ -148,32 +281,32 @@ static lv_obj_t* create_battery_gauge(lv_obj_t* parent, const char* title, float
     lv_obj_set_style_text_font(title_label, &lv_font_montserrat_16, 0);
     lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, -10);
 
-    // Create the scale
+    // Create the scale, it draws only the needle, the rest is a cached static layer
     lv_obj_t* scale_line = lv_scale_create(gauge_container);
     lv_obj_set_size(scale_line, 130, 130);
     lv_obj_align(scale_line, LV_ALIGN_CENTER, 0, 10);
+    configure_gauge_scale(scale_line);
+    lv_scale_set_total_tick_count(scale_line, 0);
+    lv_scale_set_label_show(scale_line, false);
+    lv_obj_set_style_arc_opa(scale_line, LV_OPA_TRANSP, LV_PART_MAIN);
 
-    // Configure the scale (as before)
-    lv_scale_set_mode(scale_line, LV_SCALE_MODE_ROUND_INNER);
-    lv_obj_set_style_bg_opa(scale_line, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(scale_line, 0, 0);
+    // Static part: ticks, labels and colored sections
+    lv_obj_t* scale_static = lv_scale_create(scale_line);
+    configure_gauge_scale(scale_static);
 
     // Configure ticks and labels
-    lv_obj_set_style_transform_rotation(scale_line, 450, LV_PART_INDICATOR);
-    lv_obj_set_style_translate_x(scale_line, 10, LV_PART_INDICATOR);
-    lv_obj_set_style_length(scale_line, 15, LV_PART_INDICATOR);
-    lv_obj_set_style_pad_all(scale_line, 5, LV_PART_INDICATOR);
-    lv_obj_set_style_length(scale_line, 10, LV_PART_ITEMS);
-    lv_obj_set_style_pad_all(scale_line, 5, LV_PART_ITEMS);
-    lv_obj_set_style_line_opa(scale_line, LV_OPA_50, LV_PART_ITEMS);
-    lv_scale_set_label_show(scale_line, true);
-    lv_scale_set_total_tick_count(scale_line, 11);
-    lv_scale_set_major_tick_every(scale_line, 2);
-    lv_scale_set_range(scale_line, 90, 140);
+    lv_obj_set_style_transform_rotation(scale_static, 450, LV_PART_INDICATOR);
+    lv_obj_set_style_translate_x(scale_static, 10, LV_PART_INDICATOR);
+    lv_obj_set_style_length(scale_static, 15, LV_PART_INDICATOR);
+    lv_obj_set_style_pad_all(scale_static, 5, LV_PART_INDICATOR);
+    lv_obj_set_style_length(scale_static, 10, LV_PART_ITEMS);
+    lv_obj_set_style_pad_all(scale_static, 5, LV_PART_ITEMS);
+    lv_obj_set_style_line_opa(scale_static, LV_OPA_50, LV_PART_ITEMS);
+    lv_scale_set_label_show(scale_static, true);
+    lv_scale_set_total_tick_count(scale_static, 11);
+    lv_scale_set_major_tick_every(scale_static, 2);
     static const char* custom_labels[] = {"9", "10", "11", "12", "13", "14", NULL};
-    lv_scale_set_text_src(scale_line, custom_labels);
-    lv_scale_set_angle_range(scale_line, 270);
-    lv_scale_set_rotation(scale_line, 135);
+    lv_scale_set_text_src(scale_static, custom_labels);
 
     // Create styles & sections (same as before)
     static lv_style_t style_section_red;
@@ -198,29 +331,30 @@ static lv_obj_t* create_battery_gauge(lv_obj_t* parent, const char* title, float
         styles_initialized = true;
     }
 
-    lv_scale_section_t* section1 = lv_scale_add_section(scale_line);
+    lv_scale_section_t* section1 = lv_scale_add_section(scale_static);
     lv_scale_section_set_range(section1, 90, 110);
     lv_scale_section_set_style(section1, LV_PART_MAIN, &style_section_red);
 
-    lv_scale_section_t* section2 = lv_scale_add_section(scale_line);
+    lv_scale_section_t* section2 = lv_scale_add_section(scale_static);
     lv_scale_section_set_range(section2, 110, 118);
     lv_scale_section_set_style(section2, LV_PART_MAIN, &style_section_orange);
 
-    lv_scale_section_t* section3 = lv_scale_add_section(scale_line);
+    lv_scale_section_t* section3 = lv_scale_add_section(scale_static);
     lv_scale_section_set_range(section3, 118, 140);
     lv_scale_section_set_style(section3, LV_PART_MAIN, &style_section_green);
 
-    lv_obj_set_style_arc_rounded(scale_line, true, LV_PART_MAIN);
+    lv_obj_set_style_arc_rounded(scale_static, true, LV_PART_MAIN);
+
+    static_layer_attach(scale_line, scale_static);
 
     // Create the needle
     lv_obj_t* needle_line = lv_line_create(scale_line);
     lv_obj_set_style_line_width(needle_line, 3, LV_PART_MAIN);
     lv_obj_set_style_line_rounded(needle_line, true, LV_PART_MAIN);
-    *out_needle = needle_line;
 
     // Create the voltage label
     lv_obj_t* voltage_label = lv_label_create(gauge_container);
-    lv_label_set_text_fmt(voltage_label, "%.1fV", voltage);
+    lv_label_set_text(voltage_label, "-----");
     lv_obj_set_style_text_font(voltage_label, &lv_font_montserrat_16, 0);
 
     // Align the voltage label so it appears on the missing portion (top) of the arc
@@ -230,15 +364,19 @@ static lv_obj_t* create_battery_gauge(lv_obj_t* parent, const char* title, float
     // Store the label pointer so we can update it later
     lv_obj_set_user_data(scale_line, voltage_label);
 
-    // Initialize the gauge to the correct voltage
-    update_battery_gauge(scale_line, needle_line, voltage);
+    // Follow the voltage, binding also initializes the gauge
+    lv_subject_add_observer_obj(ui_store_subject(voltage_id), battery_gauge_observer_cb,
+                                scale_line, needle_line);
+    ui_store_bind_stale(gauge_container, SENSOR_CAMPER);
 
     return scale_line;
 }
 
-static lv_obj_t* create_level_bar(lv_obj_t* parent, const char* label_text, int initial_value,
-                                  lv_color_t color)
+static lv_obj_t* create_level_bar(lv_obj_t* parent, const char* label_text,
+                                  store_subject_id_t level_id, const level_bar_config_t* config)
 {
+    lv_color_t color = lv_palette_main(config->palette);
+
     // Create container with padding
     lv_obj_t* container = lv_obj_create(parent);
     lv_obj_set_size(container, lv_pct(100), LV_SIZE_CONTENT);
@@ -272,8 +410,10 @@ static lv_obj_t* create_level_bar(lv_obj_t* parent, const char* label_text, int
     lv_obj_set_style_bg_color(bar, color, LV_PART_INDICATOR);
     lv_obj_set_style_radius(bar, 3, LV_PART_INDICATOR);
 
-    // Set initial value
-    lv_bar_set_value(bar, initial_value, LV_ANIM_OFF);
+    // Follow the level, binding also sets the initial value
+    lv_subject_add_observer_obj(ui_store_subject(level_id), level_bar_observer_cb, bar,
+                                (void*)config);
+    ui_store_bind_stale(bar, SENSOR_CAMPER);
 
     return bar;
 }
@@ -294,31 +434,39 @@ static lv_obj_t* create_wifi_status(lv_obj_t* parent)
                           LV_FLEX_ALIGN_CENTER);
 
     // Create Wi-Fi icon
-    ui_wifi_icon = lv_label_create(wifi_container);
-    lv_label_set_text(ui_wifi_icon, LV_SYMBOL_WIFI);
-    lv_obj_set_style_text_font(ui_wifi_icon, &lv_font_montserrat_20, 0);
-    lv_obj_set_style_text_color(ui_wifi_icon, lv_color_hex(0x808080), 0);
+    lv_obj_t* wifi_icon = lv_label_create(wifi_container);
+    lv_label_set_text(wifi_icon, LV_SYMBOL_WIFI);
+    lv_obj_set_style_text_font(wifi_icon, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(wifi_icon, lv_color_hex(0x808080), 0);
 
     // Create Wi-Fi SSID label
-    ui_wifi_label = lv_label_create(wifi_container);
-    lv_label_set_text(ui_wifi_label, "Not connected");
-    lv_obj_set_style_text_font(ui_wifi_label, &lv_font_montserrat_16, 0);
-    lv_obj_set_style_pad_left(ui_wifi_label, 10, 0);
-    lv_obj_set_flex_grow(ui_wifi_label, 1);
+    lv_obj_t* wifi_label = lv_label_create(wifi_container);
+    lv_label_set_text(wifi_label, "Not connected");
+    lv_obj_set_style_text_font(wifi_label, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_pad_left(wifi_label, 10, 0);
+    lv_obj_set_flex_grow(wifi_label, 1);
 
     // Create IP address label
-    ui_wifi_ip_label = lv_label_create(wifi_container);
-    lv_label_set_text(ui_wifi_ip_label, "");
-    lv_obj_set_style_text_font(ui_wifi_ip_label, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_text_align(ui_wifi_ip_label, LV_TEXT_ALIGN_RIGHT, 0);
-    lv_obj_set_style_pad_left(ui_wifi_ip_label, 10, 0);
+    lv_obj_t* wifi_ip_label = lv_label_create(wifi_container);
+    lv_label_set_text(wifi_ip_label, "");
+    lv_obj_set_style_text_font(wifi_ip_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_align(wifi_ip_label, LV_TEXT_ALIGN_RIGHT, 0);
+    lv_obj_set_style_pad_left(wifi_ip_label, 10, 0);
 
     // Create signal strength label - make it grow to push it to the right
-    ui_wifi_strength = lv_label_create(wifi_container);
-    lv_label_set_text(ui_wifi_strength, "");
-    lv_obj_set_style_text_font(ui_wifi_strength, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_text_align(ui_wifi_strength, LV_TEXT_ALIGN_RIGHT, 0);
-    lv_obj_set_flex_grow(ui_wifi_strength, 1);
+    lv_obj_t* wifi_strength = lv_label_create(wifi_container);
+    lv_label_set_text(wifi_strength, "");
+    lv_obj_set_style_text_font(wifi_strength, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_align(wifi_strength, LV_TEXT_ALIGN_RIGHT, 0);
+    lv_obj_set_flex_grow(wifi_strength, 1);
+
+    // The icon observer also updates the strength label
+    lv_subject_add_observer_obj(ui_store_subject(STORE_WIFI_SIGNAL), wifi_signal_observer_cb,
+                                wifi_icon, wifi_strength);
+    lv_subject_add_observer_obj(ui_store_subject(STORE_WIFI_SSID), wifi_ssid_observer_cb,
+                                wifi_label, NULL);
+    lv_subject_add_observer_obj(ui_store_subject(STORE_WIFI_IP), wifi_ip_observer_cb,
+                                wifi_ip_label, NULL);
 
     return wifi_container;
 }
@@ -357,9 +505,11 @@ void create_status_column(lv_obj_t* left_column)
     lv_obj_set_style_bg_color(household_switch, lv_color_hex(0x008800),
                               LV_PART_INDICATOR | LV_STATE_CHECKED);
     lv_obj_add_event_cb(household_switch, household_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
-    // Start in disabled state
-    lv_obj_add_state(household_switch, LV_STATE_DISABLED);
-    lv_obj_clear_state(household_switch, LV_STATE_CHECKED);
+    // Follow the state, disabled while there is no valid data
+    lv_obj_bind_checked(household_switch, ui_store_subject(STORE_HOUSEHOLD_STATE));
+    lv_obj_bind_state_if_eq(household_switch, ui_store_subject(STORE_CAMPER_VALID),
+                            LV_STATE_DISABLED, 0);
+    ui_store_bind_stale(household_switch, SENSOR_CAMPER);
 
     // Pump switch with label
     lv_obj_t* pump_container = lv_obj_create(status_row_container);
@@ -378,9 +528,11 @@ void create_status_column(lv_obj_t* left_column)
     lv_obj_set_style_bg_color(pump_switch, lv_color_hex(0x008800),
                               LV_PART_INDICATOR | LV_STATE_CHECKED);
     lv_obj_add_event_cb(pump_switch, pump_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
-    // Start in disabled state
-    lv_obj_add_state(pump_switch, LV_STATE_DISABLED);
-    lv_obj_clear_state(pump_switch, LV_STATE_CHECKED);
+    // Follow the state, disabled while there is no valid data
+    lv_obj_bind_checked(pump_switch, ui_store_subject(STORE_PUMP_STATE));
+    lv_obj_bind_state_if_eq(pump_switch, ui_store_subject(STORE_CAMPER_VALID),
+                            LV_STATE_DISABLED, 0);
+    ui_store_bind_stale(pump_switch, SENSOR_CAMPER);
 
     // Mains LED with label
     lv_obj_t* mains_container = lv_obj_create(status_row_container);
@@ -400,12 +552,13 @@ void create_status_column(lv_obj_t* left_column)
     lv_led_set_color(mains_led, lv_color_hex(0x808080)); // Gray for unknown status
     lv_led_set_brightness(mains_led, 255);
     lv_led_off(mains_led);
+    lv_subject_add_observer_obj(ui_store_subject(STORE_MAINS_CONNECTED), mains_led_observer_cb,
+                                mains_led, NULL);
+    ui_store_bind_stale(mains_led, SENSOR_CAMPER);
 
     // Create water and waste bars with appropriate colors
-    lv_obj_t* water_bar =
-        create_level_bar(left_column, "Fresh Water", 0, lv_palette_main(LV_PALETTE_BLUE));
-    lv_obj_t* waste_bar =
-        create_level_bar(left_column, "Waste Water", 0, lv_palette_main(LV_PALETTE_ORANGE));
+    create_level_bar(left_column, "Fresh Water", STORE_WATER_LEVEL, &water_bar_config);
+    create_level_bar(left_column, "Waste Water", STORE_WASTE_LEVEL, &waste_bar_config);
 
     // Create a container for voltage info with row layout
     lv_obj_t* voltage_container = lv_obj_create(left_column);
@@ -420,23 +573,15 @@ void create_status_column(lv_obj_t* left_column)
     lv_obj_set_flex_align(voltage_container, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER,
                           LV_FLEX_ALIGN_CENTER);
 
-    ui_household_switch = household_switch;
-    ui_pump_switch      = pump_switch;
-    ui_mains_led        = mains_led;
-    ui_water_bar        = water_bar;
-    ui_waste_bar        = waste_bar;
-
-    // Store references to battery gauges
-    ui_starter_battery =
-        create_battery_gauge(voltage_container, "Starter Voltage", 0, &ui_starter_battery_needle);
-    ui_household_battery = create_battery_gauge(voltage_container, "Household Voltage", 0,
-                                                &ui_household_battery_needle);
+    create_battery_gauge(voltage_container, "Starter Voltage", STORE_STARTER_VOLTAGE);
+    create_battery_gauge(voltage_container, "Household Voltage", STORE_HOUSEHOLD_VOLTAGE);
 
     // Add Wi-Fi status container below batteries with minimal top margin
     lv_obj_t* wifi_container = create_wifi_status(left_column);
     lv_obj_set_style_margin_top(wifi_container, 0, 0); // Ensure no extra margin
 
-    update_timer = lv_timer_create(data_update_timer_cb, DATA_CAMPER_UPDATE_INTERVAL_MS, NULL);
+    update_timer = render_stats_timer_create(data_update_timer_cb, DATA_CAMPER_UPDATE_INTERVAL_MS,
+                                             "data_update");
 
     // Initialize Wi-Fi monitoring
     wifi_init();
@@ -449,218 +594,6 @@ void status_column_cleanup(void)
         lv_timer_del(update_timer);
         update_timer = NULL;
     }
-}
-
-void update_status_ui(camper_sensor_t* camper_data)
-{
-    // Check if the data is valid before updating UI components
-    if(!camper_data->valid)
-    {
-        // Data is invalid - disable or reset all UI elements
-
-        // Disable switches
-        if(ui_household_switch)
-        {
-            lv_obj_add_state(ui_household_switch, LV_STATE_DISABLED);
-            lv_obj_clear_state(ui_household_switch, LV_STATE_CHECKED);
-        }
-
-        if(ui_pump_switch)
-        {
-            lv_obj_add_state(ui_pump_switch, LV_STATE_DISABLED);
-            lv_obj_clear_state(ui_pump_switch, LV_STATE_CHECKED);
-        }
-
-        // Turn off mains LED and set to gray
-        if(ui_mains_led)
-        {
-            lv_led_off(ui_mains_led);
-            lv_led_set_color(ui_mains_led, lv_color_hex(0x808080));
-        }
 
-        // Reset water and waste bars to 0%
-        if(ui_water_bar)
-        {
-            lv_bar_set_value(ui_water_bar, 0, LV_ANIM_OFF);
-            lv_obj_set_style_bg_color(ui_water_bar, lv_palette_main(LV_PALETTE_BLUE),
-                                      LV_PART_INDICATOR);
-        }
-
-        if(ui_waste_bar)
-        {
-            lv_bar_set_value(ui_waste_bar, 0, LV_ANIM_OFF);
-            lv_obj_set_style_bg_color(ui_waste_bar, lv_palette_main(LV_PALETTE_ORANGE),
-                                      LV_PART_INDICATOR);
-        }
-
-        // Reset battery gauges to 0 (which will trigger the existing logic to show "-----")
-        if(ui_starter_battery && ui_starter_battery_needle)
-        {
-            update_battery_gauge(ui_starter_battery, ui_starter_battery_needle, 0);
-        }
-
-        if(ui_household_battery && ui_household_battery_needle)
-        {
-            update_battery_gauge(ui_household_battery, ui_household_battery_needle, 0);
-        }
-    }
-    else
-    {
-        // Data is valid - enable switches and update with real values
-        if(ui_household_switch)
-        {
-            lv_obj_clear_state(ui_household_switch, LV_STATE_DISABLED);
-            bool current_state = lv_obj_has_state(ui_household_switch, LV_STATE_CHECKED);
-            if(current_state != camper_data->household_state)
-            {
-                if(camper_data->household_state)
-                {
-                    lv_obj_add_state(ui_household_switch, LV_STATE_CHECKED);
-                }
-                else
-                {
-                    lv_obj_clear_state(ui_household_switch, LV_STATE_CHECKED);
-                }
-            }
-        }
-
-        // Update pump switch
-        if(ui_pump_switch)
-        {
-            lv_obj_clear_state(ui_pump_switch, LV_STATE_DISABLED);
-            bool current_state = lv_obj_has_state(ui_pump_switch, LV_STATE_CHECKED);
-            if(current_state != camper_data->pump_state)
-            {
-                if(camper_data->pump_state)
-                {
-                    lv_obj_add_state(ui_pump_switch, LV_STATE_CHECKED);
-                }
-                else
-                {
-                    lv_obj_clear_state(ui_pump_switch, LV_STATE_CHECKED);
-                }
-            }
-        }
-
-        // Update mains LED
-        if(ui_mains_led)
-        {
-            // Mains is detected if voltage is above 200V (assuming European 230V system)
-            if(camper_data->mains_voltage > 6.0f)
-            {
-                lv_led_on(ui_mains_led);
-                lv_led_set_color(ui_mains_led,
-                                 lv_color_hex(0x00FF00)); // Green when mains connected
-            }
-            else
-            {
-                lv_led_off(ui_mains_led);
-                lv_led_set_color(ui_mains_led, lv_color_hex(0x808080)); // Gray when disconnected
-            }
-        }
-
-        // Update water level bar
-        if(ui_water_bar)
-        {
-            lv_bar_set_value(ui_water_bar, camper_data->water_state, LV_ANIM_ON);
-
-            // Add warning indicator if water level is low
-            if(camper_data->water_state < WATER_LOW_THRESHOLD)
-            {
-                lv_obj_set_style_bg_color(ui_water_bar, lv_color_hex(0xFF8000), LV_PART_INDICATOR);
-            }
-            else
-            {
-                lv_obj_set_style_bg_color(ui_water_bar, lv_palette_main(LV_PALETTE_BLUE),
-                                          LV_PART_INDICATOR);
-            }
-        }
-
-        // Update waste level bar
-        if(ui_waste_bar)
-        {
-            lv_bar_set_value(ui_waste_bar, camper_data->waste_state, LV_ANIM_ON);
-
-            // Add warning indicator if waste level is high
-            if(camper_data->waste_state > WASTE_HIGH_THRESHOLD)
-            {
-                lv_obj_set_style_bg_color(ui_waste_bar, lv_color_hex(0xFF0000), LV_PART_INDICATOR);
-            }
-            else
-            {
-                lv_obj_set_style_bg_color(ui_waste_bar, lv_palette_main(LV_PALETTE_ORANGE),
-                                          LV_PART_INDICATOR);
-            }
-        }
-
-        // Update battery gauges
-        if(ui_starter_battery && ui_starter_battery_needle)
-        {
-            update_battery_gauge(ui_starter_battery, ui_starter_battery_needle,
-                                 camper_data->starter_voltage);
-        }
-
-        if(ui_household_battery && ui_household_battery_needle)
-        {
-            update_battery_gauge(ui_household_battery, ui_household_battery_needle,
-                                 camper_data->household_voltage);
-        }
-    }
-
-    // Update Wi-Fi status
-    if(ui_wifi_icon && ui_wifi_label && ui_wifi_strength)
-    {
-        wifi_status_t wifi_status = wifi_get_status();
-
-        if(wifi_status.wifi_connected)
-        {
-            // Set Wi-Fi icon color based on signal strength
-            if(wifi_status.wifi_signal_strength > 70)
-            {
-                lv_obj_set_style_text_color(ui_wifi_icon, lv_color_hex(0x00C853),
-                                            0); // Good - green
-            }
-            else if(wifi_status.wifi_signal_strength > 30)
-            {
-                lv_obj_set_style_text_color(ui_wifi_icon, lv_color_hex(0xFF8000), 0); // OK - orange
-            }
-            else
-            {
-                lv_obj_set_style_text_color(ui_wifi_icon, lv_color_hex(0xFF0000), 0); // Poor - red
-            }
-
-            // Update SSID and signal strength
-            lv_label_set_text(ui_wifi_label, wifi_status.wifi_ssid);
-
-            // Update IP address (if available)
-            if(ui_wifi_ip_label)
-            {
-                if(strlen(wifi_status.wifi_ip_address) > 0)
-                {
-                    lv_label_set_text(ui_wifi_ip_label, wifi_status.wifi_ip_address);
-                    lv_obj_clear_flag(ui_wifi_ip_label, LV_OBJ_FLAG_HIDDEN);
-                }
-                else
-                {
-                    lv_obj_add_flag(ui_wifi_ip_label, LV_OBJ_FLAG_HIDDEN);
-                }
-            }
-
-            lv_label_set_text_fmt(ui_wifi_strength, "%d%%", wifi_status.wifi_signal_strength);
-        }
-        else
-        {
-            // Not connected
-            lv_obj_set_style_text_color(ui_wifi_icon, lv_color_hex(0x808080), 0); // Gray
-            lv_label_set_text(ui_wifi_label, "Not connected");
-
-            // Hide IP address when not connected
-            if(ui_wifi_ip_label)
-            {
-                lv_obj_add_flag(ui_wifi_ip_label, LV_OBJ_FLAG_HIDDEN);
-            }
-
-            lv_label_set_text(ui_wifi_strength, "");
-        }
-    }
+    wifi_deinit();
 }
@@ -21,6 +21,12 @@ extern "C"
     void create_status_column(lv_obj_t* left_column);
     void status_column_cleanup(void);
 
+    /**
+     * Suspend or resume the periodic status updates
+     * @param suspended true while the display is blanked
+     */
+    void status_column_set_suspended(bool suspended);
+
 #ifdef __cplusplus
 }
 #endif
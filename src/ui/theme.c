@@ -0,0 +1,115 @@
+/*******************************************************************
+ *
+ * theme.c - Day and night mode through shared styles
+ *
+ * A theme extension on top of the default theme adds the same few
+ * styles to every widget when it is created. A mode switch only sets
+ * the colors of those styles and refreshes the style cache once, it
+ * adds no styles and sets no local properties. The styles stay empty
+ * until the first switch, so the UI starts with the default theme.
+ *
+ ******************************************************************/
+#include "theme.h"
+#include "lvgl/src/themes/lv_theme_private.h"
+#include "../lib/logger.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_theme_t theme_ext;
+static bool       initialized = false;
+
+static lv_style_t style_screen;         // Screen background
+static lv_style_t style_card;           // Containers and the tabview
+static lv_style_t style_text;           // Labels
+static lv_style_t style_indicator;      // Ticks, indicators and knobs of charts, bars and scales
+static lv_style_t style_indicator_text; // Text of charts, bars and scales
+
+/**
+ * Attach the shared styles to a new widget
+ */
+static void theme_apply_cb(lv_theme_t* theme, lv_obj_t* obj)
+{
+    LV_UNUSED(theme);
+
+    if(lv_obj_check_type(obj, &lv_obj_class) || lv_obj_check_type(obj, &lv_tabview_class))
+    {
+        lv_obj_add_style(obj, &style_card, 0);
+    }
+    else if(lv_obj_check_type(obj, &lv_label_class))
+    {
+        lv_obj_add_style(obj, &style_text, 0);
+    }
+    else if(lv_obj_has_class(obj, &lv_chart_class) || lv_obj_has_class(obj, &lv_bar_class) ||
+            lv_obj_has_class(obj, &lv_scale_class))
+    {
+        lv_obj_add_style(obj, &style_indicator, LV_PART_INDICATOR);
+        lv_obj_add_style(obj, &style_indicator, LV_PART_ITEMS);
+        lv_obj_add_style(obj, &style_indicator, LV_PART_KNOB);
+        lv_obj_add_style(obj, &style_indicator_text, LV_PART_MAIN);
+    }
+}
+
+/**
+ * Install the theme extension on the default display
+ */
+void theme_init(void)
+{
+    if(initialized)
+        return;
+
+    lv_style_init(&style_screen);
+    lv_style_init(&style_card);
+    lv_style_init(&style_text);
+    lv_style_init(&style_indicator);
+    lv_style_init(&style_indicator_text);
+
+    // Extend the active theme, it still styles the widgets first
+    lv_theme_t* active = lv_display_get_theme(NULL);
+    theme_ext          = *active;
+    lv_theme_set_parent(&theme_ext, active);
+    lv_theme_set_apply_cb(&theme_ext, theme_apply_cb);
+    lv_display_set_theme(NULL, &theme_ext);
+
+    // The screen already exists
+    lv_obj_add_style(lv_screen_active(), &style_screen, 0);
+
+    initialized = true;
+}
+
+/**
+ * Set the colors of the shared styles and refresh the widgets once
+ */
+void theme_set_dark_mode(bool dark_mode)
+{
+    if(!initialized)
+        return;
+
+    uint32_t start = lv_tick_get();
+
+    lv_color_t bg_color        = dark_mode ? lv_color_hex(0x202020) : lv_color_hex(0xEEEEEE);
+    lv_color_t text_color      = dark_mode ? lv_color_hex(0xDDDDDD) : lv_color_hex(0x333333);
+    lv_color_t card_bg_color   = dark_mode ? lv_color_hex(0x303030) : lv_color_hex(0xFFFFFF);
+    lv_color_t border_color    = dark_mode ? lv_color_hex(0x404040) : lv_color_hex(0xDDDDDD);
+    lv_color_t indicator_color = dark_mode ? lv_color_white() : lv_color_black();
+
+    // Setting a property again replaces its value, the styles do not grow
+    lv_style_set_bg_color(&style_screen, bg_color);
+
+    lv_style_set_bg_color(&style_card, card_bg_color);
+    lv_style_set_border_color(&style_card, border_color);
+
+    lv_style_set_text_color(&style_text, text_color);
+
+    lv_style_set_line_color(&style_indicator, indicator_color);
+    lv_style_set_border_color(&style_indicator, indicator_color);
+    lv_style_set_text_color(&style_indicator, indicator_color);
+
+    lv_style_set_text_color(&style_indicator_text, indicator_color);
+
+    // One pass over the widgets for all styles
+    lv_obj_report_style_change(NULL);
+
+    log_info("Applied %s mode theme in %u ms", dark_mode ? "dark" : "light",
+             (unsigned)lv_tick_elaps(start));
+}
@@ -0,0 +1,35 @@
+/*******************************************************************
+ *
+ * theme.h - Day and night mode through shared styles
+ *
+ ******************************************************************/
+#ifndef THEME_H
+#define THEME_H
+
+#include <stdbool.h>
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * Install the theme extension that attaches the shared mode styles to every widget
+     * at creation, must be called before the UI is created
+     */
+    void theme_init(void);
+
+    /**
+     * Switch between day and night mode
+     * Only the shared styles change, followed by a single style refresh of the screen,
+     * so the cost does not grow with the number of switches.
+     * @param dark_mode true for night mode
+     */
+    void theme_set_dark_mode(bool dark_mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THEME_H */
@@ -7,41 +7,67 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <sys/wait.h>
-#include <SDL2/SDL.h>
 
 #include "ui.h"
 #include "status_column.h"
 #include "logs_tab.h"
 #include "analytics_tab.h"
 #include "energy_temp_panel.h" // Add this new include
+#include "theme.h"
+#include "ui_store.h"
 #include "../lib/logger.h"
 #include "lvgl/lvgl.h"
-#include "../lib/lv_sdl_disp.h"
+#include "../lib/display_backend.h"
 #include "../main.h"
 #include "../data/data_manager.h"
 #include "../lib/mem_debug.h"
+#include "../lib/wifi.h"
 #include "lv_awesome_16.h"
 
 // Add at the top with other static variables
 static bool        is_sleeping      = false;
 static lv_obj_t*   sleep_overlay    = NULL;
+static lv_obj_t*   main_tabview     = NULL;
 static lv_timer_t* inactivity_timer = NULL;
 static bool        is_night_mode    = false;
+static lv_timer_t* teardown_timer   = NULL;
+static uint32_t    active_tab       = 0;
+static bool        status_active    = true;  // Status tab is shown
+static bool        status_suspended = false; // Rendering is suspended
 #ifdef LV_CAMPER_DEBUG
 static lv_timer_t* memory_monitor_timer = NULL;
 static lv_timer_t* leak_check_timer     = NULL;
 #endif
 
-extern SDL_Window*   window;
-extern SDL_Renderer* renderer;
-
 // Forward declaration
 static void on_wake_event(lv_event_t* e);
 static void inactivity_timer_cb(lv_timer_t* timer);
 static void brightness_button_event_handler(lv_event_t* e); // New handler declaration
 static void exit_timer_cb(lv_timer_t* timer); // Forward declaration of the new exit timer callback
-static void apply_style_recursive(lv_obj_t* obj, lv_style_t* text_style, lv_style_t* card_style,
-                                  bool dark_mode);
+static void create_status_tab(lv_obj_t* tab_status);
+static void status_tab_set_active(bool active);
+
+/**
+ * A tab whose content is created when it is first shown
+ */
+typedef struct
+{
+    const char* name;
+    void (*create)(lv_obj_t* page);
+    void (*set_active)(bool active); // Optional, pauses updates while the tab is hidden
+    void (*destroy)(void);           // Optional, allows deleting the content when hidden long
+    lv_obj_t*   page;
+    bool        created;
+    uint32_t    hidden_since;
+} ui_tab_t;
+
+static ui_tab_t ui_tabs[] = {
+    {"Status", create_status_tab, status_tab_set_active, NULL},
+    {"Analytics", create_analytics_tab, analytics_tab_set_active, analytics_tab_destroy},
+    {"Logs", create_logs_tab, logs_tab_set_active, logs_tab_destroy},
+};
+
+#define UI_TAB_COUNT (sizeof(ui_tabs) / sizeof(ui_tabs[0]))
 
 #ifdef LV_CAMPER_DEBUG
 /**
@@ -107,11 +133,7 @@ static int display_power_off(void)
 {
     log_debug("Turning off display");
 
-    // Configure SDL for power saving
-    SDL_SetHint(SDL_HINT_VIDEO_ALLOW_SCREENSAVER, "1");
-    SDL_EnableScreenSaver();
-
-    int rv = drm_blank_display(window, 1);
+    int rv = display_backend_blank(true);
     if(rv != 0)
     {
         log_error("Error turning off display", rv);
@@ -126,15 +148,67 @@ static void display_power_on(void)
 {
     log_debug("Turning on display");
 
-    int rv = drm_blank_display(window, 0);
+    int rv = display_backend_blank(false);
     if(rv != 0)
     {
         log_error("Error turning on display %d", rv);
     }
+}
+
+/**
+ * Pause the updates of the status tab while it is hidden or rendering is suspended
+ * Covers the update timers of both columns, the store feeding their widgets and the
+ * Wi-Fi monitor.
+ */
+static void update_status_tab(void)
+{
+    bool paused = status_suspended || !status_active;
+
+    status_column_set_suspended(paused);
+    energy_temp_panel_set_suspended(paused);
+    ui_store_set_paused(paused);
+    wifi_set_paused(paused);
+}
+
+/**
+ * Suspend or resume all rendering and periodic UI updates
+ * While suspended the display refresh timer is paused, so nothing is drawn into
+ * the blanked panel. Input devices keep running to wake up on touch.
+ */
+static void set_rendering_suspended(bool suspended)
+{
+    lv_timer_t* refr_timer = lv_display_get_refr_timer(NULL);
+
+    status_suspended = suspended;
+    update_status_tab();
+    analytics_tab_set_suspended(suspended);
+    logs_tab_set_suspended(suspended);
 
-    // Restore power management
-    SDL_SetHint(SDL_HINT_VIDEO_ALLOW_SCREENSAVER, "0");
-    SDL_DisableScreenSaver();
+    if(suspended)
+    {
+        if(inactivity_timer)
+        {
+            lv_timer_pause(inactivity_timer);
+        }
+        if(refr_timer)
+        {
+            lv_timer_pause(refr_timer);
+        }
+    }
+    else
+    {
+        if(inactivity_timer)
+        {
+            lv_timer_resume(inactivity_timer);
+        }
+        if(refr_timer)
+        {
+            lv_timer_resume(refr_timer);
+        }
+
+        // Redraw everything once with the latest data
+        lv_obj_invalidate(lv_screen_active());
+    }
 }
 
 /**
@@ -179,7 +253,11 @@ void ui_enter_sleep_mode(void)
     if(display_power_off() != 0)
     {
         lv_label_set_text(hint_label, "Cannot turn off display using KMSDRM DPMS property");
+        lv_refr_now(NULL);
     }
+
+    // Stop drawing until woken up
+    set_rendering_suspended(true);
 }
 
 /**
@@ -208,6 +286,9 @@ void ui_exit_sleep_mode(void)
     }
 
     is_sleeping = false;
+
+    // The updates run before the next refresh, which redraws the whole screen
+    set_rendering_suspended(false);
 }
 
 /**
@@ -248,108 +329,6 @@ void ui_reset_inactivity_timer(void)
     }
 }
 
-/**
- * Apply dark or light theme to the UI
- */
-static void apply_theme_mode(bool dark_mode)
-{
-    // Get the current theme
-    lv_theme_t* theme = lv_theme_get_from_obj(lv_screen_active());
-
-    // Set color scheme based on mode
-    lv_color_t primary_color = dark_mode ? lv_color_hex(0x3050C8) : lv_color_hex(0x3078FF);
-    lv_color_t bg_color      = dark_mode ? lv_color_hex(0x202020) : lv_color_hex(0xEEEEEE);
-    lv_color_t text_color    = dark_mode ? lv_color_hex(0xDDDDDD) : lv_color_hex(0x333333);
-    lv_color_t card_bg_color = dark_mode ? lv_color_hex(0x303030) : lv_color_hex(0xFFFFFF);
-
-    // Apply colors to screen
-    lv_obj_set_style_bg_color(lv_screen_active(), bg_color, 0);
-
-    // Create a style for text
-    static lv_style_t style_text;
-    lv_style_init(&style_text);
-    lv_style_set_text_color(&style_text, text_color);
-
-    // Create a style for cards/containers
-    static lv_style_t style_card;
-    lv_style_init(&style_card);
-    lv_style_set_bg_color(&style_card, card_bg_color);
-    lv_style_set_border_color(&style_card,
-                              dark_mode ? lv_color_hex(0x404040) : lv_color_hex(0xDDDDDD));
-
-    // Apply the style to all children using the public API
-    uint32_t child_count = lv_obj_get_child_count(lv_screen_active());
-    for(uint32_t i = 0; i < child_count; i++)
-    {
-        lv_obj_t* child = lv_obj_get_child(lv_screen_active(), i);
-        if(child == NULL)
-            continue;
-
-        // Skip non-visible children
-        if(lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN))
-            continue;
-
-        // Apply text style to all children recursively
-        apply_style_recursive(child, &style_text, &style_card, dark_mode);
-    }
-
-    log_info("Applied %s mode theme", dark_mode ? "dark" : "light");
-}
-
-/**
- * Recursively apply styles to an object and its children
- */
-static void apply_style_recursive(lv_obj_t* obj, lv_style_t* text_style, lv_style_t* card_style,
-                                  bool dark_mode)
-{
-    // Apply card style to containers
-    if(lv_obj_check_type(obj, &lv_obj_class) || lv_obj_check_type(obj, &lv_tabview_class))
-    {
-        lv_obj_add_style(obj, card_style, 0);
-    }
-
-    // Apply text style to labels
-    if(lv_obj_check_type(obj, &lv_label_class))
-    {
-        lv_obj_add_style(obj, text_style, 0);
-    }
-
-    // Handle gauge widgets (if available in your LVGL version)
-    if(lv_obj_has_class(obj, &lv_chart_class) || lv_obj_has_class(obj, &lv_bar_class) ||
-       lv_obj_has_class(obj, &lv_scale_class))
-    {
-
-        lv_color_t indicator_color = dark_mode ? lv_color_white() : lv_color_black();
-
-        // Apply colors to indicators
-        lv_obj_set_style_line_color(obj, indicator_color, LV_PART_INDICATOR);
-        lv_obj_set_style_line_color(obj, indicator_color, LV_PART_ITEMS);
-
-        // Set text color for any labels within the chart/gauge
-        lv_obj_set_style_text_color(obj, indicator_color, LV_PART_ITEMS);
-
-        lv_obj_set_style_text_color(obj, indicator_color, LV_PART_MAIN);
-    }
-
-    // Handle sliders that might use scales
-    if(lv_obj_check_type(obj, &lv_slider_class) || lv_obj_check_type(obj, &lv_bar_class))
-    {
-        lv_color_t indicator_color = dark_mode ? lv_color_white() : lv_color_black();
-        lv_obj_set_style_border_color(obj, indicator_color, LV_PART_INDICATOR);
-        lv_obj_set_style_border_color(obj, indicator_color, LV_PART_KNOB);
-
-        // Set tick color if slider has them
-        lv_obj_set_style_line_color(obj, indicator_color, LV_PART_ITEMS);
-    }
-
-    // Apply to children recursively
-    uint32_t i;
-    for(i = 0; i < lv_obj_get_child_count(obj); i++)
-    {
-        apply_style_recursive(lv_obj_get_child(obj, i), text_style, card_style, dark_mode);
-    }
-}
-
 /**
  * Handles toggling between day and night mode
  */
@@ -371,7 +350,7 @@ static void brightness_button_event_handler(lv_event_t* e)
         lv_label_set_text(label, LV_SYMBOL_SUN);
     }
 
-    apply_theme_mode(is_night_mode);
+    theme_set_dark_mode(is_night_mode);
 }
 
 /**
@@ -394,6 +373,12 @@ void ui_cleanup(void)
         inactivity_timer = NULL;
     }
 
+    if(teardown_timer != NULL)
+    {
+        lv_timer_del(teardown_timer);
+        teardown_timer = NULL;
+    }
+
     // Delete sleep overlay if it exists
     if(sleep_overlay != NULL)
     {
@@ -494,6 +479,139 @@ static void exit_timer_cb(lv_timer_t* timer)
     exit(0);
 }
 
+/**
+ * Create the content of the status tab: status column and energy/temperature panel
+ */
+static void create_status_tab(lv_obj_t* tab_status)
+{
+    lv_obj_set_style_pad_all(tab_status, 0, 0);
+
+    // Create a horizontal container to hold both columns
+    lv_obj_t* columns_container = lv_obj_create(tab_status);
+    lv_obj_set_size(columns_container, lv_pct(100), lv_pct(100));
+    lv_obj_align(columns_container, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_border_width(columns_container, 0, 0);
+    lv_obj_set_style_radius(columns_container, 0, 0);
+    lv_obj_set_style_pad_all(columns_container, 0, 0);
+
+    // Use a row layout for the columns container
+    lv_obj_set_flex_flow(columns_container, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(columns_container, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_START,
+                          LV_FLEX_ALIGN_START);
+
+    // Create left column (50% width)
+    lv_obj_t* left_column = lv_obj_create(columns_container);
+    lv_obj_set_size(left_column, lv_pct(50), lv_pct(100));
+    lv_obj_set_style_border_width(left_column, 0, 0);
+    lv_obj_set_style_radius(left_column, 0, 0);
+    lv_obj_set_style_pad_all(left_column, 10, 0);
+
+    // Create right column (50% width) - empty for now
+    lv_obj_t* right_column = lv_obj_create(columns_container);
+    lv_obj_set_size(right_column, lv_pct(50), lv_pct(100));
+    lv_obj_set_style_border_width(right_column, 0, 0);
+    lv_obj_set_style_radius(right_column, 0, 0);
+    lv_obj_set_style_pad_all(right_column, 5, 0);
+
+    // Set up right column as a vertical container (for future content)
+    lv_obj_set_flex_flow(right_column, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(right_column, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_row(right_column, 8, 0);
+
+    create_status_column(left_column);
+    create_energy_temp_panel(right_column);
+}
+
+/**
+ * Pause the status tab while another tab is shown
+ */
+static void status_tab_set_active(bool active)
+{
+    status_active = active;
+    update_status_tab();
+}
+
+/**
+ * Show a tab, creating its content on first use
+ */
+static void activate_tab(uint32_t index)
+{
+    if(index >= UI_TAB_COUNT)
+        return;
+
+    ui_tab_t* previous = &ui_tabs[active_tab];
+    if(index != active_tab && previous->created)
+    {
+        previous->hidden_since = lv_tick_get();
+        if(previous->set_active)
+        {
+            previous->set_active(false);
+        }
+    }
+
+    ui_tab_t* tab = &ui_tabs[index];
+    active_tab    = index;
+    if(!tab->created)
+    {
+        uint32_t start = lv_tick_get();
+        tab->create(tab->page);
+        tab->created = true;
+        log_info("Created %s tab in %u ms", tab->name, (unsigned)lv_tick_elaps(start));
+    }
+    if(tab->set_active)
+    {
+        tab->set_active(true);
+    }
+}
+
+/**
+ * Tab switched by the tab bar or a swipe
+ */
+static void tabview_event_cb(lv_event_t* e)
+{
+    lv_obj_t* tabview = lv_event_get_target(e);
+    activate_tab(lv_tabview_get_tab_active(tabview));
+}
+
+#if UI_TAB_TEARDOWN_MS > 0
+/**
+ * Delete the content and timers of tabs that have been hidden for a while
+ */
+static void teardown_timer_cb(lv_timer_t* timer)
+{
+    for(uint32_t i = 0; i < UI_TAB_COUNT; i++)
+    {
+        ui_tab_t* tab = &ui_tabs[i];
+        if(i == active_tab || !tab->created || tab->destroy == NULL ||
+           lv_tick_elaps(tab->hidden_since) < UI_TAB_TEARDOWN_MS)
+            continue;
+
+        tab->destroy();
+        lv_obj_clean(tab->page);
+        tab->created = false;
+        log_info("Deleted hidden %s tab", tab->name);
+    }
+}
+#endif
+
+/**
+ * Switch to a tab, e.g. from a benchmark
+ */
+void ui_set_active_tab(uint32_t index)
+{
+    lv_tabview_set_active(main_tabview, index, LV_ANIM_OFF);
+    activate_tab(index);
+}
+
+/**
+ * Get the main tabview
+ */
+lv_obj_t* ui_get_tabview(void)
+{
+    return main_tabview;
+}
+
 /**
  * @brief Creates the main application UI
  * @description Creates a tabview with Status, Analytics, and Logs tabs
@@ -505,17 +623,27 @@ void create_ui(void)
     mem_debug_init();
 #endif
 
+    // Shared day/night styles, attached to each widget as it is created
+    theme_init();
+
+    // Subjects the widgets bind to while they are created
+    ui_store_init();
+
     // Create a tabview object
     lv_obj_t* tabview = lv_tabview_create(lv_screen_active());
     lv_obj_set_size(tabview, lv_pct(100), lv_pct(100));
+    main_tabview = tabview;
 
     // Remove padding and gap between tabs and content
     lv_obj_set_style_pad_all(tabview, 0, 0);
 
-    // Create tabs
-    lv_obj_t* tab_status = lv_tabview_add_tab(tabview, "Status");
-    // lv_obj_t *tab_analytics = lv_tabview_add_tab(tabview, "Analytics");
-    lv_obj_t* tab_logs = lv_tabview_add_tab(tabview, "Logs");
+    // Create the tab pages, their content follows when they are first shown
+    for(uint32_t i = 0; i < UI_TAB_COUNT; i++)
+    {
+        ui_tabs[i].page    = lv_tabview_add_tab(tabview, ui_tabs[i].name);
+        ui_tabs[i].created = false;
+    }
+    lv_obj_add_event_cb(tabview, tabview_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
 
     // Get the tab bar (btns container)
     lv_obj_t* tab_btns = lv_tabview_get_tab_btns(tabview);
@@ -576,46 +704,13 @@ void create_ui(void)
     // Add event handler for exit button
     lv_obj_add_event_cb(exit_btn, exit_button_event_handler, LV_EVENT_CLICKED, NULL);
 
-    lv_obj_set_style_pad_all(tab_status, 0, 0);
-
-    // Create a horizontal container to hold both columns
-    lv_obj_t* columns_container = lv_obj_create(tab_status);
-    lv_obj_set_size(columns_container, lv_pct(100), lv_pct(100));
-    lv_obj_align(columns_container, LV_ALIGN_TOP_MID, 0, 0);
-    lv_obj_set_style_border_width(columns_container, 0, 0);
-    lv_obj_set_style_radius(columns_container, 0, 0);
-    lv_obj_set_style_pad_all(columns_container, 0, 0);
-
-    // Use a row layout for the columns container
-    lv_obj_set_flex_flow(columns_container, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(columns_container, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_START,
-                          LV_FLEX_ALIGN_START);
+    // Only the initial tab is built before the first frame
+    active_tab = 0;
+    activate_tab(0);
 
-    // Create left column (50% width)
-    lv_obj_t* left_column = lv_obj_create(columns_container);
-    lv_obj_set_size(left_column, lv_pct(50), lv_pct(100));
-    lv_obj_set_style_border_width(left_column, 0, 0);
-    lv_obj_set_style_radius(left_column, 0, 0);
-    lv_obj_set_style_pad_all(left_column, 10, 0);
-
-    // Create right column (50% width) - empty for now
-    lv_obj_t* right_column = lv_obj_create(columns_container);
-    lv_obj_set_size(right_column, lv_pct(50), lv_pct(100));
-    lv_obj_set_style_border_width(right_column, 0, 0);
-    lv_obj_set_style_radius(right_column, 0, 0);
-    lv_obj_set_style_pad_all(right_column, 5, 0);
-
-    // Set up right column as a vertical container (for future content)
-    lv_obj_set_flex_flow(right_column, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(right_column, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER,
-                          LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_pad_row(right_column, 8, 0);
-
-    // Create content for each tab
-    create_status_column(left_column);
-    create_energy_temp_panel(right_column);
-    // create_analytics_tab(tab_analytics);
-    create_logs_tab(tab_logs);
+#if UI_TAB_TEARDOWN_MS > 0
+    teardown_timer = lv_timer_create(teardown_timer_cb, UI_TAB_TEARDOWN_MS / 4, NULL);
+#endif
 
     // Create inactivity timer to automatically enter sleep mode
     inactivity_timer = lv_timer_create(inactivity_timer_cb, DISPLAY_INACTIVITY_TIMEOUT_MS, NULL);
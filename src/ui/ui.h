@@ -19,6 +19,17 @@ extern "C"
      */
     void create_ui(void);
 
+    /**
+     * Get the main tabview, e.g. to switch tabs from a benchmark
+     */
+    lv_obj_t* ui_get_tabview(void);
+
+    /**
+     * Switch to a tab without animation, creating its content on first use
+     * @param index tab index
+     */
+    void ui_set_active_tab(uint32_t index);
+
     /**
      * Enter sleep mode - turn off display
      */
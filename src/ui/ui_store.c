@@ -0,0 +1,292 @@
+/*******************************************************************
+ *
+ * ui_store.c - Reactive UI state, fed by the data manager
+ *
+ * Every value the status widgets show is an LVGL subject. The fetch
+ * thread only bumps a generation counter, the main loop then copies
+ * the data into the subjects on the UI thread. A subject is only set
+ * when its value changed at the resolution it is shown with, so an
+ * update notifies just the widgets bound to the values that moved and
+ * no module polls the data manager or keeps widget pointers for it.
+ * Applying a reading also stamps its latency trace, and the age of
+ * each reading is checked on every update to grey out stale values.
+ *
+ ******************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ui_store.h"
+#include "ui.h"
+#include "latency_trace.h"
+#include "../lib/wifi.h"
+#include "../data/data_manager.h"
+#include "../data/sensor_trace.h"
+#include "../main.h"
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_subject_t subjects[STORE_SUBJECT_COUNT];
+static bool         initialized = false;
+static bool         paused      = false;
+
+static char charge_state_buf[32];
+static char wifi_ssid_buf[64];
+static char wifi_ip_buf[16];
+
+static lv_subject_t* solar_status_members[] = {
+    &subjects[STORE_CHARGE_STATE],
+    &subjects[STORE_BATTERY_SOC],
+};
+
+static uint32_t seen_data_generation = 0;
+static uint32_t seen_wifi_generation = 0;
+
+// Receive time of the valid data per sensor, 0 while there is none
+static uint64_t received_ns[SENSOR_COUNT];
+
+/**
+ * Convert a value to the fixed point of the subjects
+ */
+static int32_t to_fixed(float value)
+{
+    return (int32_t)lroundf(value * STORE_SCALE);
+}
+
+/**
+ * Set a number subject, notifying its observers only if the value changed
+ * @return true if the value changed
+ */
+static bool set_number(store_subject_id_t id, int32_t value)
+{
+    if(lv_subject_get_int(&subjects[id]) == value)
+        return false;
+
+    lv_subject_set_int(&subjects[id], value);
+    return true;
+}
+
+/**
+ * Set a string subject, notifying its observers only if the text changed
+ * @return true if the text changed
+ */
+static bool set_string(store_subject_id_t id, const char* text)
+{
+    if(strcmp(lv_subject_get_string(&subjects[id]), text) == 0)
+        return false;
+
+    lv_subject_copy_string(&subjects[id], text);
+    return true;
+}
+
+static bool update_camper_subjects(void)
+{
+    camper_sensor_t* camper  = get_camper_data();
+    bool             valid   = camper->valid;
+    bool             changed = false;
+
+    received_ns[SENSOR_CAMPER] = valid ? camper->received_ns : 0;
+
+    changed |= set_number(STORE_CAMPER_VALID, valid);
+    changed |= set_number(STORE_HOUSEHOLD_STATE, valid && camper->household_state);
+    changed |= set_number(STORE_PUMP_STATE, valid && camper->pump_state);
+    changed |= set_number(STORE_MAINS_CONNECTED, valid && camper->mains_voltage > 6.0f);
+    changed |= set_number(STORE_WATER_LEVEL, valid ? camper->water_state : STORE_NO_VALUE);
+    changed |= set_number(STORE_WASTE_LEVEL, valid ? camper->waste_state : STORE_NO_VALUE);
+    changed |= set_number(STORE_HOUSEHOLD_VOLTAGE,
+                          valid ? to_fixed(camper->household_voltage) : STORE_NO_VALUE);
+    changed |= set_number(STORE_STARTER_VOLTAGE,
+                          valid ? to_fixed(camper->starter_voltage) : STORE_NO_VALUE);
+    return changed;
+}
+
+static bool update_climate_subjects(sensor_id_t sensor, climate_sensor_t* climate,
+                                    store_subject_id_t id)
+{
+    received_ns[sensor] = climate->valid ? climate->received_ns : 0;
+
+    return set_number(id, climate->valid ? to_fixed(climate->temperature) : STORE_NO_VALUE);
+}
+
+static bool update_shunt_subjects(void)
+{
+    smart_shunt_t* shunt   = get_smart_shunt_data();
+    bool           valid   = shunt->valid;
+    bool           changed = false;
+
+    received_ns[SENSOR_SMART_SHUNT] = valid ? shunt->received_ns : 0;
+
+    changed |= set_number(STORE_BATTERY_POWER,
+                          valid ? to_fixed(shunt->current * shunt->voltage) : STORE_NO_VALUE);
+    changed |= set_number(STORE_BATTERY_SOC, valid ? to_fixed(shunt->soc) : STORE_NO_VALUE);
+    return changed;
+}
+
+static bool update_solar_subjects(void)
+{
+    smart_solar_t* solar   = get_smart_solar_data();
+    bool           changed = false;
+
+    received_ns[SENSOR_SMART_SOLAR] = solar->valid ? solar->received_ns : 0;
+
+    // Shown in whole watts, so tenths of a watt must not notify the widgets
+    changed |= set_number(STORE_SOLAR_POWER,
+                          solar->valid ? to_fixed(roundf(solar->solar_power)) : STORE_NO_VALUE);
+    changed |= set_string(STORE_CHARGE_STATE, solar->valid ? solar->charge_state : "");
+    return changed;
+}
+
+/**
+ * Apply the sensor data, each sensor also ends the UI part of its latency trace
+ */
+static void update_sensor_subjects(void)
+{
+    latency_trace_apply(SENSOR_CAMPER, update_camper_subjects());
+    latency_trace_apply(SENSOR_CLIMATE_INSIDE,
+                        update_climate_subjects(SENSOR_CLIMATE_INSIDE, get_inside_climate_data(),
+                                                STORE_INSIDE_TEMPERATURE));
+    latency_trace_apply(SENSOR_CLIMATE_OUTSIDE,
+                        update_climate_subjects(SENSOR_CLIMATE_OUTSIDE, get_outside_climate_data(),
+                                                STORE_OUTSIDE_TEMPERATURE));
+    latency_trace_apply(SENSOR_SMART_SOLAR, update_solar_subjects());
+    latency_trace_apply(SENSOR_SMART_SHUNT, update_shunt_subjects());
+}
+
+/**
+ * Flag the sensors whose valid data is older than their stale limit
+ */
+static void update_stale_subjects(void)
+{
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++)
+    {
+        uint32_t limit_ms = sensor == SENSOR_CAMPER ? DATA_CAMPER_STALE_MS : DATA_OTHER_STALE_MS;
+        uint32_t age_ms   = sensor_trace_age_ms(received_ns[sensor]);
+
+        set_number(STORE_CAMPER_STALE + sensor, age_ms > limit_ms);
+    }
+}
+
+static void update_wifi_subjects(void)
+{
+    wifi_status_t wifi = wifi_get_status();
+
+    set_number(STORE_WIFI_SIGNAL, wifi.wifi_connected ? wifi.wifi_signal_strength : STORE_NO_VALUE);
+    set_string(STORE_WIFI_SSID, wifi.wifi_connected ? wifi.wifi_ssid : "");
+    set_string(STORE_WIFI_IP, wifi.wifi_connected ? wifi.wifi_ip_address : "");
+}
+
+/**
+ * Initialize the subjects, before any widget binds to them
+ */
+void ui_store_init(void)
+{
+    if(initialized)
+        return;
+
+    // Without data every number has no value, except the states which are off
+    for(int i = 0; i < STORE_NUMBER_COUNT; i++)
+    {
+        lv_subject_init_int(&subjects[i], STORE_NO_VALUE);
+    }
+    lv_subject_set_int(&subjects[STORE_CAMPER_VALID], 0);
+    lv_subject_set_int(&subjects[STORE_HOUSEHOLD_STATE], 0);
+    lv_subject_set_int(&subjects[STORE_PUMP_STATE], 0);
+    lv_subject_set_int(&subjects[STORE_MAINS_CONNECTED], 0);
+    for(int sensor = 0; sensor < SENSOR_COUNT; sensor++)
+    {
+        lv_subject_set_int(&subjects[STORE_CAMPER_STALE + sensor], 0);
+    }
+
+    lv_subject_init_string(&subjects[STORE_CHARGE_STATE], charge_state_buf, NULL,
+                           sizeof(charge_state_buf), "");
+    lv_subject_init_string(&subjects[STORE_WIFI_SSID], wifi_ssid_buf, NULL, sizeof(wifi_ssid_buf),
+                           "");
+    lv_subject_init_string(&subjects[STORE_WIFI_IP], wifi_ip_buf, NULL, sizeof(wifi_ip_buf), "");
+
+    lv_subject_init_group(&subjects[STORE_SOLAR_STATUS], solar_status_members,
+                          sizeof(solar_status_members) / sizeof(solar_status_members[0]));
+
+    initialized = true;
+}
+
+/**
+ * Copy the data that changed since the last call into the subjects
+ */
+void ui_store_update(void)
+{
+    if(!initialized || paused || ui_is_sleeping())
+        return;
+
+    uint32_t data_generation = get_data_generation();
+    if(data_generation != seen_data_generation)
+    {
+        seen_data_generation = data_generation;
+        update_sensor_subjects();
+    }
+
+    uint32_t wifi_generation = wifi_get_generation();
+    if(wifi_generation != seen_wifi_generation)
+    {
+        seen_wifi_generation = wifi_generation;
+        update_wifi_subjects();
+    }
+
+    update_stale_subjects();
+}
+
+/**
+ * Pause or resume the subject updates
+ */
+void ui_store_set_paused(bool store_paused)
+{
+    paused = store_paused;
+}
+
+/**
+ * Get a subject to bind widgets to
+ */
+lv_subject_t* ui_store_subject(store_subject_id_t id)
+{
+    return &subjects[id];
+}
+
+static void value_label_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_t*                   label  = lv_observer_get_target_obj(observer);
+    const store_value_format_t* format = lv_observer_get_user_data(observer);
+    int32_t                     value  = lv_subject_get_int(subject);
+
+    if(value == STORE_NO_VALUE)
+    {
+        lv_label_set_text(label, format->no_data);
+    }
+    else
+    {
+        lv_label_set_text_fmt(label, format->fmt, (float)value / STORE_SCALE);
+    }
+}
+
+/**
+ * Show a number subject in a label
+ */
+void ui_store_bind_value(lv_obj_t* label, store_subject_id_t id,
+                         const store_value_format_t* format)
+{
+    lv_subject_add_observer_obj(&subjects[id], value_label_observer_cb, label, (void*)format);
+}
+
+static void stale_observer_cb(lv_observer_t* observer, lv_subject_t* subject)
+{
+    lv_obj_set_style_opa(lv_observer_get_target_obj(observer),
+                         lv_subject_get_int(subject) ? LV_OPA_40 : LV_OPA_COVER, 0);
+}
+
+/**
+ * Grey out a widget while the data of a sensor is stale
+ */
+void ui_store_bind_stale(lv_obj_t* obj, sensor_id_t sensor)
+{
+    lv_subject_add_observer_obj(&subjects[STORE_CAMPER_STALE + sensor], stale_observer_cb, obj,
+                                NULL);
+}
@@ -0,0 +1,120 @@
+/*******************************************************************
+ *
+ * ui_store.h - Reactive UI state, fed by the data manager
+ *
+ ******************************************************************/
+#ifndef UI_STORE_H
+#define UI_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+#include "../data/sensor_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Value of a number subject while its source has no valid data */
+#define STORE_NO_VALUE INT32_MIN
+
+/* Measurements (V, °C, W and the state of charge) are fixed point with one decimal */
+#define STORE_SCALE 10
+
+    /**
+     * Subjects of the store
+     */
+    typedef enum
+    {
+        // Numbers
+        STORE_CAMPER_VALID = 0,    // 1 while the camper data is valid
+        STORE_HOUSEHOLD_STATE,     // Switch states, 0 or 1
+        STORE_PUMP_STATE,
+        STORE_MAINS_CONNECTED,     // 1 while mains voltage is present
+        STORE_WATER_LEVEL,         // Tank levels in whole %
+        STORE_WASTE_LEVEL,
+        STORE_HOUSEHOLD_VOLTAGE,   // V
+        STORE_STARTER_VOLTAGE,     // V
+        STORE_INSIDE_TEMPERATURE,  // °C
+        STORE_OUTSIDE_TEMPERATURE, // °C
+        STORE_BATTERY_POWER,       // W
+        STORE_BATTERY_SOC,         // %
+        STORE_SOLAR_POWER,         // W
+        STORE_WIFI_SIGNAL,         // Whole %, STORE_NO_VALUE when not connected
+        STORE_CAMPER_STALE,        // 1 while valid data is older than its stale limit,
+        STORE_INSIDE_STALE,        // in the order of sensor_id_t
+        STORE_OUTSIDE_STALE,
+        STORE_SOLAR_STALE,
+        STORE_SHUNT_STALE,
+        STORE_NUMBER_COUNT,
+
+        // Strings, empty while there is no data
+        STORE_CHARGE_STATE = STORE_NUMBER_COUNT, // Solar charger state, e.g. "bulk"
+        STORE_WIFI_SSID,
+        STORE_WIFI_IP,
+
+        // Groups, notify when any of their members changes
+        STORE_SOLAR_STATUS, // STORE_CHARGE_STATE and STORE_BATTERY_SOC
+        STORE_SUBJECT_COUNT
+    } store_subject_id_t;
+
+    /**
+     * Text of a number subject shown by a label
+     */
+    typedef struct
+    {
+        const char* fmt;     // printf format of the value as float, e.g. "%.1f °C"
+        const char* no_data; // Text while the subject has no value
+    } store_value_format_t;
+
+    /**
+     * Initialize the subjects, before any widget binds to them
+     */
+    void ui_store_init(void);
+
+    /**
+     * Copy the data that changed since the last call into the subjects (UI thread)
+     * Only subjects whose value changed notify their observers, so only the widgets
+     * showing that value are updated. Does nothing while the UI is sleeping or the store
+     * is paused, the changes are applied at wake-up. Cheap when nothing changed, call it
+     * every loop.
+     */
+    void ui_store_update(void);
+
+    /**
+     * Pause or resume the subject updates, e.g. while the widgets bound to them are hidden
+     * @param paused true to stop updating the subjects
+     */
+    void ui_store_set_paused(bool paused);
+
+    /**
+     * Get a subject to bind widgets to
+     * Bind with lv_subject_add_observer_obj() or the lv_obj_bind_* functions, so the
+     * observer is removed with the widget.
+     * @param id subject
+     * @return subject
+     */
+    lv_subject_t* ui_store_subject(store_subject_id_t id);
+
+    /**
+     * Show a number subject in a label
+     * @param label label to bind
+     * @param id number subject
+     * @param format text format, must stay valid while the label exists
+     */
+    void ui_store_bind_value(lv_obj_t* label, store_subject_id_t id,
+                             const store_value_format_t* format);
+
+    /**
+     * Grey out a widget while the data of a sensor is stale
+     * @param obj widget to grey out, with its children
+     * @param sensor sensor the widget shows data of
+     */
+    void ui_store_bind_stale(lv_obj_t* obj, sensor_id_t sensor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_STORE_H */